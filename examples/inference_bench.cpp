@@ -9,75 +9,79 @@
 
 using namespace softaccelnpu;
 
-// Simple SiLU activation: x * sigmoid(x)
-void silu_activation(Tensor& T) {
-    float* data = reinterpret_cast<float*>(T.data());
-    size_t size = T.rows() * T.cols();
-    for (size_t i = 0; i < size; ++i) {
-        float x = data[i];
-        float sigmoid = 1.0f / (1.0f + std::exp(-x));
-        data[i] = x * sigmoid;
-    }
-}
-
-// Element-wise multiplication
-void element_wise_mul(Tensor& Dest, const Tensor& Src) {
-    float* d_ptr = reinterpret_cast<float*>(Dest.data());
-    const float* s_ptr = reinterpret_cast<const float*>(Src.data());
-    size_t size = Dest.rows() * Dest.cols();
-    for (size_t i = 0; i < size; ++i) {
-        d_ptr[i] *= s_ptr[i];
-    }
-}
-
 class BenchmarkSuite {
 public:
-    static void run_model(const std::string& name, size_t hidden, size_t intermediate, bool is_moe = false) {
+    // num_experts > 1 runs a routed MoE layer over a micro-batch of `tokens`,
+    // sending every token to `top_k` experts through GemmOps::moe_ffn.
+    static void run_model(const std::string& name, size_t hidden, size_t intermediate,
+                          size_t num_experts = 1, size_t top_k = 1, size_t tokens = 1) {
+        bool is_moe = num_experts > 1;
         std::cout << "\n----------------------------------------------------------------" << std::endl;
         std::cout << "   Model: " << name << (is_moe ? " (MoE Active Experts)" : "") << std::endl;
         std::cout << "   Dim: Given=" << hidden << ", Intermediate=" << intermediate << std::endl;
+        if (is_moe) {
+            std::cout << "   Experts: " << num_experts << " (top-" << top_k << "), Tokens per step: " << tokens << std::endl;
+        }
         std::cout << "----------------------------------------------------------------" << std::endl;
 
-        size_t BatchSize = 1;
-        
-        // Weights (Frozen)
-        Tensor W_Gate(hidden, intermediate);
-        Tensor W_Up(hidden, intermediate);
-        Tensor W_Down(intermediate, hidden);
+        size_t BatchSize = tokens;
         
-        W_Gate.randomize();
-        W_Up.randomize();
-        W_Down.randomize();
+        // Weights (Frozen). Random weights, so gate/up are generated directly in
+        // the interleaved layout produced by GemmOps::pack_ffn_gate_up.
+        std::vector<Tensor> W_GateUp, W_Down;
+        W_GateUp.reserve(num_experts);
+        W_Down.reserve(num_experts);
+        std::vector<MoeExpert> experts;
+        for (size_t e = 0; e < num_experts; ++e) {
+            W_GateUp.emplace_back(hidden, 2 * ((intermediate + 7) / 8 * 8));
+            W_Down.emplace_back(intermediate, hidden);
+            W_GateUp.back().randomize();
+            W_Down.back().randomize();
+            experts.push_back({&W_GateUp.back(), &W_Down.back()});
+        }
 
         // Activations
         Tensor Input(BatchSize, hidden);
-        Tensor Gate_Out(BatchSize, intermediate);
-        Tensor Up_Out(BatchSize, intermediate);
         Tensor Down_Out(BatchSize, hidden);
 
         Input.randomize();
 
+        // Router: uniform random top-k assignment with equal gate weights
+        MoeRouting routing;
+        routing.top_k = top_k;
+        for (size_t t = 0; t < BatchSize; ++t) {
+            for (size_t k = 0; k < top_k; ++k) {
+                routing.expert_ids.push_back(static_cast<int32_t>((t * 7 + k * 13) % num_experts));
+                routing.weights.push_back(1.0f / top_k);
+            }
+        }
+
+        auto step = [&]() {
+            if (is_moe) {
+                // Gather per expert -> one grouped launch -> weighted scatter-add
+                GemmOps::moe_ffn(Input, routing, experts, Down_Out);
+            } else {
+                // FFN Flow: fused gate/up + SiLU*mul + down
+                GemmOps::ffn_swiglu(Input, W_GateUp[0], W_Down[0], Down_Out);
+            }
+        };
+
         // Warmup
-        GemmOps::gemm_extreme(Input, W_Gate, Gate_Out, 0.5f);
+        step();
 
         auto start = std::chrono::high_resolution_clock::now();
         int iterations = 10;
 
         for (int i = 0; i < iterations; ++i) {
-            // FFN Flow
-            GemmOps::gemm_extreme(Input, W_Gate, Gate_Out, 0.5f);
-            silu_activation(Gate_Out);
-            GemmOps::gemm_extreme(Input, W_Up, Up_Out, 0.5f);
-            element_wise_mul(Gate_Out, Up_Out);
-            GemmOps::gemm_extreme(Gate_Out, W_Down, Down_Out, 0.5f);
+            step();
         }
 
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> diff = end - start;
         double avg_latency_ms = (diff.count() * 1000.0) / iterations;
-        double tokens_per_sec = 1000.0 / avg_latency_ms;
+        double tokens_per_sec = 1000.0 * BatchSize / avg_latency_ms;
 
-        std::cout << "Results (Extreme Mode):" << std::endl;
+        std::cout << (is_moe ? "Results (Grouped MoE FFN):" : "Results (Fused SwiGLU FFN):") << std::endl;
         std::cout << "Lat: " << std::fixed << std::setprecision(2) << avg_latency_ms << " ms | T/s: " << tokens_per_sec << " tokens/sec" << std::endl;
         
         if (tokens_per_sec > 10.0) std::cout << "[PASS] >10 t/s" << std::endl;
@@ -96,12 +100,16 @@ int main() {
     // Hidden: 4096, Intermediate: 11008
     BenchmarkSuite::run_model("Llama-2-7B FFN", 4096, 11008);
 
-    // 2. Mixtral 8x7B (MoE)
+    // 2. Mixtral 8x7B (Single Expert)
     // Hidden: 4096, Intermediate: 14336
-    // Note: MoE activates 2 experts per token. This bench simulates the cost of ONE active path
-    // equivalent to roughly 2x this computation in serial, or parallelized.
-    // For simplicity, we benchmark a single expert's dimensions to show 'Expert Throughput'.
-    BenchmarkSuite::run_model("Mixtral 8x7B (Single Expert)", 4096, 14336, true);
+    // All 8 experts would need ~5.6 GB of FP32 weights; this measures one expert's
+    // dimensions to show 'Expert Throughput'.
+    BenchmarkSuite::run_model("Mixtral 8x7B (Single Expert)", 4096, 14336);
+
+    // 2b. OLMoE-1B-7B (Routed MoE)
+    // Hidden: 2048, Expert Intermediate: 1024, 64 experts, top-8 routing.
+    // Many small experts per token: the case grouped dispatch is built for.
+    BenchmarkSuite::run_model("OLMoE-1B-7B MoE FFN", 2048, 1024, 64, 8, 16);
 
     // 3. Falcon-40B (Large Dense)
     // Hidden: 8192, Intermediate: 32768 (Approx 4x hidden)
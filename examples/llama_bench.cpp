@@ -3,6 +3,7 @@
 #include "softaccelnpu/types.h"
 #include "softaccelnpu/cache_model.h"
 #include "softaccelnpu/device_manager.h"
+#include "softaccelnpu/dml_api.h"
 #include <iostream>
 #include <chrono>
 #include <vector>
@@ -20,50 +21,34 @@ class LlamaFFN {
 public:
     LlamaFFN(int dim, int hidden_dim) 
         : dim_(dim), hidden_dim_(hidden_dim),
-          w_gate_(hidden_dim, dim), // Gate Proj (4096 -> 11008)
-          w_up_(hidden_dim, dim),   // Up Proj   (4096 -> 11008)
-          w_down_(dim, hidden_dim)  // Down Proj (11008 -> 4096)
+          w_gate_up_(init_gate_up(dim, hidden_dim)),
+          w_down_(hidden_dim, dim),  // Down Proj (11008 -> 4096)
+          w_norm_(1, dim),
+          device_(DmlDevice::create()),
+          cmd_list_(device_->create_command_list())
     {
-        std::cout << "[LlamaFFN] Initializing Weights (Simulated)..." << std::endl;
-        w_gate_.randomize();
-        w_up_.randomize();
         w_down_.randomize();
+        w_norm_.fill(1.0f);
     }
 
-    // Forward Pass: Input (1 token, dim) -> Output (1 token, dim)
-    // FFN(x) = down(swish(gate(x)) * up(x))
-    void forward(const Tensor& input, Tensor& output) {
-        try {
-            // Intermediate buffers
-            Tensor gate_out(hidden_dim_, 1); // 11008 x 1
-            Tensor up_out(hidden_dim_, 1);   // 11008 x 1
-            Tensor down_in(hidden_dim_, 1);  // 11008 x 1 (after SiLU)
-
-            // 1. Gate Projection (Extreme Mode)
-            DeviceManager::instance().execute_op(nullptr, [&]() {
-                // Simulating INT4 + 50% Sparsity
-                GemmOps::gemm_extreme(w_gate_, input, gate_out, 0.5f);
-            });
+    // Records the block once for a fixed input/output pair; the normalized activation
+    // lives in the command list's planned arena, so steady-state tokens never allocate
+    void bind(const Tensor& input, Tensor& output) {
+        cmd_list_->reset();
+        Tensor& x_norm = cmd_list_->create_intermediate(input.rows(), dim_);
+        cmd_list_->record_rms_norm(device_->create_rms_norm_operator(), input, w_norm_, x_norm);
+        cmd_list_->record_ffn_swiglu(device_->create_ffn_operator(dim_, hidden_dim_), x_norm, w_gate_up_, w_down_, output);
+        cmd_list_->plan_memory();
+    }
 
-            // 2. Up Projection 
-            DeviceManager::instance().execute_op(nullptr, [&]() {
-                 GemmOps::gemm_extreme(w_up_, input, up_out, 0.5f);
-            });
+    const MemoryPlanStats& memory_plan() const { return cmd_list_->memory_plan(); }
 
-            // 3. Activation (SiLU / Swish) + Element-wise Multiply
-            float* g = (float*)gate_out.data();
-            float* u = (float*)up_out.data();
-            float* d = (float*)down_in.data();
-            
-            for (int i = 0; i < hidden_dim_; ++i) {
-                float val = g[i];
-                float silu = val / (1.0f + std::exp(-val)); // Sigmoid approximation
-                d[i] = silu * u[i];
-            }
-
-            // 4. Down Projection
+    // Forward Pass: Input (1 token, dim) -> Output (1 token, dim)
+    // FFN(x) = down(swish(gate(norm(x))) * up(norm(x))), fused: no hidden_dim temporaries
+    void forward() {
+        try {
             DeviceManager::instance().execute_op(nullptr, [&]() {
-                GemmOps::gemm_extreme(w_down_, down_in, output, 0.5f);
+                cmd_list_->execute();
             });
         } catch (const std::exception& e) {
             std::cerr << "[LlamaFFN Error] " << e.what() << std::endl;
@@ -72,11 +57,23 @@ public:
     }
 
 private:
+    // Gate/Up are interleaved once at load time for the fused FFN operator
+    static Tensor init_gate_up(int dim, int hidden_dim) {
+        std::cout << "[LlamaFFN] Initializing Weights (Simulated)..." << std::endl;
+        Tensor w_gate(dim, hidden_dim); // Gate Proj (4096 -> 11008)
+        Tensor w_up(dim, hidden_dim);   // Up Proj   (4096 -> 11008)
+        w_gate.randomize();
+        w_up.randomize();
+        return GemmOps::pack_ffn_gate_up(w_gate, w_up);
+    }
+
     int dim_;
     int hidden_dim_;
-    Tensor w_gate_;
-    Tensor w_up_;
+    Tensor w_gate_up_;
     Tensor w_down_;
+    Tensor w_norm_;
+    std::shared_ptr<DmlDevice> device_;
+    std::shared_ptr<DmlCommandList> cmd_list_;
 };
 
 int main() {
@@ -92,12 +89,13 @@ int main() {
 
     LlamaFFN ffn(dim, hidden_dim);
     
-    Tensor input_token(dim, 1);
-    Tensor output_token(dim, 1);
+    Tensor input_token(1, dim);
+    Tensor output_token(1, dim);
     input_token.randomize();
+    ffn.bind(input_token, output_token);
 
     std::cout << "\n[Benchmark] Warming up..." << std::endl;
-    ffn.forward(input_token, output_token);
+    ffn.forward();
     std::cout << "[Benchmark] Warmup Done." << std::endl;
 
     std::cout << "[Benchmark] Running generation..." << std::endl;
@@ -107,7 +105,7 @@ int main() {
 
     auto start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < num_tokens; ++i) {
-        ffn.forward(input_token, output_token);
+        ffn.forward();
         // In real inference, output becomes input next step (simplified here)
     }
     auto end = std::chrono::high_resolution_clock::now();
@@ -124,6 +122,9 @@ int main() {
     std::cout << "Total Time:       " << total_time << " s" << std::endl;
     std::cout << "Throughput:       " << std::fixed << std::setprecision(2) << tps << " tokens/sec" << std::endl;
     std::cout << "Latency (per FFN):" << lat_ms << " ms" << std::endl;
+    std::cout << "Activation Arena: " << ffn.memory_plan().planned_bytes << " B planned ("
+              << ffn.memory_plan().naive_bytes << " B unplanned, "
+              << ffn.memory_plan().num_buffers << " intermediates)" << std::endl;
 
     // Estimate full model performance (32 layers)
     // Note: FFN is ~2/3 of compute, Attention is ~1/3. 
@@ -1,8 +1,12 @@
 #include "softaccelnpu/ops.h"
 #include "softaccelnpu/gguf_loader.h"
 #include "softaccelnpu/power_model.h"
+#include "softaccelnpu/layer_prefetcher.h"
+#include "softaccelnpu/weight_cache.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
 
 using namespace softaccelnpu;
 
@@ -39,6 +43,31 @@ int main(int argc, char* argv[]) {
     }
     loader.print_summary();
 
+    // Map the weights instead of reading them: the cost is independent of the model size
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool mapped = loader.map_weights();
+    const double map_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (mapped) {
+        std::cout << "[Action] Mapped " << loader.mapping()->size() / 1048576.0 << " MB zero-copy in "
+                  << std::fixed << std::setprecision(3) << map_ms << " ms" << std::defaultfloat << std::endl;
+    }
+
+    // Packed panels come from <model>.packed when it matches this model, kernel and tiling;
+    // otherwise they are rebuilt once and reused by the next start
+    PackedWeightCache cache;
+    if (mapped) {
+        const auto c0 = std::chrono::steady_clock::now();
+        const std::string cache_path = loader.mapping()->path() + ".packed";
+        const WeightCacheKey key = WeightCacheKey::current(PackedWeightCache::model_hash(loader));
+        LoadStats pack_stats;
+        const bool hit = cache.load_or_build(cache_path, key, [&] { return PackedWeightCache::pack_gguf(loader, &pack_stats); });
+        const double cache_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+        std::cout << "[Action] " << (hit ? "Reused" : "Built") << " " << cache.size() << " packed weights ("
+                  << cache_path << ") in " << std::fixed << std::setprecision(3) << cache_ms << " ms"
+                  << std::defaultfloat << std::endl;
+        if (!hit) pack_stats.print("Load Pipeline (read -> transpose + pack)");
+    }
+
     // 3. Process Model Layers with Energy Efficiency Settings
     auto& metadata = loader.get_metadata();
     
@@ -47,20 +76,61 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\n[Engine] Benchmarking Model Layers (4D-V Enabled)..." << std::endl;
     
-    // Simulate processing the first few layers found in GGUF
-    for(int i=0; i<3; ++i) {
-        auto& t = metadata.tensors[i];
-        std::cout << " -> Processing " << t.name << " [" << t.shape[0] << "x" << t.shape[1] << "]" << std::endl;
-        
-        Tensor A(1, t.shape[0]), B(t.shape[0], t.shape[1]), C(1, t.shape[1]);
-        A.randomize(); B.randomize(); C.fill(0.0f);
-        
+    // Simulate processing the first few weight matrices found in GGUF
+    // (GGUF lists the contiguous dimension first: shape = {in_features, out_features})
+    size_t processed = 0;
+    for (const auto& t : metadata.tensors) {
+        if (processed == 3) break;
+        if (t.shape.size() != 2 || t.shape[0] <= 0 || t.shape[1] <= 0) continue;
+        const size_t K = static_cast<size_t>(t.shape[0]), N = static_cast<size_t>(t.shape[1]);
+        std::cout << " -> Processing " << t.name << " [" << K << "x" << N << "] " << t.type
+                  << " @ " << t.data_offset << std::endl;
+
+        // Packed weights are used straight from the mapped cache as Tiled K x N panels;
+        // block-quantized ones get a random stand-in of the same shape
+        const bool direct = cache.contains(t.name);
+        Tensor B = direct ? cache.get(t.name) : Tensor(K, N);
+        if (!direct) B.randomize();
+        Tensor A(1, K), C(1, N);
+        A.randomize(); C.fill(0.0f);
+        std::cout << "    weights: " << (direct ? "packed cache, zero-copy" : "simulated") << std::endl;
+
         // Use software-defined acceleration with Kernel Fusion enabled
         GemmOps::set_benchmark_mode(true);
         GemmOps::gemm_tiled(A, B, C, nullptr, true);
+        processed++;
+    }
+    if (processed == 0) {
+        std::cout << " -> No 2D weight tensors found (run scripts/make_dummy_gguf.py to create dummy_model.gguf)" << std::endl;
+    }
+
+    // 4. Stream every layer with the next ones prefetched on an I/O thread, dropping
+    //    finished layers so only ~depth + 1 layers are resident at a time
+    if (mapped) {
+        std::cout << "\n[Engine] Streaming all layers (prefetch depth 2)..." << std::endl;
+        PrefetchOptions popts;
+        popts.drop_finished = true;
+        LayerPrefetcher prefetcher(loader.mapping(), LayerPrefetcher::gguf_layers(loader), popts);
+        for (size_t l = 0; l < prefetcher.num_layers(); ++l) {
+            const LayerRegion& region = prefetcher.layer(l);
+            prefetcher.begin_layer(l);
+            for (const auto& t : metadata.tensors) {
+                if (t.shape.size() != 2 || !(t.type == "F32" || t.type == "F16" || t.type == "BF16")) continue;
+                const bool in_layer = std::any_of(region.ranges.begin(), region.ranges.end(), [&](const auto& r) {
+                    return t.data_offset >= r.first && t.data_offset < r.first + r.second;
+                });
+                if (!in_layer) continue;
+                const MappedTensor W = loader.tensor(t.name);
+                Tensor x(1, W->rows()), y(1, W->cols());
+                x.fill(0.01f);
+                GemmOps::gemm_tiled(x, *W, y, nullptr, true);
+            }
+            prefetcher.end_layer(l);
+        }
+        prefetcher.print_report();
     }
 
-    // 4. Final Energy Report
+    // 5. Final Energy Report
     PowerModel::print_power_report();
     
     std::cout << "[Success] v6.0 Production Test Complete." << std::endl;
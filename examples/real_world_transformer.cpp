@@ -75,13 +75,18 @@ int main() {
     // Path B: SoftAccelNPU Optimized (Tiled + AVX2)
     // ---------------------------------------------------------
     std::cout << "[2/2] Running Optimized NPU Path..." << std::endl;
+
+    // Weights are re-laid out once, as at model load, so the GEMMs stream B panels directly
+    const Tensor W_proj_t = W_proj.to_layout(Layout::Tiled);
+    const Tensor W_ffn1_t = W_ffn1.to_layout(Layout::Tiled);
+    const Tensor W_ffn2_t = W_ffn2.to_layout(Layout::Tiled);
     
     Tensor NPU_1(SeqLen, Dim);
     Tensor NPU_2(SeqLen, HiddenDim);
     Tensor NPU_Out(SeqLen, Dim);
 
-    GemmOps::gemm_tiled(Input, W_proj, NPU_1);
-    GemmOps::gemm_tiled(NPU_1, W_ffn1, NPU_2);
+    GemmOps::gemm_tiled(Input, W_proj_t, NPU_1);
+    GemmOps::gemm_tiled(NPU_1, W_ffn1_t, NPU_2);
     
     // Use NPU SiLU via fake manual implementation for now since core SiLU is in DML API
     // but we want to test the multi-layer pipeline accuracy.
@@ -91,7 +96,7 @@ int main() {
         npu_data2[i] = x / (1.0f + std::exp(-x));
     }
 
-    GemmOps::gemm_tiled(NPU_2, W_ffn2, NPU_Out);
+    GemmOps::gemm_tiled(NPU_2, W_ffn2_t, NPU_Out);
 
     // ---------------------------------------------------------
     // Accuracy Comparison
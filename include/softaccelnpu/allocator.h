@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file allocator.h
+ * @brief Pluggable storage allocators for Tensor.
+ */
+
+namespace softaccelnpu {
+
+/** @brief Process-wide counters of the built-in allocators. */
+struct AllocationStats {
+    size_t allocations = 0;         // Successful allocate() calls
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;     // Cumulative
+    size_t bytes_in_use = 0;
+    size_t peak_bytes_in_use = 0;
+    size_t huge_page_bytes = 0;     // Cumulative bytes backed by (or advised to) 2 MB pages
+};
+
+/**
+ * @class TensorAllocator
+ * @brief Storage provider for Tensor buffers.
+ *
+ * Every buffer is at least ALIGNMENT-byte aligned so rows can be loaded with aligned
+ * AVX/AVX-512 accesses and never straddle a cache line at offset 0. Allocators must be
+ * thread-safe and outlive every tensor they allocated.
+ */
+class TensorAllocator {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    virtual ~TensorAllocator() = default;
+
+    /** @throws std::bad_alloc on failure. Never returns nullptr for bytes > 0. */
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void* ptr, size_t bytes) = 0;
+
+    /**
+     * @brief True if a buffer of this size comes back already zeroed (fresh anonymous
+     * mappings do), letting Tensor skip the zero-fill.
+     */
+    virtual bool returns_zeroed(size_t bytes) const { (void)bytes; return false; }
+
+    virtual const char* name() const = 0;
+};
+
+/** @brief 64-byte aligned heap allocator (posix_memalign / _aligned_malloc). */
+class AlignedAllocator : public TensorAllocator {
+public:
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr, size_t bytes) override;
+    const char* name() const override { return "aligned"; }
+};
+
+/**
+ * @class HugePageAllocator
+ * @brief Maps large buffers on 2 MB pages to cut TLB misses on multi-GB weights.
+ *
+ * Buffers of at least min_bytes are mmap'ed 2 MB aligned. If use_hugetlbfs is set, a
+ * MAP_HUGETLB mapping from the reserved hugetlbfs pool is tried first; otherwise (or
+ * when the pool is empty) the range is advised MADV_HUGEPAGE so transparent huge pages
+ * back it. Smaller buffers, and platforms without mmap, use AlignedAllocator. Mapped
+ * buffers arrive zeroed, so zero-initialized tensors cost no extra pass.
+ */
+class HugePageAllocator : public TensorAllocator {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    explicit HugePageAllocator(size_t min_bytes = HUGE_PAGE_SIZE, bool use_hugetlbfs = false)
+        : min_bytes_(min_bytes), use_hugetlbfs_(use_hugetlbfs) {}
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr, size_t bytes) override;
+    bool returns_zeroed(size_t bytes) const override;
+    const char* name() const override { return "hugepage"; }
+
+private:
+    bool is_mapped(size_t bytes) const;
+
+    size_t min_bytes_;
+    bool use_hugetlbfs_;
+    AlignedAllocator small_;
+};
+
+/** @brief Allocator used by tensors constructed without one (a HugePageAllocator). */
+TensorAllocator& default_tensor_allocator();
+
+/**
+ * @brief Replaces the default allocator for tensors created afterwards; nullptr restores
+ * the built-in one. Existing tensors keep the allocator they were created with.
+ */
+void set_default_tensor_allocator(TensorAllocator* allocator);
+
+AllocationStats get_allocation_stats();
+/** @brief Clears the cumulative counters and resets the peak to the current usage. */
+void reset_allocation_stats();
+
+} // namespace softaccelnpu
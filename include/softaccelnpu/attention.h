@@ -0,0 +1,85 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include "softaccelnpu/kv_cache.h"
+
+/**
+ * @file attention.h
+ * @brief Fused scaled-dot-product attention operators.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @brief Shape description for AttentionOps.
+ *
+ * Activations are token-major with heads interleaved along columns:
+ *   Q, O: seq_q  x (num_heads    * head_dim)
+ *   K, V: seq_kv x (num_kv_heads * head_dim)
+ * num_heads must be a multiple of num_kv_heads (grouped-query attention).
+ * With causal masking, query i sits at absolute position q_pos + i and attends
+ * keys 0 .. q_pos + i. q_pos defaults to seq_kv - seq_q (queries are the newest tokens).
+ */
+struct AttentionDesc {
+    size_t num_heads = 1;
+    size_t num_kv_heads = 1;
+    size_t head_dim = 0;
+    size_t seq_q = 0;
+    size_t seq_kv = 0;
+    bool causal = true;
+    float scale = 0.0f;        // 0 -> 1/sqrt(head_dim)
+    size_t q_pos = SIZE_MAX;   // SIZE_MAX -> seq_kv - seq_q
+    size_t kv_splits = 0;      // decode_attention only: 0 -> chosen from thread count
+};
+
+/**
+ * @class AttentionOps
+ * @brief Attention kernels that never materialize the seq_q x seq_kv score matrix.
+ */
+class AttentionOps {
+public:
+    /**
+     * @brief Tiled (flash-style) attention: O = softmax(Q K^T * scale) V.
+     *
+     * K/V are streamed in blocks; each query block keeps a running row max and
+     * sum and rescales its output accumulator as new blocks arrive (online softmax).
+     * Work is parallelized over heads x query blocks.
+     */
+    static void flash_attention(const Tensor& Q, const Tensor& K, const Tensor& V, Tensor& O, const AttentionDesc& desc);
+
+    /**
+     * @brief Split-K attention for decode (seq_q of one or a few tokens).
+     *
+     * The KV length is divided into kv_splits ranges; each (kv head, split) task
+     * computes partial softmax statistics for all query heads sharing that kv head,
+     * and the partials are merged with a log-sum-exp reduction. Keeps every core
+     * busy on long contexts even with few (GQA) kv heads.
+     */
+    static void decode_attention(const Tensor& Q, const Tensor& K, const Tensor& V, Tensor& O, const AttentionDesc& desc);
+
+    /**
+     * @brief Split-K attention against one sequence/layer of a PagedKVCache.
+     *
+     * Walks the sequence's block table page by page (INT8 pages are dequantized per
+     * block in L1), so no contiguous K/V copy is made. desc.seq_kv is ignored: the
+     * resident tokens of the sequence are used, and q_pos defaults to
+     * length - seq_q, i.e. the queries are the most recently appended tokens.
+     */
+    static void paged_attention(const Tensor& Q, const PagedKVCache& cache, PagedKVCache::SeqId seq, size_t layer,
+                                Tensor& O, const AttentionDesc& desc);
+
+    /**
+     * @brief Number of KV splits decode_attention uses for a (causally visible) KV length.
+     */
+    static size_t select_kv_splits(const AttentionDesc& desc, size_t kv_len);
+
+    /**
+     * @brief Query/key block sizes used by flash_attention for a given head_dim.
+     *
+     * Derived from HardwareInfo cache sizes: a K+V block targets L1, the query
+     * block and its output accumulator target L2.
+     */
+    static void select_tiles(size_t head_dim, size_t& block_q, size_t& block_kv);
+};
+
+} // namespace softaccelnpu
@@ -28,10 +28,18 @@ NPU_API void npu_delete_device(NpuDeviceHandle device);
 NPU_API NpuCommandListHandle npu_device_create_command_list(NpuDeviceHandle device);
 NPU_API void npu_delete_command_list(NpuCommandListHandle cmd_list);
 
+// Operator constructors return NULL for negative sizes, strides or leading dimensions;
+// recording a NULL operator is a no-op
 NPU_API NpuOperatorHandle npu_create_gemm_operator(NpuDeviceHandle device, int M, int N, int K);
+NPU_API NpuOperatorHandle npu_create_batched_gemm_operator(
+    NpuDeviceHandle device, int batch, int M, int N, int K,
+    int lda, int ldb, int ldc,
+    long long stride_a, long long stride_b, long long stride_c,
+    bool trans_b);
 NPU_API void npu_delete_operator(NpuOperatorHandle op);
 
 NPU_API void npu_command_list_record_gemm(NpuCommandListHandle cmd_list, NpuOperatorHandle op, NpuTensorHandle A, NpuTensorHandle B, NpuTensorHandle C);
+NPU_API void npu_command_list_record_gemm_batched(NpuCommandListHandle cmd_list, NpuOperatorHandle op, NpuTensorHandle A, NpuTensorHandle B, NpuTensorHandle C);
 NPU_API void npu_command_list_execute(NpuCommandListHandle cmd_list);
 NPU_API void npu_command_list_reset(NpuCommandListHandle cmd_list);
 
@@ -42,6 +50,8 @@ NPU_API void npu_execute_gemm_extreme(NpuTensorHandle A, NpuTensorHandle B, NpuT
 NPU_API void npu_reset_cache();
 NPU_API void npu_print_report();
 NPU_API double npu_get_l1_hit_rate();
+// Achieved compressed-weight stream ratio (dense / moved bytes) when compressed weights
+// have run since npu_reset_cache(); the modelled 4D-V ratio otherwise
 NPU_API double npu_get_compression_ratio();
 NPU_API void npu_set_benchmark_mode(bool enable);
 
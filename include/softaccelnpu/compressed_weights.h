@@ -0,0 +1,53 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file compressed_weights.h
+ * @brief Zero-bitmask compressed FP32 weights, expanded in the kernels.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @struct CompressedWeights
+ * @brief A K x N FP32 weight matrix with its zeros removed from memory.
+ *
+ * Columns are grouped into PANEL-wide panels as in Layout::Tiled. For every panel
+ * row, a 16-bit mask marks the nonzero columns, and only those values are kept in
+ * a dense stream in (panel, k, column) order:
+ *   masks  [p * K + k]           bit j set: W[k, p * PANEL + j] != 0
+ *   offsets[p * tiles_k() + t]   stream index of panel p's first value in rows t * TILE_K onwards
+ *   values [...]                 the nonzeros, followed by PANEL zeros of padding
+ * A panel row is expanded with two 8-lane LUT permutes, so any KC block can be
+ * decoded into the micro-kernel's packing buffer without touching the skipped zeros.
+ */
+struct CompressedWeights {
+    static constexpr size_t PANEL = Tensor::TILE_WIDTH;
+    static constexpr size_t TILE_K = 64;  // Rows per stream offset entry
+
+    size_t rows = 0;  // K
+    size_t cols = 0;  // N
+    std::vector<uint16_t> masks;
+    std::vector<uint32_t> offsets;
+    std::vector<float> values;
+
+    size_t panels() const { return (cols + PANEL - 1) / PANEL; }
+    size_t tiles_k() const { return (rows + TILE_K - 1) / TILE_K; }
+    size_t nnz() const { return values.size() > PANEL ? values.size() - PANEL : 0; }  // values is empty until built
+
+    /** @brief Bytes of the compressed representation (masks, offsets and nonzeros, without padding). */
+    size_t bytes() const;
+    /** @brief FP32 bytes of the same matrix divided by bytes(). */
+    double compression_ratio() const;
+
+    /** @brief Compresses an FP32 RowMajor tensor, dropping exact zeros (either sign). */
+    static CompressedWeights from_dense(const Tensor& W);
+
+    /** @brief FP32 RowMajor expansion, for reference checks. */
+    Tensor to_dense() const;
+};
+
+} // namespace softaccelnpu
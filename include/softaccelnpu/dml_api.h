@@ -2,6 +2,10 @@
 
 #include "softaccelnpu/tensor.h"
 #include "softaccelnpu/device_manager.h"
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/attention.h"
+#include "softaccelnpu/transformer_ops.h"
+#include "softaccelnpu/memory_planner.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -22,6 +26,15 @@ public:
     
     std::shared_ptr<DmlCommandList> create_command_list();
     std::shared_ptr<DmlOperator> create_gemm_operator(size_t M, size_t N, size_t K);
+    std::shared_ptr<DmlOperator> create_ffn_operator(size_t dim, size_t hidden_dim);
+    std::shared_ptr<DmlOperator> create_batched_gemm_operator(const GemmBatchDesc& desc);
+    std::shared_ptr<DmlOperator> create_attention_operator(const AttentionDesc& desc);
+    std::shared_ptr<DmlOperator> create_decode_attention_operator(const AttentionDesc& desc);
+    std::shared_ptr<DmlOperator> create_rms_norm_operator(float eps = 1e-6f);
+    std::shared_ptr<DmlOperator> create_layer_norm_operator(float eps = 1e-5f);
+    std::shared_ptr<DmlOperator> create_rope_operator(size_t num_heads, size_t head_dim, size_t max_positions,
+                                                      float theta = 10000.0f, bool interleaved = false);
+    std::shared_ptr<DmlOperator> create_softmax_operator();
     
     // Performance stats
     void print_report();
@@ -36,24 +49,67 @@ struct DmlGemmDescriptor {
     float beta = 0.0f;
 };
 
+/**
+ * @brief Descriptor for the fused SwiGLU feed-forward operation.
+ */
+struct DmlFfnDescriptor {
+    size_t dim;
+    size_t hidden_dim;
+};
+
+/**
+ * @brief Descriptor for RMSNorm / LayerNorm.
+ */
+struct DmlNormDescriptor {
+    float eps;
+};
+
+/**
+ * @brief Descriptor for rotary position embedding.
+ */
+struct DmlRopeDescriptor {
+    size_t num_heads;
+    size_t head_dim;
+};
+
 /**
  * @brief Represents a compiled operator, similar to IDMLCompiledOperator.
  */
 class DmlOperator {
 public:
-    enum class Ty { GEMM, ELEMENTWISE_BIAS, ACTIVATION };
+    enum class Ty { GEMM, ELEMENTWISE_BIAS, ACTIVATION, FFN_SWIGLU, GEMM_BATCHED, ATTENTION, DECODE_ATTENTION,
+                    RMS_NORM, LAYER_NORM, ROPE, SOFTMAX };
     enum class ActivationTy { RELU, SILU };
     
     DmlOperator(Ty type, DmlGemmDescriptor desc) : type_(type), gemm_desc_(desc) {}
     DmlOperator(Ty type, ActivationTy act) : type_(type), activation_ty_(act) {}
+    DmlOperator(Ty type, DmlFfnDescriptor desc) : type_(type), ffn_desc_(desc) {}
+    DmlOperator(Ty type, GemmBatchDesc desc) : type_(type), batch_desc_(desc) {}
+    DmlOperator(Ty type, AttentionDesc desc) : type_(type), attention_desc_(desc) {}
+    DmlOperator(Ty type, DmlNormDescriptor desc) : type_(type), norm_desc_(desc) {}
+    DmlOperator(Ty type, DmlRopeDescriptor desc, std::shared_ptr<const RopeTable> table)
+        : type_(type), rope_desc_(desc), rope_table_(std::move(table)) {}
+    explicit DmlOperator(Ty type) : type_(type) {}
     
     Ty get_type() const { return type_; }
     const DmlGemmDescriptor& get_gemm_desc() const { return gemm_desc_; }
     ActivationTy get_activation_type() const { return activation_ty_; }
+    const DmlFfnDescriptor& get_ffn_desc() const { return ffn_desc_; }
+    const GemmBatchDesc& get_batch_desc() const { return batch_desc_; }
+    const AttentionDesc& get_attention_desc() const { return attention_desc_; }
+    const DmlNormDescriptor& get_norm_desc() const { return norm_desc_; }
+    const DmlRopeDescriptor& get_rope_desc() const { return rope_desc_; }
+    const RopeTable& get_rope_table() const { return *rope_table_; }
 
 private:
     Ty type_;
-    DmlGemmDescriptor gemm_desc_;
+    DmlGemmDescriptor gemm_desc_{};
+    DmlFfnDescriptor ffn_desc_{};
+    GemmBatchDesc batch_desc_{};
+    AttentionDesc attention_desc_{};
+    DmlNormDescriptor norm_desc_{};
+    DmlRopeDescriptor rope_desc_{};
+    std::shared_ptr<const RopeTable> rope_table_;  // Precomputed once at operator creation
     ActivationTy activation_ty_ = ActivationTy::RELU;
 };
 
@@ -62,11 +118,31 @@ private:
  */
 class DmlCommandList {
 public:
+    /**
+     * @brief Records C += A * B. Operands may be whole tensors or strided views
+     * (row blocks, head slices); views are executed in place.
+     */
     void record_gemm(
         std::shared_ptr<DmlOperator> op,
-        const Tensor& A,
+        const TensorView& A,
+        const TensorView& B,
+        const TensorView& C
+    );
+
+    /** @brief Records C += A * B for a whole weight tensor B, which may be Layout::Tiled. */
+    void record_gemm(
+        std::shared_ptr<DmlOperator> op,
+        const TensorView& A,
         const Tensor& B,
-        Tensor& C
+        const TensorView& C
+    );
+
+    /** @brief Records C += A * B for 2:4 sparse weights (see GemmOps::gemm_sparse24). */
+    void record_gemm(
+        std::shared_ptr<DmlOperator> op,
+        const TensorView& A,
+        const Sparse24Weights& B,
+        const TensorView& C
     );
 
     void record_bias_add(
@@ -81,11 +157,113 @@ public:
         Tensor& output
     );
 
+    /**
+     * @brief Records a strided batched GEMM (see GemmOps::gemm_batched_strided).
+     */
+    void record_gemm_batched(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& A,
+        const Tensor& B,
+        Tensor& C
+    );
+
+    /**
+     * @brief Records fused causal/non-causal attention (see AttentionOps::flash_attention).
+     */
+    void record_attention(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& Q,
+        const Tensor& K,
+        const Tensor& V,
+        Tensor& O
+    );
+
+    /**
+     * @brief Records split-K decode attention (see AttentionOps::decode_attention).
+     */
+    void record_decode_attention(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& Q,
+        const Tensor& K,
+        const Tensor& V,
+        Tensor& O
+    );
+
+    /**
+     * @brief Records Y = RMSNorm(X) * weight (see TransformerOps::rms_norm).
+     */
+    void record_rms_norm(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& X,
+        const Tensor& weight,
+        Tensor& Y
+    );
+
+    /**
+     * @brief Records Y = LayerNorm(X) * gamma + beta (see TransformerOps::layer_norm).
+     */
+    void record_layer_norm(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& X,
+        const Tensor& gamma,
+        const Tensor& beta,
+        Tensor& Y
+    );
+
+    /**
+     * @brief Records in-place rotary embedding of X, whose first row is at position pos0.
+     */
+    void record_rope(
+        std::shared_ptr<DmlOperator> op,
+        Tensor& X,
+        size_t pos0
+    );
+
+    /**
+     * @brief Records a row-wise softmax (see TransformerOps::softmax).
+     */
+    void record_softmax(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& input,
+        Tensor& output
+    );
+
+    /**
+     * @brief Records a fused SwiGLU FFN (see GemmOps::ffn_swiglu).
+     * @param W_gate_up Interleaved weights from GemmOps::pack_ffn_gate_up.
+     */
+    void record_ffn_swiglu(
+        std::shared_ptr<DmlOperator> op,
+        const Tensor& X,
+        const Tensor& W_gate_up,
+        const Tensor& W_down,
+        Tensor& Y
+    );
+
+    /**
+     * @brief Creates a transient tensor owned by the command list, for activations that
+     * only live between recorded commands. It stays valid until reset().
+     */
+    Tensor& create_intermediate(size_t rows, size_t cols, DataType dtype = DataType::FP32);
+
+    /**
+     * @brief Packs all intermediates into one reusable arena by command-order liveness.
+     *
+     * Call once, after recording. Elementwise commands (bias, activation, norms,
+     * softmax) may write in place over an input that dies there. Planned intermediates
+     * are transient: their contents are undefined between executions, and a GEMM that
+     * first writes one accumulates onto zeros.
+     * @return Arena bytes (the planned activation peak).
+     */
+    size_t plan_memory();
+    const MemoryPlanStats& memory_plan() const { return plan_stats_; }
+
     /**
      * @brief Executes all recorded commands.
      */
     void execute();
 
+    /** @brief Drops recorded commands and intermediates. */
     void reset();
 
 private:
@@ -95,8 +273,19 @@ private:
         const Tensor* A; // or input
         const Tensor* B; // or bias
         Tensor* C;       // or output
+        const Tensor* D = nullptr; // extra input (e.g. FFN down projection, attention V)
+        size_t position = 0;       // RoPE start position
+        TensorView view_a{}, view_b{}, view_c{}; // GEMM operands
+        bool clear_c = false;      // Zero the accumulator first (planned intermediate output)
+        const Sparse24Weights* sparse_b = nullptr; // GEMM weights in 2:4 sparse form
     };
+    // GEMM command with its A and C views; each record_gemm overload attaches its form of B
+    static Command gemm_command(std::shared_ptr<DmlOperator> op, const TensorView& A, const TensorView& C);
+
     std::vector<Command> commands_;
+    std::vector<std::unique_ptr<Tensor>> intermediates_;
+    std::unique_ptr<Tensor> arena_;
+    MemoryPlanStats plan_stats_;
 };
 
 /**
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file fp8.h
+ * @brief FP8 (E4M3 / E5M2) conversion and scaled FP8 weight tensors.
+ */
+
+namespace softaccelnpu {
+
+// Encoding rounds to nearest even and saturates to the largest finite value
+// (448 for E4M3, 57344 for E5M2); NaN encodes as the format's NaN
+float fp8_e4m3_to_fp32(uint8_t v);
+float fp8_e5m2_to_fp32(uint8_t v);
+uint8_t fp32_to_fp8_e4m3(float f);
+uint8_t fp32_to_fp8_e5m2(float f);
+
+// Bulk conversions; dtype selects FP8_E4M3 or FP8_E5M2. Decoding runs 8 values per step
+void convert_fp8_to_fp32(const uint8_t* src, float* dst, size_t count, DataType dtype);
+void convert_fp32_to_fp8(const float* src, uint8_t* dst, size_t count, DataType dtype);
+
+/** @brief Largest finite value of an FP8 format. */
+inline float fp8_max(DataType dtype) { return dtype == DataType::FP8_E5M2 ? 57344.0f : 448.0f; }
+
+/**
+ * @struct Fp8Weights
+ * @brief FP8 weight matrix (K x N) with per-tensor or per-output-channel scales.
+ *
+ * W[k][n] = decode(data[k][n]) * scale(n). The bytes stay FP8 in memory; kernels widen
+ * them in registers and apply the scale once per output column.
+ */
+struct Fp8Weights {
+    Tensor data{0, 0, DataType::FP8_E4M3};
+    std::vector<float> scales;  // 1 value (per-tensor) or N values (per-channel)
+
+    float scale(size_t n) const { return scales.size() == 1 ? scales[0] : scales[n]; }
+
+    /** @brief One scale per column of data; throws if the dtype or scale count is invalid. */
+    std::vector<float> column_scales() const;
+
+    /**
+     * @brief Quantizes FP32 weights: each scale maps the channel's (or tensor's) absmax
+     * onto the format's largest finite value.
+     */
+    static Fp8Weights quantize(const Tensor& W, DataType format = DataType::FP8_E4M3, bool per_channel = true,
+                               Layout layout = Layout::Tiled);
+
+    /** @brief FP32 RowMajor copy, for reference checks. */
+    Tensor dequantize() const;
+};
+
+} // namespace softaccelnpu
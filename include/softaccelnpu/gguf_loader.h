@@ -4,45 +4,157 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include "softaccelnpu/mapped_file.h"
+#include "softaccelnpu/tensor.h"
 
 namespace softaccelnpu {
 
+/** @brief GGUF metadata value types (gguf_type in the specification). */
+enum class GgufType : uint32_t {
+    UINT8 = 0, INT8 = 1, UINT16 = 2, INT16 = 3, UINT32 = 4, INT32 = 5,
+    FLOAT32 = 6, BOOL = 7, STRING = 8, ARRAY = 9, UINT64 = 10, INT64 = 11, FLOAT64 = 12
+};
+
+/**
+ * @brief One metadata value. Scalars are widened into u64 / i64 / f64 (all three are set
+ * for numeric types), strings into str; arrays keep their element type and elements.
+ */
+struct GgufValue {
+    GgufType type = GgufType::UINT8;
+    GgufType array_type = GgufType::UINT8;  // Element type when type == ARRAY
+    uint64_t u64 = 0;
+    int64_t i64 = 0;
+    double f64 = 0.0;
+    std::string str;
+    std::vector<GgufValue> array;
+
+    /** @brief Human-readable rendering; long arrays are summarized. */
+    std::string to_string() const;
+};
+
+/**
+ * @brief Read-only tensor over mapped GGUF weights.
+ *
+ * Dereferences to a const Tensor that points straight into the mapping, so nothing is
+ * copied, and holds a reference on that mapping: the data stays valid after the loader
+ * is reset or loads another file. Copying the Tensor (e.g. Tensor W = *t) gives an
+ * owning, writable copy; MappedTensor itself is move-only so it is never copied by accident.
+ */
+class MappedTensor {
+public:
+    MappedTensor(std::shared_ptr<const MappedFile> mapping, Tensor tensor)
+        : mapping_(std::move(mapping)), tensor_(std::move(tensor)) {}
+    MappedTensor(MappedTensor&&) noexcept = default;
+    MappedTensor& operator=(MappedTensor&&) noexcept = default;
+    MappedTensor(const MappedTensor&) = delete;
+    MappedTensor& operator=(const MappedTensor&) = delete;
+
+    const Tensor& operator*() const { return tensor_; }
+    const Tensor* operator->() const { return &tensor_; }
+    operator const Tensor&() const { return tensor_; }
+    const std::shared_ptr<const MappedFile>& mapping() const { return mapping_; }
+
+private:
+    std::shared_ptr<const MappedFile> mapping_;
+    Tensor tensor_;
+};
+
 /**
- * @brief Lightweight GGUF (GPT-Generated Unified Format) Loader.
- * 
- * This class handles the parsing of GGUF model files to extract
- * tensor shapes, quantization types, and model metadata.
+ * @brief GGUF (GPT-Generated Unified Format) v2/v3 header parser.
+ *
+ * Reads every metadata key/value pair (all scalar types, strings and nested arrays) and
+ * every tensor info (name, shape, ggml type, offset), then resolves general.alignment
+ * and the absolute file offset of each tensor's data. The header region is read with a
+ * few large buffered reads, so files with thousands of tensors parse in milliseconds.
  */
 class GgufLoader {
 public:
     struct TensorInfo {
         std::string name;
-        std::vector<int64_t> shape;
-        std::string type; // e.g., "F32", "Q4_0", "Q8_0"
-        uint64_t offset;
+        std::vector<int64_t> shape;   // GGUF order: shape[0] is the contiguous (innermost) dimension
+        std::string type;             // ggml type name, e.g. "F32", "Q4_0", "Q8_0"
+        uint32_t ggml_type = 0;
+        uint64_t offset = 0;          // Relative to the start of the data section, as stored
+        uint64_t data_offset = 0;     // Absolute file offset of the tensor data
+        uint64_t size_bytes = 0;      // Bytes of data (0 for ggml types this loader does not know)
+
+        uint64_t elements() const;
     };
 
     struct ModelMetadata {
         std::string architecture;
-        uint64_t tensor_count;
-        uint64_t kv_count;
-        std::map<std::string, std::string> kv_pairs;
+        uint32_t version = 0;
+        uint64_t tensor_count = 0;
+        uint64_t kv_count = 0;
+        uint64_t alignment = 32;      // general.alignment, 32 when absent
+        uint64_t data_offset = 0;     // Absolute file offset of the (aligned) data section
+        uint64_t file_size = 0;
+        std::map<std::string, std::string> kv_pairs;  // Rendered values, for display
+        std::map<std::string, GgufValue> values;      // Typed values
         std::vector<TensorInfo> tensors;
     };
 
     GgufLoader() = default;
 
     /**
-     * @brief Parses a GGUF file header and extracts metadata.
-     * Note: This is a lightweight reader for research and simulation.
+     * @brief Parses a GGUF file header: metadata, tensor infos and data offsets.
+     * Returns false (with a message on stderr) for unreadable, truncated or malformed files;
+     * tensor data itself is not read.
      */
     bool load_header(const std::string& path);
 
+    /**
+     * @brief Maps the loaded file read-only so tensor() can hand out weights without copying.
+     * Mapping a multi-GB model takes milliseconds: pages are read from the page cache on
+     * first touch (or up front with options.populate) and shared with other processes
+     * mapping the same file. Returns false (with a message on stderr) if no header is
+     * loaded or the file cannot be mapped.
+     */
+    bool map_weights(const MapOptions& options = {});
+    bool is_mapped() const { return mapping_ != nullptr; }
+    /** @brief The current mapping; holding it keeps tensor data valid after the loader is reset. */
+    std::shared_ptr<const MappedFile> mapping() const { return mapping_; }
+
+    /** @brief Start of a tensor's bytes in the mapping; nullptr if not mapped. */
+    const uint8_t* tensor_data(const TensorInfo& info) const;
+    /**
+     * @brief Zero-copy, read-only view of a mapped F32 / F16 / BF16 / I8 weight.
+     * GGUF rows are contiguous along shape[0], so the tensor is RowMajor with
+     * cols = shape[0] and rows = the product of the remaining dimensions: a weight
+     * stored as {in_features, out_features} comes back as [out_features x in_features].
+     * @throws std::invalid_argument if the tensor is absent, not mapped, or block-quantized.
+     */
+    MappedTensor tensor(const std::string& name) const;
+    /**
+     * @brief Owning FP32 copy of a mapped weight in the same [rows x cols] shape as tensor(),
+     * decoding Q8_0 and Q4_0 blocks as well as F32 / F16 / BF16 storage.
+     * @throws std::invalid_argument if the tensor is absent, not mapped, or of another type.
+     */
+    Tensor dequantize(const std::string& name) const;
+
     const ModelMetadata& get_metadata() const { return metadata_; }
     void print_summary() const;
 
+    /** @brief Typed metadata lookup; nullptr if key is absent. */
+    const GgufValue* find(const std::string& key) const;
+    /** @brief Unsigned integer metadata value, or fallback when absent or not numeric. */
+    uint64_t get_u64(const std::string& key, uint64_t fallback = 0) const;
+    /** @brief String metadata value, or fallback when absent or not a string. */
+    std::string get_string(const std::string& key, const std::string& fallback = "") const;
+    /** @brief Tensor info by name; nullptr if absent. */
+    const TensorInfo* find_tensor(const std::string& name) const;
+
+    /** @brief Name of a ggml type id ("F32", "Q4_K", ...), or "TYPE_<id>" if unknown. */
+    static std::string ggml_type_name(uint32_t type);
+    /** @brief Bytes occupied by elements values of a ggml type; 0 if the type is unknown. */
+    static uint64_t ggml_type_size(uint32_t type, uint64_t elements);
+
 private:
     ModelMetadata metadata_;
+    std::string path_;
+    std::shared_ptr<const MappedFile> mapping_;
 };
 
 } // namespace softaccelnpu
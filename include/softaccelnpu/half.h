@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file half.h
+ * @brief IEEE binary16 (FP16) and bfloat16 (BF16) conversion.
+ *
+ * FP16 uses the F16C vcvtph2ps/vcvtps2ph instructions. BF16 is the upper 16 bits of
+ * an FP32 value, so widening is a shift and narrowing rounds to nearest even. Both
+ * are stored as raw uint16_t bit patterns.
+ */
+
+namespace softaccelnpu {
+
+float fp16_to_fp32(uint16_t h);
+uint16_t fp32_to_fp16(float f);
+float bf16_to_fp32(uint16_t h);
+uint16_t fp32_to_bf16(float f);
+
+// Bulk conversions, 8 values per instruction with a scalar tail
+void convert_fp16_to_fp32(const uint16_t* src, float* dst, size_t count);
+void convert_fp32_to_fp16(const float* src, uint16_t* dst, size_t count);
+void convert_bf16_to_fp32(const uint16_t* src, float* dst, size_t count);
+void convert_fp32_to_bf16(const float* src, uint16_t* dst, size_t count);
+
+} // namespace softaccelnpu
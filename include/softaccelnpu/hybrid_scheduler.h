@@ -2,6 +2,7 @@
 
 #include "softaccelnpu/tensor.h"
 #include "softaccelnpu/ops.h"
+#include "softaccelnpu/device_manager.h"
 #include <vector>
 #include <memory>
 
@@ -13,28 +14,23 @@ public:
     // gpu_ratio: fraction of work to send to GPU (0.0 to 1.0)
     static void gemm_hybrid(const Tensor& A, const Tensor& B, Tensor& C, float gpu_ratio = 0.8f) {
         size_t M = A.rows();
-        size_t N = B.cols();
-        size_t K = A.cols();
 
         size_t m_gpu = static_cast<size_t>(M * gpu_ratio);
         size_t m_cpu = M - m_gpu;
 
-        // In a real implementation:
-        // 1. Launch GPU kernel for rows [0, m_gpu) asynchronously
-        // 2. Run CPU kernel (gemm_tiled) for rows [m_gpu, M)
-        // 3. Synchronize GPU
-        
         log_info("Hybrid Execution: GPU (" + std::to_string(m_gpu) + " rows), CPU (" + std::to_string(m_cpu) + " rows)");
 
+        // Row partitions are views into A and C: no sub-tensor copies
+        const TensorView a(A), c(C);
+
         if (m_gpu > 0) {
-            // Mock GPU Execution
-            // In reality: gpu_kernel->gemm(...)
+            // GPU kernel slot (falls back to the best CPU kernel when no GPU is available)
+            MicroKernel* gpu = DeviceManager::instance().get_kernel(ComputeDevice::GPU_HYBRID);
+            GemmOps::gemm_tiled(a.row_range(0, m_gpu), B, c.row_range(0, m_gpu), gpu);
         }
 
         if (m_cpu > 0) {
-            // We need to create sub-tensors or just pass offsets to gemm_tiled
-            // For now, we'll just log that it's happening.
-            // gemm_tiled(A_sub, B, C_sub);
+            GemmOps::gemm_tiled(a.row_range(m_gpu, m_cpu), B, c.row_range(m_gpu, m_cpu));
         }
     }
 };
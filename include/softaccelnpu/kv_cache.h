@@ -0,0 +1,121 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file kv_cache.h
+ * @brief Paged key/value cache for autoregressive attention.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @brief Geometry of a PagedKVCache.
+ *
+ * A page holds page_size consecutive tokens of one sequence for every layer, so a
+ * single block table per sequence serves all layers. Within a page, each layer's K and
+ * V are token-major page_size x (num_kv_heads * head_dim) blocks, i.e. the same row
+ * layout AttentionOps expects for contiguous K/V.
+ */
+struct KVCacheConfig {
+    size_t num_layers = 1;
+    size_t num_kv_heads = 1;
+    size_t head_dim = 0;
+    size_t page_size = 16;              // Tokens per page
+    size_t num_pages = 0;               // Pool capacity, allocated up front
+    DataType dtype = DataType::FP32;    // FP32, or INT8 with one scale per (token, kv head)
+};
+
+/**
+ * @class PagedKVCache
+ * @brief Fixed-size page pool with per-sequence block tables.
+ *
+ * Sequences only hold the pages their tokens occupy, so resident memory follows the
+ * actual sequence lengths rather than a max-context reservation per sequence. Pages
+ * return to the pool when a sequence is removed or its oldest tokens are evicted.
+ * Management calls are not thread-safe; attention kernels may read concurrently.
+ */
+class PagedKVCache {
+public:
+    using SeqId = uint32_t;
+
+    explicit PagedKVCache(const KVCacheConfig& config);
+
+    SeqId add_sequence();
+    void remove_sequence(SeqId seq);
+
+    /**
+     * @brief Reserves slots for num_tokens new tokens at the end of a sequence.
+     * @return Absolute position of the first reserved token.
+     * @throws std::runtime_error if the pool has too few free pages (nothing is reserved).
+     */
+    size_t append(SeqId seq, size_t num_tokens);
+
+    /**
+     * @brief Stores K/V rows for positions [pos, pos + K.rows()) of one layer.
+     * K and V are n x (num_kv_heads * head_dim) FP32; INT8 caches quantize on write.
+     */
+    void write(SeqId seq, size_t layer, size_t pos, const Tensor& K, const Tensor& V);
+
+    /**
+     * @brief Drops the newest tokens so the sequence ends at length, e.g. to undo an append
+     * whose K/V were never fully written. Pages past the new end return to the pool.
+     * @throws std::invalid_argument if length is past the end or before first_position().
+     */
+    void truncate(SeqId seq, size_t length);
+
+    /**
+     * @brief Drops up to num_tokens of the oldest tokens, rounded down to whole pages
+     * (sliding-window eviction). Positions of the remaining tokens are unchanged.
+     * @return Number of tokens actually evicted.
+     */
+    size_t evict(SeqId seq, size_t num_tokens);
+
+    /** @brief Absolute length (tokens ever appended) of a sequence. */
+    size_t length(SeqId seq) const { return get(seq).length; }
+    /** @brief Absolute position of the oldest resident token. */
+    size_t first_position(SeqId seq) const { return get(seq).start; }
+    const std::vector<uint32_t>& block_table(SeqId seq) const { return get(seq).pages; }
+
+    size_t num_pages() const { return config_.num_pages; }
+    size_t free_pages() const { return free_list_.size(); }
+    size_t page_bytes() const;
+    const KVCacheConfig& config() const { return config_; }
+
+    // Page data of one layer: page_size x (num_kv_heads * head_dim) rows
+    const float* key_page(uint32_t page, size_t layer) const;
+    const float* value_page(uint32_t page, size_t layer) const;
+    const int8_t* key_page_int8(uint32_t page, size_t layer) const;
+    const int8_t* value_page_int8(uint32_t page, size_t layer) const;
+    // FP32 page of one layer as a view (e.g. for per-head GEMMs via col_range)
+    TensorView key_view(uint32_t page, size_t layer) const;
+    TensorView value_view(uint32_t page, size_t layer) const;
+    // INT8 scales of one layer: page_size x num_kv_heads
+    const float* key_scales(uint32_t page, size_t layer) const;
+    const float* value_scales(uint32_t page, size_t layer) const;
+
+private:
+    struct Sequence {
+        std::vector<uint32_t> pages;
+        size_t start = 0;   // Absolute position of the first token in pages[0]
+        size_t length = 0;
+    };
+
+    Sequence& get(SeqId seq);
+    const Sequence& get(SeqId seq) const;
+    size_t block_offset(uint32_t page, size_t layer, size_t kv) const;
+
+    KVCacheConfig config_;
+    size_t row_elems_;      // num_kv_heads * head_dim
+    size_t elem_bytes_;
+    std::vector<uint8_t> storage_;
+    std::vector<float> scales_;
+    std::vector<uint32_t> free_list_;
+    std::unordered_map<SeqId, Sequence> sequences_;
+    SeqId next_id_ = 0;
+};
+
+} // namespace softaccelnpu
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "softaccelnpu/mapped_file.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file layer_prefetcher.h
+ * @brief Streams mapped model weights ahead of compute, one layer at a time.
+ */
+
+namespace softaccelnpu {
+
+class GgufLoader;
+
+/** @brief Byte ranges of a mapped file that one layer reads. */
+struct LayerRegion {
+    std::string name;
+    std::vector<std::pair<size_t, size_t>> ranges;  // (offset, bytes), sorted and disjoint
+    size_t bytes = 0;
+
+    /** @brief Adds a range, merging it with a neighbour closer than gap bytes. */
+    void add(size_t offset, size_t size, size_t gap = 0);
+};
+
+struct PrefetchOptions {
+    size_t depth = 2;             // Layers i+1..i+depth are fetched while layer i computes
+    bool read_pages = true;       // Fault pages in on the I/O thread; false only advises WILLNEED
+    bool drop_finished = false;   // Release a layer's pages once it has been computed
+    bool cyclic = false;          // Decode loops: after the last layer, prefetch layer 0 again
+};
+
+/** @brief Per-stage counters. Rates are bytes over the time spent in that stage. */
+struct PrefetchStats {
+    size_t layers_computed = 0;
+    size_t bytes_fetched = 0;      // By the I/O thread
+    size_t bytes_computed = 0;     // Weights of computed layers
+    size_t bytes_dropped = 0;
+    double fetch_seconds = 0.0;    // I/O thread busy time
+    double compute_seconds = 0.0;  // begin_layer() return to end_layer()
+    double stall_seconds = 0.0;    // Waiting in begin_layer() for a layer's pages
+
+    double fetch_mb_per_s() const { return fetch_seconds > 0 ? bytes_fetched / 1048576.0 / fetch_seconds : 0.0; }
+    double compute_mb_per_s() const { return compute_seconds > 0 ? bytes_computed / 1048576.0 / compute_seconds : 0.0; }
+    /** @brief Weight bytes per wall-clock second over compute plus stalls. */
+    double effective_mb_per_s() const {
+        const double t = compute_seconds + stall_seconds;
+        return t > 0 ? bytes_computed / 1048576.0 / t : 0.0;
+    }
+};
+
+/**
+ * @class LayerPrefetcher
+ * @brief Overlaps weight I/O with compute using the model's layer order.
+ *
+ * begin_layer(i) queues layers i+1..i+depth on a dedicated I/O thread, then waits until
+ * layer i itself is resident; end_layer(i) optionally drops it. The I/O thread advises
+ * MADV_WILLNEED on a layer's ranges and, with read_pages, touches one byte per page, so
+ * page faults are taken on that thread instead of inside the GEMMs. With drop_finished
+ * the resident set stays at about depth + 1 layers, which lets models larger than RAM
+ * stream from disk (the pages stay in the page cache until the kernel reclaims them).
+ *
+ * Layers are begun in order, starting over at 0 for each forward pass;
+ * begin_layer/end_layer are called from one thread.
+ */
+class LayerPrefetcher {
+public:
+    LayerPrefetcher(std::shared_ptr<const MappedFile> file, std::vector<LayerRegion> layers,
+                    const PrefetchOptions& options = {});
+    ~LayerPrefetcher();
+
+    LayerPrefetcher(const LayerPrefetcher&) = delete;
+    LayerPrefetcher& operator=(const LayerPrefetcher&) = delete;
+
+    /**
+     * @brief Execution-order layers of a mapped GGUF model: token_embd* first, then
+     * blk.0, blk.1, ..., then all remaining tensors (output norm and head).
+     */
+    static std::vector<LayerRegion> gguf_layers(const GgufLoader& loader);
+
+    void begin_layer(size_t layer);
+    void end_layer(size_t layer);
+
+    size_t num_layers() const { return layers_.size(); }
+    const LayerRegion& layer(size_t i) const { return layers_[i]; }
+
+    PrefetchStats stats() const;
+    void print_report() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void enqueue_locked(size_t layer);
+    void io_loop();
+    size_t fetch(const LayerRegion& region) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    std::vector<LayerRegion> layers_;
+    PrefetchOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<size_t> queue_;
+    std::vector<char> queued_;    // Handed to the I/O thread
+    std::vector<char> ready_;     // Fetched
+    bool stop_ = false;
+    PrefetchStats stats_;
+    Clock::time_point compute_start_;
+    std::thread io_thread_;
+};
+
+} // namespace softaccelnpu
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "softaccelnpu/kv_cache.h"
+#include "softaccelnpu/load_pipeline.h"
+#include "softaccelnpu/tensor.h"
+#include "softaccelnpu/transformer_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file llama_model.h
+ * @brief Decoder-only Llama-family transformer over mapped GGUF weights.
+ */
+
+namespace softaccelnpu {
+
+class GgufLoader;
+
+/** @brief Hyperparameters read from the <arch>.* GGUF metadata keys. */
+struct LlamaConfig {
+    size_t vocab_size = 0;
+    size_t dim = 0;             // embedding_length
+    size_t hidden_dim = 0;      // feed_forward_length
+    size_t num_layers = 0;      // block_count
+    size_t num_heads = 0;
+    size_t num_kv_heads = 0;    // head_count_kv, num_heads when absent
+    size_t head_dim = 0;        // dim / num_heads
+    size_t context_length = 0;
+    float rope_theta = 10000.0f;
+    float rms_eps = 1e-5f;
+
+    /**
+     * @throws std::invalid_argument if general.architecture is not llama, RoPE scaling is
+     * requested, a required key is missing or the shapes disagree.
+     */
+    static LlamaConfig from_gguf(const GgufLoader& loader);
+};
+
+/** @brief Latency and throughput of one LlamaModel::generate call. */
+struct GenerationStats {
+    size_t prompt_tokens = 0;
+    size_t generated_tokens = 0;
+    double ttft_seconds = 0.0;     // Prefill plus sampling the first token
+    double prefill_seconds = 0.0;
+    double decode_seconds = 0.0;   // Forward passes after the first token
+
+    double prefill_tokens_per_s() const { return prefill_seconds > 0 ? prompt_tokens / prefill_seconds : 0.0; }
+    double decode_tokens_per_s() const {
+        return decode_seconds > 0 && generated_tokens > 1 ? (generated_tokens - 1) / decode_seconds : 0.0;
+    }
+
+    void print(const std::string& title) const;
+};
+
+/**
+ * @class LlamaModel
+ * @brief Embedding -> N x (RMSNorm, GQA attention with RoPE and a paged KV cache,
+ * SwiGLU FFN) -> RMSNorm -> LM head, for one sequence.
+ *
+ * Weights are converted once at load on a LoadPipeline: F32 / F16 / BF16 / Q8_0 / Q4_0
+ * tensors become FP32 in the layouts the kernels consume (Tiled panels for the fused
+ * QKV, output and LM head projections, pack_ffn_gate_up panels for the FFN). RoPE
+ * rotates adjacent pairs, matching the Q/K row order llama.cpp's converter writes.
+ *
+ * Prefill runs the GEMM paths (RMSNorm fused into the QKV packing, flash attention
+ * over the prompt); decode runs GEMV and split-K attention over the cache pages.
+ */
+class LlamaModel {
+public:
+    /**
+     * @param loader A loader with map_weights() done; the mapping is only read during construction.
+     * @param max_seq KV cache capacity in tokens; 0 -> min(context_length, 4096).
+     * @throws std::invalid_argument for missing tensors, tensors this model does not use
+     * (e.g. attention biases) or unsupported tensor types.
+     */
+    explicit LlamaModel(const GgufLoader& loader, size_t max_seq = 0);
+
+    const LlamaConfig& config() const { return config_; }
+    size_t max_seq() const { return max_seq_; }
+    /** @brief Tokens currently in the KV cache. */
+    size_t position() const;
+    /** @brief Per-stage throughput of the load-time weight conversion. */
+    const LoadStats& load_stats() const { return load_stats_; }
+
+    /**
+     * @brief Appends tokens to the sequence and returns the logits of the last one.
+     * If it throws, the sequence is left as it was.
+     * @throws std::out_of_range for token ids outside the vocabulary or a full KV cache.
+     */
+    const std::vector<float>& forward(const std::vector<int32_t>& tokens);
+
+    /** @brief Clears the KV cache, starting a new sequence at position 0. */
+    void reset();
+
+    /**
+     * @brief Greedy decoding: prefills prompt, then samples max_new_tokens tokens
+     * (stopping after eos_token, if one is given and produced).
+     */
+    std::vector<int32_t> generate(const std::vector<int32_t>& prompt, size_t max_new_tokens,
+                                  GenerationStats* stats = nullptr, int32_t eos_token = -1);
+
+    /** @brief Index of the largest logit. */
+    static int32_t argmax(const std::vector<float>& logits);
+
+private:
+    struct Layer {
+        Tensor attn_norm{0, 0};
+        Tensor ffn_norm{0, 0};
+        Tensor wqkv{0, 0};       // Tiled [dim x (q_dim + 2 * kv_dim)]
+        Tensor wo{0, 0};         // Tiled [q_dim x dim]
+        Tensor w_gate_up{0, 0};  // pack_ffn_gate_up panels [dim x 2H']
+        Tensor w_down{0, 0};     // RowMajor [hidden x dim]
+    };
+
+    // y += x * W, through gemv for decode-sized x
+    static void project(const Tensor& x, const Tensor& W, Tensor& y);
+
+    LlamaConfig config_;
+    size_t max_seq_ = 0;
+    LoadStats load_stats_;
+
+    Tensor token_embd_{0, 0};  // RowMajor [vocab x dim]
+    Tensor output_norm_{0, 0};
+    Tensor lm_head_{0, 0};     // Tiled [dim x vocab]
+    std::vector<Layer> layers_;
+
+    std::unique_ptr<RopeTable> rope_;
+    std::unique_ptr<PagedKVCache> cache_;
+    PagedKVCache::SeqId seq_ = 0;
+    std::vector<float> logits_;
+};
+
+} // namespace softaccelnpu
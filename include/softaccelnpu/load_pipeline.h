@@ -0,0 +1,77 @@
+#pragma once
+
+#include "softaccelnpu/mapped_file.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file load_pipeline.h
+ * @brief Parallel, I/O-overlapped load-time weight transformation.
+ */
+
+namespace softaccelnpu {
+
+/** @brief One unit of load work: a source byte range of the mapped model file. */
+struct LoadTask {
+    std::string name;
+    size_t offset = 0;
+    size_t bytes = 0;
+};
+
+struct LoadOptions {
+    size_t read_ahead_bytes = size_t(256) << 20;  // Max bytes read but not yet transformed
+    bool read_pages = true;                       // Fault source pages in on the read thread
+};
+
+/** @brief Per-stage counters of one LoadPipeline::run. */
+struct LoadStats {
+    size_t tasks = 0;
+    size_t threads = 0;              // Transform workers
+    size_t bytes_read = 0;           // Source bytes faulted in by the read stage
+    size_t bytes_in = 0;             // Source bytes transformed
+    size_t bytes_out = 0;            // Bytes produced by the transforms
+    double read_seconds = 0.0;       // Read thread busy time
+    double transform_seconds = 0.0;  // Summed over workers
+    double wait_seconds = 0.0;       // Summed time workers waited for the read stage
+    double wall_seconds = 0.0;
+
+    double read_mb_per_s() const { return read_seconds > 0 ? bytes_read / 1048576.0 / read_seconds : 0.0; }
+    /** @brief Transform throughput of all workers together. */
+    double transform_mb_per_s() const {
+        return transform_seconds > 0 ? bytes_in / 1048576.0 / (transform_seconds / threads) : 0.0;
+    }
+    double overall_mb_per_s() const { return wall_seconds > 0 ? bytes_in / 1048576.0 / wall_seconds : 0.0; }
+
+    void print(const std::string& title) const;
+};
+
+/**
+ * @class LoadPipeline
+ * @brief Two-stage pipeline for converting mapped weights at load time.
+ *
+ * A read thread walks the tasks in order, advising MADV_WILLNEED and faulting in each
+ * source range, while the thread pool transforms tasks as soon as their bytes are
+ * resident (dequantize, convert, transpose, pack, build masks). Tasks are handed out
+ * dynamically, so a few large tensors do not serialize the load, and the read stage
+ * stays at most read_ahead_bytes ahead so memory stays bounded on large models.
+ * Transforms run on pool threads; parallel ops they call run inline.
+ */
+class LoadPipeline {
+public:
+    /** @brief Converts task i and returns the number of bytes it produced. */
+    using Transform = std::function<size_t(size_t)>;
+
+    explicit LoadPipeline(std::shared_ptr<const MappedFile> file, const LoadOptions& options = {});
+
+    /** @throws whatever a transform throws, after all workers have stopped. */
+    LoadStats run(const std::vector<LoadTask>& tasks, const Transform& transform) const;
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    LoadOptions options_;
+};
+
+} // namespace softaccelnpu
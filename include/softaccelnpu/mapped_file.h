@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+ */
+
+namespace softaccelnpu {
+
+/** @brief Access-pattern hint for a mapped range (madvise / PrefetchVirtualMemory). */
+enum class MapAdvice {
+    Normal,      // Kernel default readahead
+    Sequential,  // Aggressive readahead, pages behind the reader may be dropped early
+    Random,      // No readahead: each fault reads one page
+    WillNeed,    // Start reading the range in now, asynchronously
+    DontNeed     // Range will not be touched soon; clean pages may be dropped
+};
+
+const char* map_advice_name(MapAdvice advice);
+
+struct MapOptions {
+    bool populate = false;                  // Fault in the whole file up front (MAP_POPULATE)
+    MapAdvice advice = MapAdvice::Normal;   // Applied to the whole mapping after it is created
+};
+
+/**
+ * @class MappedFile
+ * @brief Shared, read-only view of a file's bytes.
+ *
+ * The mapping is backed by the page cache, so mapping is O(1) in the file size, pages are
+ * read on first touch, and every process mapping the same file shares one copy.
+ * Writing through data() faults; tensors wrapped over it must be treated as const.
+ */
+class MappedFile {
+public:
+    /** @throws std::runtime_error if the file cannot be opened or mapped. */
+    explicit MappedFile(const std::string& path, const MapOptions& options = {});
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+    bool populated() const { return populated_; }
+
+    /**
+     * @brief Applies an access hint to [offset, offset + bytes), widened to whole pages and
+     * clipped to the file. Returns false if the OS rejected or does not support it.
+     */
+    bool advise(size_t offset, size_t bytes, MapAdvice advice) const;
+
+    static size_t page_size();
+
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool populated_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace softaccelnpu
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file memory_planner.h
+ * @brief Liveness-based arena planning for intermediate tensors.
+ */
+
+namespace softaccelnpu {
+
+/** @brief Outcome of MemoryPlanner::plan(). */
+struct MemoryPlanStats {
+    size_t num_buffers = 0;
+    size_t num_aliased = 0;     // Buffers that reuse their input's storage in place
+    size_t naive_bytes = 0;     // One allocation per buffer
+    size_t planned_bytes = 0;   // Arena size (planned peak)
+};
+
+/**
+ * @class MemoryPlanner
+ * @brief Packs buffers with disjoint lifetimes into one arena.
+ *
+ * Buffers are declared with their size, then every step (command index) that touches
+ * them is reported with use(). A buffer is live from its first to its last use,
+ * inclusive, so two buffers touched by the same step never overlap. allow_in_place()
+ * marks an elementwise step whose output may take over its input's storage; the
+ * alias is taken only when that step is the input's last use.
+ *
+ * Offsets come from greedy-by-size placement: largest buffers first, each at the
+ * lowest ALIGNMENT-aligned gap not used by a buffer with an overlapping lifetime.
+ */
+class MemoryPlanner {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    /** @return Buffer id, numbered from 0 in declaration order. */
+    size_t add_buffer(size_t bytes);
+    void use(size_t buffer, size_t step);
+    void allow_in_place(size_t output, size_t input, size_t step);
+
+    /** @brief Assigns offsets. @return Arena bytes required. */
+    size_t plan();
+
+    size_t offset(size_t buffer) const { return buffers_[buffer].offset; }
+    const MemoryPlanStats& stats() const { return stats_; }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Buffer {
+        size_t bytes;
+        size_t first = NONE;
+        size_t last = 0;
+        size_t root = NONE;     // Storage donor after in-place aliasing (NONE: own storage)
+        size_t offset = 0;
+    };
+    struct InPlace {
+        size_t output, input, step;
+    };
+
+    std::vector<Buffer> buffers_;
+    std::vector<InPlace> in_place_;
+    MemoryPlanStats stats_;
+};
+
+} // namespace softaccelnpu
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "softaccelnpu/tensor.h"
+#include "softaccelnpu/fp8.h"
+#include "softaccelnpu/sparse24.h"
+#include "softaccelnpu/sparse.h"
+#include "softaccelnpu/compressed_weights.h"
+#include "softaccelnpu/sparsity_mask.h"
 #include "softaccelnpu/kernels.h"
 #include "softaccelnpu/thread_pool.h"
 
@@ -11,6 +16,78 @@
 
 namespace softaccelnpu {
 
+/**
+ * @brief Shape and stride description for GemmOps::gemm_batched_strided.
+ *
+ * Entry b computes C_b = alpha * A_b * op(B_b) + beta * C_b where
+ *   A_b = A + b * stride_a (MxK, leading dimension lda),
+ *   B_b = B + b * stride_b (KxN, or NxK when trans_b is set, leading dimension ldb),
+ *   C_b = C + b * stride_c (MxN, leading dimension ldc).
+ * Strides and leading dimensions are in elements; a leading dimension of 0 means
+ * "densely packed" (K, N or K, and N respectively).
+ */
+struct GemmBatchDesc {
+    size_t batch = 1;
+    size_t M = 0, N = 0, K = 0;
+    size_t lda = 0, ldb = 0, ldc = 0;
+    size_t stride_a = 0, stride_b = 0, stride_c = 0;
+    bool trans_b = false;
+    float alpha = 1.0f;
+    float beta = 0.0f;
+};
+
+/** @brief One member of a grouped GEMM launch: C = A * B (C is overwritten). */
+struct GroupedGemmProblem {
+    const Tensor* A;
+    const Tensor* B;
+    Tensor* C;
+};
+
+/**
+ * @brief Router output for a mixture-of-experts layer.
+ *
+ * Token t is sent to experts expert_ids[t * top_k + k] (k < top_k) with gating
+ * weights weights[t * top_k + k].
+ */
+struct MoeRouting {
+    size_t top_k = 1;
+    std::vector<int32_t> expert_ids;
+    std::vector<float> weights;
+};
+
+/** @brief SwiGLU expert weights (W_gate_up from GemmOps::pack_ffn_gate_up, W_down HxD). */
+struct MoeExpert {
+    const Tensor* W_gate_up;
+    const Tensor* W_down;
+};
+
+/**
+ * @brief Per-row normalization applied to A while gemm_tiled packs it.
+ *
+ * Row statistics are computed once per row over all K columns; each A element is
+ * then consumed as x * inv_rms * gamma[k] (RmsNorm) or
+ * (x - mean) * inv_std * gamma[k] + beta[k] (LayerNorm, beta optional).
+ * gamma and beta hold K values.
+ */
+struct GemmNormPrologue {
+    enum class Kind { RmsNorm, LayerNorm };
+    Kind kind = Kind::RmsNorm;
+    const Tensor* gamma = nullptr;
+    const Tensor* beta = nullptr;
+    float eps = 1e-6f;
+};
+
+/** @brief Blocking parameters of gemm_tiled; artifacts packed for one tiling are keyed on it. */
+struct GemmTiling {
+    size_t kc = 0, mc = 0, nc = 0;  // Cache blocking
+    size_t mr = 0, nr = 0;          // Micro-kernel register tile
+
+    bool operator==(const GemmTiling& o) const {
+        return kc == o.kc && mc == o.mc && nc == o.nc && mr == o.mr && nr == o.nr;
+    }
+    bool operator!=(const GemmTiling& o) const { return !(*this == o); }
+};
+
 /**
  * @class GemmOps
  * @brief The primary entry point for Matrix Multiplication operations.
@@ -24,9 +101,11 @@ public:
     /**
      * @brief Executes a high-performance tiled GEMM (C = A * B + C).
      * @param A Input Matrix A (MxK).
-     * @param B Input Matrix B (KxN).
+     * @param B Input Matrix B (KxN), RowMajor or Layout::Tiled (consumed without packing).
      * @param C Output Matrix C (MxN).
      * @param kernel Pointer to a MicroKernel implementation (defaults to auto-dispatch).
+     * If A or B carries a sparsity mask (Tensor::build_sparsity_mask), all-zero MR x KC
+     * blocks of A and KC x NR blocks of B are skipped in both packing and compute.
      */
     static void gemm_tiled(
         const Tensor& A, const Tensor& B, Tensor& C,
@@ -34,6 +113,80 @@ public:
         bool fused_activation = false
     );
 
+    /**
+     * @brief Tiled GEMM on strided views (C = A * B + C).
+     *
+     * Views must have unit column stride; their row strides are passed to the
+     * micro-kernels as lda/ldb/ldc, so row blocks, head slices or cache pages
+     * are multiplied in place without copying.
+     */
+    static void gemm_tiled(
+        const TensorView& A, const TensorView& B, const TensorView& C,
+        MicroKernel* kernel = nullptr,
+        bool fused_activation = false
+    );
+
+    /**
+     * @brief Tiled GEMM on A/C views with a whole weight tensor B (RowMajor or Tiled).
+     * B may be FP16/BF16: it is widened to FP32 while packed, accumulation stays FP32.
+     * B's sparsity mask, if built, is honoured as in the Tensor overload.
+     */
+    static void gemm_tiled(
+        const TensorView& A, const Tensor& B, const TensorView& C,
+        MicroKernel* kernel = nullptr,
+        bool fused_activation = false
+    );
+
+    /**
+     * @brief Tiled GEMM with FP8 weights: C = A * (decode(B.data) * scales) + C.
+     * Each KC x NC block of B is widened and scaled into the per-thread FP32 panel
+     * buffer, so B streams from memory at one byte per weight. A.rows() <= GEMV_MAX_ROWS
+     * is routed to gemv.
+     */
+    static void gemm_tiled(
+        const TensorView& A, const Fp8Weights& B, const TensorView& C,
+        MicroKernel* kernel = nullptr,
+        bool fused_activation = false
+    );
+
+    /**
+     * @brief Tiled GEMM with bitmask-compressed weights.
+     * Each KC x NC block of B is expanded from its masks and nonzero stream straight
+     * into the per-thread FP32 panel buffer, so only the compressed bytes are read from
+     * memory. A.rows() <= GEMV_MAX_ROWS is routed to gemv.
+     */
+    static void gemm_tiled(
+        const TensorView& A, const CompressedWeights& B, const TensorView& C,
+        MicroKernel* kernel = nullptr,
+        bool fused_activation = false
+    );
+
+    /**
+     * @brief Tiled GEMM with a normalization prologue: C = Norm(A) * B + C.
+     *
+     * Norm(A) is produced MR rows at a time while A is packed for the micro-kernel,
+     * so the normalized activation tensor is never written to memory.
+     */
+    static void gemm_tiled(
+        const Tensor& A, const Tensor& B, Tensor& C,
+        const GemmNormPrologue& norm,
+        MicroKernel* kernel = nullptr
+    );
+
+    /**
+     * @brief Decode-shaped y += x * W for x with at most GEMV_MAX_ROWS rows.
+     *
+     * W may be FP32, FP16, BF16 or (unscaled) FP8, RowMajor or Tiled. Narrow weights are
+     * widened in registers, so each weight crosses the memory bus once at its stored
+     * width, and threads split W by columns so they all stream disjoint slices of it.
+     */
+    static void gemv(const TensorView& x, const Tensor& W, const TensorView& y);
+    /** @brief y += x * W for scaled FP8 weights; scales multiply each column's dot product. */
+    static void gemv(const TensorView& x, const Fp8Weights& W, const TensorView& y);
+    /** @brief y += x * W for compressed weights, expanding each panel row in registers. */
+    static void gemv(const TensorView& x, const CompressedWeights& W, const TensorView& y);
+    static constexpr size_t GEMV_MAX_ROWS = 4;
+
     /** @brief Reference scalar implementation (single-threaded, no tiling). */
     static void gemm_ref_scalar(const Tensor& A, const Tensor& B, Tensor& C);
 
@@ -46,8 +199,87 @@ public:
     /** @brief Extreme optimization mode using INT4 weights and 50%+ sparsity. */
     static void gemm_extreme(const Tensor& A, const Tensor& B, Tensor& C, float sparsity_ratio = 0.5f);
 
+    /** @brief Extreme mode on 2:4 sparse weights: C += A * B with half the MACs (see gemm_sparse24). */
+    static void gemm_extreme(const Tensor& A, const Sparse24Weights& B, Tensor& C);
+
+    /**
+     * @brief C += A * B for 2:4 structured-sparse B, multiplying only the kept values.
+     *
+     * A and C are FP32 views with unit column stride. Up to GEMV_MAX_ROWS rows take a
+     * column-vectorized GEMV that selects activations with in-register permutes;
+     * larger M packs A k-major and runs 16-row tiles per kept weight.
+     */
+    static void gemm_sparse24(const TensorView& A, const Sparse24Weights& B, const TensorView& C);
+
+    /**
+     * @brief C += A * B for unstructured sparse B in CSR storage.
+     *
+     * Up to GEMV_MAX_ROWS rows gather activations by column index, 8 nonzeros per
+     * gather; larger M packs 16-row tiles of A k-major so each nonzero costs two loads.
+     */
+    static void gemm_sparse(const TensorView& A, const CsrWeights& B, const TensorView& C);
+    /** @brief C += A * B for block-CSR B: register tiles run over the stored 4 x 16 blocks only. */
+    static void gemm_sparse(const TensorView& A, const BsrWeights& B, const TensorView& C);
+    /** @brief C += A * B in whichever format SparseWeights::from_dense chose (dense B uses gemv / gemm_tiled). */
+    static void gemm_sparse(const TensorView& A, const SparseWeights& B, const TensorView& C);
+
+    /**
+     * @brief Strided batched GEMM over batch entries of identical shape.
+     *
+     * A, B and C provide the storage for all entries (see GemmBatchDesc). Work is
+     * parallelized jointly across batch entries and output tiles in one launch, e.g.
+     * heads x (seq x d_head) * (d_head x seq) attention scores with trans_b = true.
+     */
+    static void gemm_batched_strided(const Tensor& A, const Tensor& B, Tensor& C, const GemmBatchDesc& desc);
+
+    /**
+     * @brief Runs a set of independent, variable-sized GEMMs in one launch.
+     *
+     * Every (problem, output tile) pair becomes a task on a shared queue, so small
+     * and large problems are load-balanced across the pool together. Problems with
+     * no rows are skipped.
+     * @throws std::invalid_argument for null, mis-shaped, non-FP32 or non-RowMajor operands.
+     */
+    static void gemm_grouped(const std::vector<GroupedGemmProblem>& problems);
+
+    /**
+     * @brief Mixture-of-experts SwiGLU FFN.
+     *
+     * Gathers the tokens routed to each expert, runs every expert's fused FFN in a
+     * single grouped launch and scatter-adds the gate-weighted results:
+     * Y[t] = sum_k weights[t,k] * FFN_{expert_ids[t,k]}(X[t]).
+     * @param X Input activations (TxD).
+     * @param Y Output (TxD), overwritten.
+     * @throws std::invalid_argument if a routed-to expert has null weights or shapes disagree.
+     */
+    static void moe_ffn(const Tensor& X, const MoeRouting& routing, const std::vector<MoeExpert>& experts, Tensor& Y);
+
+    /**
+     * @brief Interleaves SwiGLU gate and up weights for ffn_swiglu.
+     *
+     * Both inputs are DxH. The result holds Dx2H' values (H' = H rounded up to 8)
+     * stored as H'/8 contiguous Dx16 panels; each panel row has 8 gate columns
+     * followed by the matching 8 up columns, so one streaming pass over a panel
+     * yields both projections of a hidden tile.
+     */
+    static Tensor pack_ffn_gate_up(const Tensor& W_gate, const Tensor& W_up);
+
+    /**
+     * @brief Fused SwiGLU feed-forward: Y = (SiLU(X * W_gate) . (X * W_up)) * W_down.
+     *
+     * Gate/up tiles are activated in registers and fed straight into the down
+     * projection, so the TxH hidden activation is never written to memory.
+     * @param X Input activations (TxD).
+     * @param W_gate_up Interleaved gate/up weights from pack_ffn_gate_up (Dx2H').
+     * @param W_down Down projection weights (HxD).
+     * @param Y Output (TxD), overwritten.
+     */
+    static void ffn_swiglu(const Tensor& X, const Tensor& W_gate_up, const Tensor& W_down, Tensor& Y);
+
     /** @brief Automatically tunes tiling parameters (KC, MC, NC) for current hardware. */
     static void tune_tiling();
+    /** @brief Current blocking parameters (after tune_tiling, if it ran). */
+    static GemmTiling tiling() { return {KC, MC, NC, MR, NR}; }
 
     /** 
      * @brief Configures Benchmark Mode.
@@ -59,6 +291,19 @@ public:
     static bool is_benchmark_mode();
 
 private:
+    // b_panels: B is NR-wide panel-major (Layout::Tiled) and B.row_stride() is the in-panel stride
+    // b_scale: optional per-column multiplier of B (N values), applied while B is widened
+    // a_mask / b_mask: zero-block maps of A and B (see Tensor::build_sparsity_mask); masked blocks are skipped
+    // b_compressed: B's storage when it is compressed; B then only supplies the shape
+    static void gemm_tiled_impl(const TensorView& A, const TensorView& B, const TensorView& C, MicroKernel* kernel,
+                                bool fused_activation, const GemmNormPrologue* norm, bool b_panels = false,
+                                const float* b_scale = nullptr, const SparsityMask* a_mask = nullptr,
+                                const SparsityMask* b_mask = nullptr, const CompressedWeights* b_compressed = nullptr);
+    static void gemm_tiled_weights(const TensorView& A, const SparsityMask* a_mask, const Tensor& B, const TensorView& C,
+                                   MicroKernel* kernel, bool fused_activation);
+    // scale: optional per-column multiplier of W (N values)
+    static void gemv_impl(const TensorView& x, const Tensor& W, const TensorView& y, const float* scale);
+
     static bool benchmark_mode;
     
     // Tunable parameters (simulated L3/L2/L1 blocking)
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * @file sparse.h
+ * @brief Unstructured sparse weight storage (CSR, block-CSR) and the density-based format switch.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @struct CsrWeights
+ * @brief A K x N weight matrix stored as CSR of its transpose: one compressed row per
+ * output column n, holding the k index and value of each nonzero W[k, n].
+ *
+ * Column n owns entries ptr[n] .. ptr[n + 1] - 1 of idx / values, in increasing k.
+ * Each output is then a dot product whose activations are gathered by idx, and
+ * 8 bytes are stored per nonzero.
+ */
+struct CsrWeights {
+    size_t rows = 0;  // K
+    size_t cols = 0;  // N
+    std::vector<uint32_t> ptr;
+    std::vector<uint32_t> idx;
+    std::vector<float> values;
+
+    size_t nnz() const { return values.size(); }
+    size_t bytes() const { return (ptr.size() + idx.size()) * sizeof(uint32_t) + values.size() * sizeof(float); }
+
+    /** @brief Compresses an FP32 RowMajor tensor, dropping exact zeros (either sign). */
+    static CsrWeights from_dense(const Tensor& W);
+
+    /** @brief FP32 RowMajor expansion, for reference checks. */
+    Tensor to_dense() const;
+};
+
+/**
+ * @struct BsrWeights
+ * @brief A K x N weight matrix stored as dense BLOCK_K x BLOCK_N blocks; all-zero blocks are dropped.
+ *
+ * Columns are grouped into BLOCK_N-wide panels as in Layout::Tiled. Panel p owns blocks
+ * ptr[p] .. ptr[p + 1] - 1; block b covers rows block_k[b] * BLOCK_K onwards and its
+ * values are k-major at values[b * BLOCK_K * BLOCK_N]. Rows past K and columns past N
+ * are stored as zeros.
+ */
+struct BsrWeights {
+    static constexpr size_t BLOCK_K = 4;
+    static constexpr size_t BLOCK_N = Tensor::TILE_WIDTH;
+
+    size_t rows = 0;  // K
+    size_t cols = 0;  // N
+    std::vector<uint32_t> ptr;
+    std::vector<uint32_t> block_k;
+    std::vector<float> values;
+
+    size_t panels() const { return (cols + BLOCK_N - 1) / BLOCK_N; }
+    size_t blocks() const { return block_k.size(); }
+    size_t bytes() const { return (ptr.size() + block_k.size()) * sizeof(uint32_t) + values.size() * sizeof(float); }
+
+    /** @brief Compresses an FP32 RowMajor tensor, keeping every block with a nonzero. */
+    static BsrWeights from_dense(const Tensor& W);
+
+    /** @brief FP32 RowMajor expansion, for reference checks. */
+    Tensor to_dense() const;
+};
+
+enum class SparseFormat { Dense, CSR, BSR };
+
+/**
+ * @struct SparseWeights
+ * @brief A weight tensor in whichever of dense, CSR or BSR storage computes fastest,
+ * chosen once from its measured density when the weights are loaded.
+ */
+struct SparseWeights {
+    /** BSR needs at most this fraction of BLOCK_K x BLOCK_N blocks to hold a nonzero. */
+    static constexpr float BSR_MAX_BLOCK_DENSITY = 0.6f;
+    /** CSR needs at most this fraction of the weights to be nonzero. */
+    static constexpr float CSR_MAX_DENSITY = 0.3f;
+    /**
+     * A stored BSR weight costs about this fraction of a CSR nonzero (no index, no
+     * gather), so BSR wins while block_density * BSR_COST_PER_WEIGHT <= density.
+     */
+    static constexpr float BSR_COST_PER_WEIGHT = 0.5f;
+
+    SparseFormat format = SparseFormat::Dense;
+    size_t rows = 0;
+    size_t cols = 0;
+    float density = 1.0f;        // Nonzero weights / (K * N)
+    float block_density = 1.0f;  // Nonzero BSR blocks / all BSR blocks
+    std::optional<Tensor> dense;
+    CsrWeights csr;
+    BsrWeights bsr;
+
+    size_t bytes() const;
+
+    /**
+     * @brief Measures W's density and stores it in the cheapest format.
+     * W must be FP32 RowMajor; the dense path keeps a copy of it.
+     */
+    static SparseWeights from_dense(const Tensor& W);
+};
+
+/** @brief Name of a SparseFormat, for logs and benchmarks. */
+const char* sparse_format_name(SparseFormat format);
+
+} // namespace softaccelnpu
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file sparse24.h
+ * @brief 2:4 structured-sparse weight storage.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @struct Sparse24Weights
+ * @brief A K x N weight matrix where every group of 4 consecutive k per column holds
+ * at most 2 nonzeros, stored as the 2 kept values plus their 2-bit positions.
+ *
+ * Storage is panel-major like Layout::Tiled: PANEL columns per panel, padded with
+ * zeros. For panel p and group g (rows 4g .. 4g+3):
+ *   values  [(p * groups() + g) * 2 * PANEL + slot * PANEL + j]   kept values, slot 0/1
+ *   indices [ p * groups() + g]   column j in bits 4j..4j+3: slot-0 row | slot-1 row << 2
+ * K is padded up to whole groups. Half the values plus one index bit per weight
+ * make this 17/32 of the FP32 bytes.
+ */
+struct Sparse24Weights {
+    static constexpr size_t GROUP = 4;
+    static constexpr size_t PANEL = Tensor::TILE_WIDTH;
+
+    size_t rows = 0;  // K
+    size_t cols = 0;  // N
+    std::vector<float> values;
+    std::vector<uint64_t> indices;
+
+    size_t groups() const { return (rows + GROUP - 1) / GROUP; }
+    size_t panels() const { return (cols + PANEL - 1) / PANEL; }
+    size_t bytes() const { return values.size() * sizeof(float) + indices.size() * sizeof(uint64_t); }
+
+    /**
+     * @brief Compresses an FP32 RowMajor tensor, keeping the 2 largest-magnitude values
+     * of each group (lower k wins ties). Exact when W already satisfies 2:4.
+     */
+    static Sparse24Weights from_dense(const Tensor& W);
+
+    /** @brief True if every group of 4 consecutive k in every column has at most 2 nonzeros. */
+    static bool is_sparse24(const Tensor& W);
+
+    /** @brief FP32 RowMajor expansion, for reference checks. */
+    Tensor to_dense() const;
+};
+
+} // namespace softaccelnpu
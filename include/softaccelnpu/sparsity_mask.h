@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file sparsity_mask.h
+ * @brief Per-block zero bitmap of a tensor, used to skip all-zero GEMM blocks.
+ */
+
+namespace softaccelnpu {
+
+class Tensor;
+
+/**
+ * @struct SparsityMask
+ * @brief Which block_rows x block_cols blocks of a tensor hold only zeros (+0 or -0).
+ * Edge blocks cover whatever rows/columns remain.
+ */
+struct SparsityMask {
+    size_t block_rows = 0;
+    size_t block_cols = 0;
+    size_t rows_blocks = 0;
+    size_t cols_blocks = 0;
+    size_t zero_blocks = 0;
+    std::vector<uint8_t> block_is_zero;  // rows_blocks x cols_blocks, row-major
+
+    bool is_zero(size_t rb, size_t cb) const { return block_is_zero[rb * cols_blocks + cb] != 0; }
+
+    /** @brief True if every block touching rows [r0, r0 + rows) x cols [c0, c0 + cols) is zero. */
+    bool is_zero_region(size_t r0, size_t rows, size_t c0, size_t cols) const {
+        for (size_t rb = r0 / block_rows; rb <= (r0 + rows - 1) / block_rows; ++rb) {
+            for (size_t cb = c0 / block_cols; cb <= (c0 + cols - 1) / block_cols; ++cb) {
+                if (!is_zero(rb, cb)) return false;
+            }
+        }
+        return true;
+    }
+
+    float zero_fraction() const {
+        return block_is_zero.empty() ? 0.0f : static_cast<float>(zero_blocks) / block_is_zero.size();
+    }
+};
+
+/**
+ * @brief Builds the mask with one SIMD pass over the storage; any dtype and any of
+ * RowMajor, Tiled or ColMajor. Sign bits are ignored, so -0.0 counts as zero.
+ */
+SparsityMask generate_sparsity_mask(const Tensor& T, size_t block_rows, size_t block_cols);
+
+} // namespace softaccelnpu
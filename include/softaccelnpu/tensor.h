@@ -1,50 +1,162 @@
 #pragma once
 
 #include "types.h"
+#include "allocator.h"
 #include <vector>
 #include <memory>
 #include <stdexcept>
 
 namespace softaccelnpu {
 
+size_t get_dtype_size(DataType dtype);
+
+struct SparsityMask;
+
+// Uninitialized skips the zero-fill for tensors that are fully overwritten anyway
+// (weights being loaded, GEMM outputs written with beta = 0)
+enum class TensorInit { Zero, Uninitialized };
+
 class Tensor {
 public:
-    Tensor(size_t rows, size_t cols, DataType dtype = DataType::FP32, Layout layout = Layout::RowMajor);
+    /**
+     * Layout::Tiled stores TILE_WIDTH-column panels one after another (panel-major):
+     * element (r, c) lives at ((c / TILE_WIDTH) * rows + r) * TILE_WIDTH + c % TILE_WIDTH,
+     * and the last panel is zero-padded. This is the order in which the GEMM micro-kernels
+     * stream B, so a Tiled weight is consumed without repacking.
+     */
+    static constexpr size_t TILE_WIDTH = 16;
+
+    Tensor(size_t rows, size_t cols, DataType dtype = DataType::FP32, Layout layout = Layout::RowMajor,
+           TensorInit init = TensorInit::Zero, TensorAllocator* allocator = nullptr);
+    ~Tensor();
+
+    Tensor(const Tensor& other);
+    Tensor(Tensor&& other) noexcept;
+    Tensor& operator=(const Tensor& other);
+    Tensor& operator=(Tensor&& other) noexcept;
+
+    /**
+     * @brief Non-owning tensor over external storage (arena slices, mapped files).
+     * The storage must outlive the tensor and is never freed by it; copies own theirs.
+     */
+    static Tensor wrap(void* data, size_t rows, size_t cols, DataType dtype = DataType::FP32,
+                       Layout layout = Layout::RowMajor);
 
     // Accessors
     template<typename T>
     T& at(size_t r, size_t c) {
-        return reinterpret_cast<T*>(data_.data())[idx(r, c)];
+        drop_sparsity_mask();
+        return reinterpret_cast<T*>(data_)[idx(r, c)];
     }
 
     template<typename T>
     const T& at(size_t r, size_t c) const {
-        return reinterpret_cast<const T*>(data_.data())[idx(r, c)];
+        return reinterpret_cast<const T*>(data_)[idx(r, c)];
     }
 
-    void* data() { return data_.data(); }
-    const void* data() const { return data_.data(); }
+    // Mutable access drops the cached sparsity mask
+    void* data() { drop_sparsity_mask(); return data_; }
+    const void* data() const { return data_; }
 
     // Typed data access for convenience
-    float* data_as_fp32() { return reinterpret_cast<float*>(data_.data()); }
-    int8_t* data_as_int8() { return reinterpret_cast<int8_t*>(data_.data()); }
+    float* data_as_fp32() { drop_sparsity_mask(); return reinterpret_cast<float*>(data_); }
+    int8_t* data_as_int8() { drop_sparsity_mask(); return reinterpret_cast<int8_t*>(data_); }
+    uint16_t* data_as_half() { drop_sparsity_mask(); return reinterpret_cast<uint16_t*>(data_); }  // FP16 / BF16 bit patterns
 
     size_t rows() const { return rows_; }
     size_t cols() const { return cols_; }
     DataType dtype() const { return dtype_; }
+    Layout layout() const { return layout_; }
     size_t size() const { return rows_ * cols_; }
+    size_t bytes() const { return bytes_; }
+    TensorAllocator* allocator() const { return allocator_; }  // nullptr for wrapped storage
+
+    /** @brief Copy of this tensor in another layout (RowMajor, ColMajor or Tiled). */
+    Tensor to_layout(Layout layout) const;
+
+    /**
+     * @brief Copy converted between FP32 and FP16/BF16/FP8 (same layout, storage rounded to
+     * nearest even). FP8 is converted unscaled; use Fp8Weights::quantize for scaled weights.
+     */
+    Tensor to_dtype(DataType dtype) const;
 
     void fill(float value);
     void randomize(); // For testing
 
+    /**
+     * @brief Scans the tensor once and caches which blocks are all zero; gemm_tiled then
+     * skips those blocks when this tensor is A or B. Meant for weights: mutating
+     * accessors and mutable TensorViews (e.g. GEMM outputs) drop the mask, but writes
+     * through a view taken before the mask was built do not, so rebuild it after
+     * changing the contents that way.
+     */
+    const SparsityMask& build_sparsity_mask(size_t block_rows = 64, size_t block_cols = TILE_WIDTH);
+    const SparsityMask* sparsity_mask() const { return sparsity_mask_.get(); }
+
 private:
     size_t idx(size_t r, size_t c) const;
+    void release();
+    void drop_sparsity_mask() { if (sparsity_mask_) sparsity_mask_.reset(); }
 
     size_t rows_;
     size_t cols_;
     DataType dtype_;
     Layout layout_;
-    std::vector<uint8_t> data_; // Generic storage supporting FP32, INT8, etc.
+    size_t bytes_ = 0;
+    TensorAllocator* allocator_ = nullptr;
+    uint8_t* data_ = nullptr; // Generic storage supporting FP32, INT8, etc.; 64-byte aligned
+    std::shared_ptr<const SparsityMask> sparsity_mask_;  // Immutable, so copies share it
+};
+
+/**
+ * @brief Non-owning 2D window into tensor storage.
+ *
+ * Element (r, c) lives at data + r * row_stride + c * col_stride (strides in elements),
+ * so row/column ranges, head slices and transposes are views of the same buffer and
+ * never copy. A row-major view with col_stride == 1 maps directly onto the kernels'
+ * lda/ldb/ldc. Like std::span, a view neither owns nor extends the lifetime of its
+ * storage. Views convert implicitly only from mutable tensors; a view of a const tensor
+ * must be spelled TensorView(t) and may only be passed as an input operand.
+ */
+class TensorView {
+public:
+    TensorView() = default;
+    TensorView(void* data, size_t rows, size_t cols, size_t row_stride, size_t col_stride = 1,
+               DataType dtype = DataType::FP32);
+    TensorView(Tensor& tensor);                    // Whole tensor (implicit)
+    explicit TensorView(const Tensor& tensor);     // Read-only use: never pass as an output
+
+    template<typename T>
+    T& at(size_t r, size_t c) const {
+        return reinterpret_cast<T*>(data_)[r * row_stride_ + c * col_stride_];
+    }
+
+    void* data() const { return data_; }
+    float* data_as_fp32() const { return reinterpret_cast<float*>(data_); }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return rows_ * cols_; }
+    size_t row_stride() const { return row_stride_; }
+    size_t col_stride() const { return col_stride_; }
+    DataType dtype() const { return dtype_; }
+
+    /** @brief Sub-block [r0, r0 + rows) x [c0, c0 + cols). */
+    TensorView block(size_t r0, size_t c0, size_t rows, size_t cols) const;
+    TensorView row_range(size_t r0, size_t rows) const { return block(r0, 0, rows, cols_); }
+    TensorView col_range(size_t c0, size_t cols) const { return block(0, c0, rows_, cols); }
+    TensorView transposed() const;
+
+    bool has_unit_col_stride() const { return col_stride_ == 1 || cols_ <= 1; }
+    bool is_contiguous() const { return has_unit_col_stride() && (row_stride_ == cols_ || rows_ <= 1); }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t row_stride_ = 0;
+    size_t col_stride_ = 1;
+    DataType dtype_ = DataType::FP32;
 };
 
 } // namespace softaccelnpu
@@ -22,6 +22,14 @@ public:
     // Splits range [start, end) into chunks and executes in parallel
     void parallel_for(size_t start, size_t end, std::function<void(size_t, size_t)> chunk_func);
 
+    // Dynamic scheduling utility
+    // Runs task_func(i) for every i in [0, count); workers pull indices from a shared
+    // counter, so tasks of uneven cost stay load-balanced
+    void parallel_tasks(size_t count, std::function<void(size_t)> task_func);
+
+    // Both utilities run inline when called from a pool thread (nested parallelism),
+    // so a task may call parallelized ops without deadlocking the pool
+
     size_t num_threads() const { return workers_.size(); }
 
 private:
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "softaccelnpu/tensor.h"
+#include <vector>
+
+/**
+ * @file transformer_ops.h
+ * @brief Row-wise normalization, rotary embedding and softmax operators.
+ */
+
+namespace softaccelnpu {
+
+/**
+ * @class RopeTable
+ * @brief Precomputed rotary embedding sin/cos table for positions [0, max_positions).
+ *
+ * interleaved = false rotates the two halves of each head (GPT-NeoX / HF Llama);
+ * interleaved = true rotates adjacent pairs (original Llama / GGML). Entries are stored
+ * in the lane order the kernel consumes, so applying RoPE is two loads and two FMAs
+ * per 8 values.
+ */
+class RopeTable {
+public:
+    RopeTable(size_t head_dim, size_t max_positions, float theta = 10000.0f, bool interleaved = false);
+
+    size_t head_dim() const { return head_dim_; }
+    size_t max_positions() const { return max_positions_; }
+    bool interleaved() const { return interleaved_; }
+
+    // Per-position rows of head_dim floats
+    const float* cos_row(size_t pos) const { return cos_.data() + pos * head_dim_; }
+    const float* sin_row(size_t pos) const { return sin_.data() + pos * head_dim_; }
+
+private:
+    size_t head_dim_;
+    size_t max_positions_;
+    bool interleaved_;
+    std::vector<float> cos_;
+    std::vector<float> sin_;
+};
+
+/**
+ * @class TransformerOps
+ * @brief Vectorized, multithreaded row-wise operators that sit between the GEMMs.
+ *
+ * All operators work on FP32 row-major tensors, one row per token, and may run
+ * in place (X and Y the same tensor).
+ */
+class TransformerOps {
+public:
+    /** @brief Y = X / sqrt(mean(X^2) + eps) * weight, per row. weight holds cols() values. */
+    static void rms_norm(const Tensor& X, const Tensor& weight, Tensor& Y, float eps = 1e-6f);
+
+    /** @brief Y = (X - mean) / sqrt(var + eps) * gamma + beta, per row. */
+    static void layer_norm(const Tensor& X, const Tensor& gamma, const Tensor& beta, Tensor& Y, float eps = 1e-5f);
+
+    /**
+     * @brief Applies rotary position embedding in place.
+     *
+     * X is tokens x (num_heads * head_dim); row r is at position pos0 + r. Works for
+     * Q and K alike (pass the matching head count).
+     */
+    static void rope(Tensor& X, size_t num_heads, const RopeTable& table, size_t pos0);
+
+    /** @brief Numerically stable softmax over each row: Y = exp(X - max) / sum. */
+    static void softmax(const Tensor& X, Tensor& Y);
+};
+
+} // namespace softaccelnpu
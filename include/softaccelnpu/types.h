@@ -11,7 +11,10 @@ enum class DataType {
     FP16,
     INT8,
     INT4,
-    INT32 // For accumulators
+    INT32, // For accumulators
+    BF16,     // bfloat16: FP32 exponent range, 8-bit mantissa
+    FP8_E4M3, // 1 byte, max 448: weights (used with scales)
+    FP8_E5M2  // 1 byte, max 57344: wider range, 2-bit mantissa
 };
 
 enum class DeviceType {
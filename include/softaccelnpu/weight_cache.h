@@ -0,0 +1,124 @@
+#pragma once
+
+#include "softaccelnpu/load_pipeline.h"
+#include "softaccelnpu/mapped_file.h"
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/tensor.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file weight_cache.h
+ * @brief On-disk cache of weights already transformed into kernel-native form.
+ */
+
+namespace softaccelnpu {
+
+class GgufLoader;
+
+/**
+ * @brief What a cached weight was packed for. A cache is used only if every field
+ * matches the running process; otherwise it is stale and gets rebuilt.
+ */
+struct WeightCacheKey {
+    uint64_t model_hash = 0;  // Identity of the source model (see PackedWeightCache::model_hash)
+    std::string isa;          // Micro-kernel that consumes the panels, e.g. "Avx2Kernel"
+    GemmTiling tiling;
+
+    /** @brief Key for the kernel and tiling this process would use now. */
+    static WeightCacheKey current(uint64_t model_hash);
+
+    bool operator==(const WeightCacheKey& o) const {
+        return model_hash == o.model_hash && isa == o.isa && tiling == o.tiling;
+    }
+    bool operator!=(const WeightCacheKey& o) const { return !(*this == o); }
+};
+
+/**
+ * @class PackedWeightCache
+ * @brief Named tensors stored exactly as the kernels consume them (any dtype and layout,
+ * e.g. Layout::Tiled FP32 panels or FP8 weights plus their scales).
+ *
+ * File layout: a fixed header carrying the WeightCacheKey, an index of (name, dtype,
+ * layout, rows, cols, offset, bytes) entries, then the tensor bytes, each 64-byte
+ * aligned. An opened cache is memory-mapped and get() wraps tensors in place, so a warm
+ * start does no packing and no copying. Writes go to a per-process temporary file that is
+ * renamed over the target, so a concurrent reader never sees a partial cache and two
+ * processes rebuilding the same cache do not write into one file.
+ */
+class PackedWeightCache {
+public:
+    using Entries = std::vector<std::pair<std::string, Tensor>>;
+    using Builder = std::function<Entries()>;
+
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Maps a cache file if it exists, is well formed and was packed for key.
+     * Returns false otherwise; status() then says why (missing, stale key, corrupt).
+     */
+    bool open(const std::string& path, const WeightCacheKey& key);
+
+    /**
+     * @brief Opens path, or on a miss runs build, writes its result to path and opens that.
+     * Returns true on a cache hit.
+     * @throws std::runtime_error if the rebuilt cache cannot be written.
+     */
+    bool load_or_build(const std::string& path, const WeightCacheKey& key, const Builder& build);
+
+    /**
+     * @throws std::invalid_argument if two entries share a name.
+     * @throws std::runtime_error on I/O failure.
+     */
+    static void write(const std::string& path, const WeightCacheKey& key, const Entries& entries);
+
+    bool is_open() const { return mapping_ != nullptr; }
+    const std::string& status() const { return status_; }
+    size_t size() const { return index_.size(); }
+    bool contains(const std::string& name) const { return index_.count(name) != 0; }
+    std::vector<std::string> names() const;
+
+    /**
+     * @brief Non-owning, read-only tensor over the mapped cache; valid while this cache
+     * (or mapping()) is alive.
+     * @throws std::invalid_argument if the cache is not open or has no such entry.
+     */
+    Tensor get(const std::string& name) const;
+    std::shared_ptr<const MappedFile> mapping() const { return mapping_; }
+
+    /**
+     * @brief 64-bit FNV-1a over a mapped GGUF model's file size and modification time,
+     * its header region, and 64-byte samples of every tensor: one per MiB plus the last
+     * 64 bytes. Touches about one page per MiB of weights, and changes whenever the file
+     * is rewritten or its metadata, tensor table or sampled weights differ.
+     * @throws std::invalid_argument if the loader has not mapped its file.
+     */
+    static uint64_t model_hash(const GgufLoader& loader);
+
+    /**
+     * @brief Packs every 2D F32/F16/BF16 weight of a mapped GGUF model for gemm_tiled:
+     * the stored [out x in] matrix becomes B = [in x out] as Layout::Tiled FP32 panels.
+     * Runs on a LoadPipeline (reads overlapped with packing, tensors spread over the
+     * thread pool); stats, if given, receives its per-stage throughput.
+     */
+    static Entries pack_gguf(const GgufLoader& loader, LoadStats* stats = nullptr);
+
+private:
+    struct Entry {
+        DataType dtype;
+        Layout layout;
+        size_t rows, cols;
+        uint64_t offset, bytes;
+    };
+
+    std::shared_ptr<const MappedFile> mapping_;
+    std::map<std::string, Entry> index_;
+    std::string status_;
+};
+
+} // namespace softaccelnpu
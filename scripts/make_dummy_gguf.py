@@ -1,18 +1,130 @@
+"""Writes a small but complete GGUF v3 file for the loader demos.
+
+The file carries typed metadata (scalars, strings, nested arrays, general.alignment)
+and a handful of llama-shaped tensors in F32, F16 and Q8_0 with real, aligned data,
+so GgufLoader exercises every part of the format.
+
+Usage: python make_dummy_gguf.py [output_path] [--dim N] [--layers N]
+"""
+import argparse
+import os
+import random
 import struct
 
-def create_dummy_gguf(path):
-    # Magic: 'GGUF'
-    magic = b'GGUF'
-    version = 3
-    tensor_count = 10
-    kv_count = 0
-    
+GGUF_VERSION = 3
+ALIGNMENT = 32
+
+# gguf_type ids
+U8, I8, U16, I16, U32, I32, F32, BOOL, STRING, ARRAY, U64, I64, F64 = range(13)
+SCALAR_FORMATS = {U8: '<B', I8: '<b', U16: '<H', I16: '<h', U32: '<I', I32: '<i',
+                  F32: '<f', BOOL: '<?', U64: '<Q', I64: '<q', F64: '<d'}
+
+# ggml type ids and (block elements, block bytes)
+GGML_F32, GGML_F16, GGML_Q8_0 = 0, 1, 8
+GGML_SIZES = {GGML_F32: (1, 4), GGML_F16: (1, 2), GGML_Q8_0: (32, 34)}
+
+
+def pack_string(s):
+    data = s.encode('utf-8')
+    return struct.pack('<Q', len(data)) + data
+
+
+def pack_value(vtype, value):
+    if vtype == STRING:
+        return pack_string(value)
+    if vtype == ARRAY:
+        elem_type, items = value
+        out = struct.pack('<IQ', elem_type, len(items))
+        return out + b''.join(pack_value(elem_type, v) for v in items)
+    return struct.pack(SCALAR_FORMATS[vtype], value)
+
+
+def tensor_bytes(ggml_type, shape, rng):
+    elements = 1
+    for d in shape:
+        elements *= d
+    if ggml_type == GGML_F32:
+        return struct.pack('<%df' % elements, *(rng.uniform(-0.1, 0.1) for _ in range(elements)))
+    if ggml_type == GGML_F16:
+        return struct.pack('<%de' % elements, *(rng.uniform(-0.1, 0.1) for _ in range(elements)))
+    # Q8_0: per 32 values, an F16 scale and 32 int8 quants
+    blocks = []
+    for _ in range((elements + 31) // 32):
+        blocks.append(struct.pack('<e', 0.01) + bytes(rng.randrange(256) for _ in range(32)))
+    return b''.join(blocks)
+
+
+def create_dummy_gguf(path, dim=256, layers=2, vocab=64):
+    rng = random.Random(0)
+    hidden = dim * 2
+    tokens = ['<unk>', '<s>', '</s>'] + ['tok%d' % i for i in range(vocab - 3)]
+    metadata = [
+        ('general.architecture', STRING, 'llama'),
+        ('general.name', STRING, 'softaccel-dummy'),
+        ('general.alignment', U32, ALIGNMENT),
+        ('general.quantized', BOOL, True),
+        ('llama.context_length', U32, 512),
+        ('llama.embedding_length', U32, dim),
+        ('llama.feed_forward_length', U32, hidden),
+        ('llama.block_count', U32, layers),
+        ('llama.attention.head_count', U32, 4),
+        ('llama.attention.head_count_kv', U32, 4),
+        ('llama.rope.freq_base', F32, 10000.0),
+        ('llama.attention.layer_norm_rms_epsilon', F32, 1e-5),
+        ('tokenizer.ggml.model', STRING, 'llama'),
+        ('tokenizer.ggml.tokens', ARRAY, (STRING, tokens)),
+        ('tokenizer.ggml.scores', ARRAY, (F32, [float(-i) for i in range(vocab)])),
+        ('tokenizer.ggml.token_type', ARRAY, (I32, [1] * vocab)),
+        ('softaccel.test.nested', ARRAY, (ARRAY, [(U8, [1, 2]), (U8, [3])])),
+        ('softaccel.test.i64', I64, -42),
+        ('softaccel.test.f64', F64, 0.5),
+    ]
+
+    # GGUF shapes list the contiguous dimension first: [in_features, out_features]
+    tensors = [('token_embd.weight', [dim, vocab], GGML_F32)]
+    for i in range(layers):
+        tensors += [
+            ('blk.%d.attn_norm.weight' % i, [dim], GGML_F32),
+            ('blk.%d.attn_q.weight' % i, [dim, dim], GGML_F16),
+            ('blk.%d.attn_k.weight' % i, [dim, dim], GGML_F16),
+            ('blk.%d.attn_v.weight' % i, [dim, dim], GGML_F16),
+            ('blk.%d.attn_output.weight' % i, [dim, dim], GGML_F16),
+            ('blk.%d.ffn_norm.weight' % i, [dim], GGML_F32),
+            ('blk.%d.ffn_gate.weight' % i, [dim, hidden], GGML_Q8_0),
+            ('blk.%d.ffn_up.weight' % i, [dim, hidden], GGML_Q8_0),
+            ('blk.%d.ffn_down.weight' % i, [hidden, dim], GGML_Q8_0),
+        ]
+    tensors += [('output_norm.weight', [dim], GGML_F32), ('output.weight', [dim, vocab], GGML_F32)]
+
+    header = b'GGUF' + struct.pack('<IQQ', GGUF_VERSION, len(tensors), len(metadata))
+    for key, vtype, value in metadata:
+        header += pack_string(key) + struct.pack('<I', vtype) + pack_value(vtype, value)
+
+    data = b''
+    infos = b''
+    for name, shape, ggml_type in tensors:
+        data += b'\0' * (-len(data) % ALIGNMENT)
+        infos += pack_string(name) + struct.pack('<I', len(shape))
+        infos += b''.join(struct.pack('<Q', d) for d in shape)
+        infos += struct.pack('<IQ', ggml_type, len(data))
+        data += tensor_bytes(ggml_type, shape, rng)
+
+    header += infos
+    header += b'\0' * (-len(header) % ALIGNMENT)
+
+    directory = os.path.dirname(path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
     with open(path, 'wb') as f:
-        f.write(magic)
-        f.write(struct.pack('<I', version))
-        f.write(struct.pack('<Q', tensor_count))
-        f.write(struct.pack('<Q', kv_count))
-    print(f"Created dummy GGUF file at {path}")
+        f.write(header)
+        f.write(data)
+    print(f"Created dummy GGUF file at {path} ({len(tensors)} tensors, {len(header) + len(data)} bytes)")
+
 
 if __name__ == "__main__":
-    create_dummy_gguf("build/dummy_model.gguf")
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('path', nargs='?', default='build/dummy_model.gguf')
+    parser.add_argument('--dim', type=int, default=256)
+    parser.add_argument('--layers', type=int, default=2)
+    args = parser.parse_args()
+    create_dummy_gguf(args.path, dim=args.dim, layers=args.layers)
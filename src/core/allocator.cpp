@@ -0,0 +1,166 @@
+#include "softaccelnpu/allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace softaccelnpu {
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_deallocations{0};
+std::atomic<size_t> g_bytes_allocated{0};
+std::atomic<size_t> g_bytes_in_use{0};
+std::atomic<size_t> g_peak_bytes{0};
+std::atomic<size_t> g_huge_page_bytes{0};
+
+void note_allocate(size_t bytes) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    const size_t in_use = g_bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = g_peak_bytes.load(std::memory_order_relaxed);
+    while (in_use > peak && !g_peak_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+}
+
+void note_deallocate(size_t bytes) {
+    g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t round_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+std::atomic<TensorAllocator*> g_default_allocator{nullptr};
+
+} // namespace
+
+void* AlignedAllocator::allocate(size_t bytes) {
+    // Both allocators reject size 0 inconsistently; hand out a minimal block instead
+    const size_t size = round_up(std::max<size_t>(bytes, 1), ALIGNMENT);
+#ifdef _WIN32
+    void* p = _aligned_malloc(size, ALIGNMENT);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, ALIGNMENT, size) != 0) p = nullptr;
+#endif
+    if (!p) throw std::bad_alloc();
+    note_allocate(bytes);
+    return p;
+}
+
+void AlignedAllocator::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) return;
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+    note_deallocate(bytes);
+}
+
+bool HugePageAllocator::is_mapped(size_t bytes) const {
+#ifdef _WIN32
+    (void)bytes;
+    return false;
+#else
+    return bytes >= min_bytes_ && bytes >= HUGE_PAGE_SIZE;
+#endif
+}
+
+bool HugePageAllocator::returns_zeroed(size_t bytes) const {
+    return is_mapped(bytes);
+}
+
+void* HugePageAllocator::allocate(size_t bytes) {
+    if (!is_mapped(bytes)) return small_.allocate(bytes);
+#ifdef _WIN32
+    return nullptr; // Unreachable: is_mapped() is false
+#else
+    const size_t len = round_up(bytes, HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+    if (use_hugetlbfs_) {
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            note_allocate(bytes);
+            g_huge_page_bytes.fetch_add(len, std::memory_order_relaxed);
+            return p;
+        }
+        // Pool empty or not configured: fall through to transparent huge pages
+    }
+#endif
+
+    // Over-map by one huge page and trim, so the buffer starts on a 2 MB boundary and
+    // every 2 MB of it is eligible for a THP
+    const size_t span = len + HUGE_PAGE_SIZE;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = round_up(base, HUGE_PAGE_SIZE);
+    const size_t head = aligned - base;
+    const size_t tail = span - head - len;
+    if (head) munmap(raw, head);
+    if (tail) munmap(reinterpret_cast<void*>(aligned + len), tail);
+
+    void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    if (madvise(p, len, MADV_HUGEPAGE) == 0) {
+        g_huge_page_bytes.fetch_add(len, std::memory_order_relaxed);
+    }
+#endif
+    note_allocate(bytes);
+    return p;
+#endif
+}
+
+void HugePageAllocator::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) return;
+    if (!is_mapped(bytes)) {
+        small_.deallocate(ptr, bytes);
+        return;
+    }
+#ifndef _WIN32
+    // hugetlbfs and THP mappings are both exactly round_up(bytes, 2 MB) long
+    munmap(ptr, round_up(bytes, HUGE_PAGE_SIZE));
+    note_deallocate(bytes);
+#endif
+}
+
+TensorAllocator& default_tensor_allocator() {
+    // Leaked on purpose: static tensors may be destroyed after any function-local static
+    static HugePageAllocator* builtin = new HugePageAllocator();
+    TensorAllocator* custom = g_default_allocator.load(std::memory_order_acquire);
+    return custom ? *custom : *builtin;
+}
+
+void set_default_tensor_allocator(TensorAllocator* allocator) {
+    g_default_allocator.store(allocator, std::memory_order_release);
+}
+
+AllocationStats get_allocation_stats() {
+    AllocationStats s;
+    s.allocations = g_allocations.load(std::memory_order_relaxed);
+    s.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    s.bytes_allocated = g_bytes_allocated.load(std::memory_order_relaxed);
+    s.bytes_in_use = g_bytes_in_use.load(std::memory_order_relaxed);
+    s.peak_bytes_in_use = g_peak_bytes.load(std::memory_order_relaxed);
+    s.huge_page_bytes = g_huge_page_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void reset_allocation_stats() {
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_deallocations.store(0, std::memory_order_relaxed);
+    g_bytes_allocated.store(0, std::memory_order_relaxed);
+    g_huge_page_bytes.store(0, std::memory_order_relaxed);
+    g_peak_bytes.store(g_bytes_in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} // namespace softaccelnpu
@@ -53,20 +53,49 @@ void npu_delete_command_list(NpuCommandListHandle cmd_list) {
 }
 
 NpuOperatorHandle npu_create_gemm_operator(NpuDeviceHandle device, int M, int N, int K) {
+    if (M < 0 || N < 0 || K < 0) return nullptr;
     auto dev = *static_cast<std::shared_ptr<DmlDevice>*>(device);
     return new std::shared_ptr<DmlOperator>(dev->create_gemm_operator(M, N, K));
 }
 
+NpuOperatorHandle npu_create_batched_gemm_operator(
+    NpuDeviceHandle device, int batch, int M, int N, int K,
+    int lda, int ldb, int ldc,
+    long long stride_a, long long stride_b, long long stride_c,
+    bool trans_b) {
+    // Negative values would wrap to huge sizes once cast to size_t
+    if (batch < 0 || M < 0 || N < 0 || K < 0 || lda < 0 || ldb < 0 || ldc < 0 ||
+        stride_a < 0 || stride_b < 0 || stride_c < 0) {
+        return nullptr;
+    }
+    auto dev = *static_cast<std::shared_ptr<DmlDevice>*>(device);
+    GemmBatchDesc desc;
+    desc.batch = batch;
+    desc.M = M; desc.N = N; desc.K = K;
+    desc.lda = lda; desc.ldb = ldb; desc.ldc = ldc;
+    desc.stride_a = stride_a; desc.stride_b = stride_b; desc.stride_c = stride_c;
+    desc.trans_b = trans_b;
+    return new std::shared_ptr<DmlOperator>(dev->create_batched_gemm_operator(desc));
+}
+
 void npu_delete_operator(NpuOperatorHandle op) {
     delete static_cast<std::shared_ptr<DmlOperator>*>(op);
 }
 
 void npu_command_list_record_gemm(NpuCommandListHandle cmd_list, NpuOperatorHandle op, NpuTensorHandle A, NpuTensorHandle B, NpuTensorHandle C) {
+    if (!op) return;
     auto cl = *static_cast<std::shared_ptr<DmlCommandList>*>(cmd_list);
     auto oper = *static_cast<std::shared_ptr<DmlOperator>*>(op);
     cl->record_gemm(oper, *static_cast<Tensor*>(A), *static_cast<Tensor*>(B), *static_cast<Tensor*>(C));
 }
 
+void npu_command_list_record_gemm_batched(NpuCommandListHandle cmd_list, NpuOperatorHandle op, NpuTensorHandle A, NpuTensorHandle B, NpuTensorHandle C) {
+    if (!op) return;
+    auto cl = *static_cast<std::shared_ptr<DmlCommandList>*>(cmd_list);
+    auto oper = *static_cast<std::shared_ptr<DmlOperator>*>(op);
+    cl->record_gemm_batched(oper, *static_cast<Tensor*>(A), *static_cast<Tensor*>(B), *static_cast<Tensor*>(C));
+}
+
 void npu_command_list_execute(NpuCommandListHandle cmd_list) {
     auto cl = *static_cast<std::shared_ptr<DmlCommandList>*>(cmd_list);
     cl->execute();
@@ -91,8 +120,9 @@ double npu_get_l1_hit_rate() {
 }
 
 double npu_get_compression_ratio() {
-    auto& s = CacheModel::get_global_stats();
-    return s.memory_bytes_compressed > 0 ? (double)s.memory_bytes_raw / s.memory_bytes_compressed : 1.0;
+    // The measured ratio once a compressed weight stream ran, the modelled 4D-V ratio before
+    if (CacheModel::get_global_stats().weight_bytes_moved > 0) return CacheModel::weight_stream_ratio();
+    return CacheModel::compression_ratio();
 }
 
 void npu_set_benchmark_mode(bool enable) {
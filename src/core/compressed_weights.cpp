@@ -0,0 +1,65 @@
+#include "softaccelnpu/compressed_weights.h"
+#include <limits>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+size_t CompressedWeights::bytes() const {
+    return masks.size() * sizeof(uint16_t) + offsets.size() * sizeof(uint32_t) + nnz() * sizeof(float);
+}
+
+double CompressedWeights::compression_ratio() const {
+    const size_t b = bytes();
+    return b ? static_cast<double>(rows * cols * sizeof(float)) / static_cast<double>(b) : 1.0;
+}
+
+CompressedWeights CompressedWeights::from_dense(const Tensor& W) {
+    if (W.dtype() != DataType::FP32 || W.layout() != Layout::RowMajor) {
+        throw std::invalid_argument("CompressedWeights::from_dense: W must be FP32 RowMajor");
+    }
+    if (W.rows() * W.cols() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("CompressedWeights::from_dense: W is too large for 32-bit stream offsets");
+    }
+    CompressedWeights s;
+    s.rows = W.rows();
+    s.cols = W.cols();
+    const size_t K = s.rows, N = s.cols, P = s.panels(), T = s.tiles_k();
+    const float* w = static_cast<const float*>(W.data());
+
+    s.masks.assign(P * K, 0);
+    s.offsets.assign(P * T, 0);
+    for (size_t p = 0; p < P; ++p) {
+        const size_t n0 = p * PANEL;
+        for (size_t k = 0; k < K; ++k) {
+            if (k % TILE_K == 0) s.offsets[p * T + k / TILE_K] = static_cast<uint32_t>(s.values.size());
+            uint16_t mask = 0;
+            for (size_t j = 0; j < PANEL && n0 + j < N; ++j) {
+                const float v = w[k * N + n0 + j];
+                if (v == 0.0f) continue;
+                mask |= static_cast<uint16_t>(1u << j);
+                s.values.push_back(v);
+            }
+            s.masks[p * K + k] = mask;
+        }
+    }
+    // Expansion loads 8 values past the current position even when fewer remain
+    s.values.resize(s.values.size() + PANEL, 0.0f);
+    return s;
+}
+
+Tensor CompressedWeights::to_dense() const {
+    Tensor out(rows, cols);
+    float* o = out.data_as_fp32();
+    size_t i = 0;
+    for (size_t p = 0; p < panels(); ++p) {
+        for (size_t k = 0; k < rows; ++k) {
+            const uint16_t mask = masks[p * rows + k];
+            for (size_t j = 0; j < PANEL; ++j) {
+                if (mask & (1u << j)) o[k * cols + p * PANEL + j] = values[i++];
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace softaccelnpu
@@ -5,6 +5,9 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
 
 namespace softaccelnpu {
 
@@ -26,19 +29,91 @@ std::shared_ptr<DmlOperator> DmlDevice::create_gemm_operator(size_t M, size_t N,
     return std::make_shared<DmlOperator>(DmlOperator::Ty::GEMM, desc);
 }
 
+std::shared_ptr<DmlOperator> DmlDevice::create_ffn_operator(size_t dim, size_t hidden_dim) {
+    DmlFfnDescriptor desc;
+    desc.dim = dim;
+    desc.hidden_dim = hidden_dim;
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::FFN_SWIGLU, desc);
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_batched_gemm_operator(const GemmBatchDesc& desc) {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::GEMM_BATCHED, desc);
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_attention_operator(const AttentionDesc& desc) {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::ATTENTION, desc);
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_decode_attention_operator(const AttentionDesc& desc) {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::DECODE_ATTENTION, desc);
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_rms_norm_operator(float eps) {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::RMS_NORM, DmlNormDescriptor{eps});
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_layer_norm_operator(float eps) {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::LAYER_NORM, DmlNormDescriptor{eps});
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_rope_operator(size_t num_heads, size_t head_dim, size_t max_positions,
+                                                            float theta, bool interleaved) {
+    DmlRopeDescriptor desc;
+    desc.num_heads = num_heads;
+    desc.head_dim = head_dim;
+    auto table = std::make_shared<const RopeTable>(head_dim, max_positions, theta, interleaved);
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::ROPE, desc, table);
+}
+
+std::shared_ptr<DmlOperator> DmlDevice::create_softmax_operator() {
+    return std::make_shared<DmlOperator>(DmlOperator::Ty::SOFTMAX);
+}
+
 void DmlDevice::print_report() {
     CacheModel::print_4d_report();
 }
 
 // --- DmlCommandList ---
 
+DmlCommandList::Command DmlCommandList::gemm_command(std::shared_ptr<DmlOperator> op, const TensorView& A,
+                                                     const TensorView& C) {
+    // A and C always travel as views, so plan_memory finds and rebases them the same way for every B form
+    return Command{DmlOperator::Ty::GEMM, std::move(op), nullptr, nullptr, nullptr, nullptr, 0, A, TensorView{}, C};
+}
+
 void DmlCommandList::record_gemm(
     std::shared_ptr<DmlOperator> op,
-    const Tensor& A,
+    const TensorView& A,
+    const TensorView& B,
+    const TensorView& C
+) {
+    Command cmd = gemm_command(std::move(op), A, C);
+    cmd.view_b = B;
+    commands_.push_back(cmd);
+}
+
+void DmlCommandList::record_gemm(
+    std::shared_ptr<DmlOperator> op,
+    const TensorView& A,
     const Tensor& B,
-    Tensor& C
+    const TensorView& C
+) {
+    // Tiled weights have no strided view; execute() hands the tensor itself to gemm_tiled,
+    // and plan_memory tracks it like any other Tensor operand
+    Command cmd = gemm_command(std::move(op), A, C);
+    cmd.B = &B;
+    commands_.push_back(cmd);
+}
+
+void DmlCommandList::record_gemm(
+    std::shared_ptr<DmlOperator> op,
+    const TensorView& A,
+    const Sparse24Weights& B,
+    const TensorView& C
 ) {
-    commands_.push_back({DmlOperator::Ty::GEMM, op, &A, &B, &C});
+    Command cmd = gemm_command(std::move(op), A, C);
+    cmd.sparse_b = &B;
+    commands_.push_back(cmd);
 }
 
 void DmlCommandList::record_bias_add(
@@ -57,10 +132,197 @@ void DmlCommandList::record_activation(
     commands_.push_back({DmlOperator::Ty::ACTIVATION, op, &input, nullptr, &output});
 }
 
+void DmlCommandList::record_gemm_batched(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& A,
+    const Tensor& B,
+    Tensor& C
+) {
+    commands_.push_back({DmlOperator::Ty::GEMM_BATCHED, op, &A, &B, &C});
+}
+
+void DmlCommandList::record_attention(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& Q,
+    const Tensor& K,
+    const Tensor& V,
+    Tensor& O
+) {
+    commands_.push_back({DmlOperator::Ty::ATTENTION, op, &Q, &K, &O, &V});
+}
+
+void DmlCommandList::record_decode_attention(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& Q,
+    const Tensor& K,
+    const Tensor& V,
+    Tensor& O
+) {
+    commands_.push_back({DmlOperator::Ty::DECODE_ATTENTION, op, &Q, &K, &O, &V});
+}
+
+void DmlCommandList::record_rms_norm(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& X,
+    const Tensor& weight,
+    Tensor& Y
+) {
+    commands_.push_back({DmlOperator::Ty::RMS_NORM, op, &X, &weight, &Y});
+}
+
+void DmlCommandList::record_layer_norm(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    Tensor& Y
+) {
+    commands_.push_back({DmlOperator::Ty::LAYER_NORM, op, &X, &gamma, &Y, &beta});
+}
+
+void DmlCommandList::record_rope(
+    std::shared_ptr<DmlOperator> op,
+    Tensor& X,
+    size_t pos0
+) {
+    commands_.push_back({DmlOperator::Ty::ROPE, op, &X, nullptr, &X, nullptr, pos0});
+}
+
+void DmlCommandList::record_softmax(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& input,
+    Tensor& output
+) {
+    commands_.push_back({DmlOperator::Ty::SOFTMAX, op, &input, nullptr, &output});
+}
+
+void DmlCommandList::record_ffn_swiglu(
+    std::shared_ptr<DmlOperator> op,
+    const Tensor& X,
+    const Tensor& W_gate_up,
+    const Tensor& W_down,
+    Tensor& Y
+) {
+    commands_.push_back({DmlOperator::Ty::FFN_SWIGLU, op, &X, &W_gate_up, &Y, &W_down});
+}
+
+Tensor& DmlCommandList::create_intermediate(size_t rows, size_t cols, DataType dtype) {
+    if (arena_) {
+        throw std::logic_error("DmlCommandList::create_intermediate: memory already planned; reset() first");
+    }
+    // Own storage until planned, so an unplanned list still executes correctly
+    intermediates_.push_back(std::make_unique<Tensor>(rows, cols, dtype));
+    return *intermediates_.back();
+}
+
+size_t DmlCommandList::plan_memory() {
+    if (arena_) {
+        throw std::logic_error("DmlCommandList::plan_memory: memory already planned; reset() first");
+    }
+    constexpr size_t NONE = static_cast<size_t>(-1);
+    auto find_tensor = [&](const Tensor* t) {
+        for (size_t i = 0; i < intermediates_.size(); ++i) {
+            if (intermediates_[i].get() == t) return i;
+        }
+        return NONE;
+    };
+    // Views are matched by address: until planned, every intermediate has its own storage
+    auto find_view = [&](const TensorView& v) {
+        const uint8_t* p = static_cast<const uint8_t*>(v.data());
+        for (size_t i = 0; i < intermediates_.size(); ++i) {
+            const uint8_t* base = static_cast<const uint8_t*>(intermediates_[i]->data());
+            if (p && p >= base && p < base + intermediates_[i]->bytes()) return i;
+        }
+        return NONE;
+    };
+
+    MemoryPlanner planner;
+    for (const auto& t : intermediates_) planner.add_buffer(t->bytes());
+
+    // Regions of each intermediate written so far, as (row, col, rows, cols) rectangles
+    struct Rect { size_t r0, c0, rows, cols; };
+    std::vector<std::vector<Rect>> written(intermediates_.size());
+    auto view_rect = [&](const TensorView& v, size_t id) {
+        const Tensor& t = *intermediates_[id];
+        const size_t elem = (static_cast<const uint8_t*>(v.data()) - static_cast<const uint8_t*>(t.data())) /
+                            get_dtype_size(t.dtype());
+        if (t.layout() != Layout::RowMajor || !v.has_unit_col_stride() || (v.row_stride() != t.cols() && v.rows() > 1)) {
+            return Rect{0, 0, t.rows(), t.cols()};  // Conservatively the whole tensor
+        }
+        return Rect{elem / t.cols(), elem % t.cols(), v.rows(), v.cols()};
+    };
+    auto was_written = [&](size_t id, const Rect& r) {
+        for (const Rect& w : written[id]) {
+            if (r.r0 < w.r0 + w.rows && w.r0 < r.r0 + r.rows && r.c0 < w.c0 + w.cols && w.c0 < r.c0 + r.cols) return true;
+        }
+        return false;
+    };
+    std::vector<size_t> view_ids(commands_.size() * 3, NONE);
+    for (size_t step = 0; step < commands_.size(); ++step) {
+        Command& cmd = commands_[step];
+        const size_t a = find_tensor(cmd.A), c = find_tensor(cmd.C);
+        size_t* v = &view_ids[step * 3];
+        v[0] = find_view(cmd.view_a);
+        v[1] = find_view(cmd.view_b);
+        v[2] = find_view(cmd.view_c);
+
+        const size_t ids[] = {a, find_tensor(cmd.B), c, find_tensor(cmd.D), v[0], v[1], v[2]};
+        for (size_t id : ids) {
+            if (id != NONE) planner.use(id, step);
+        }
+
+        // Accumulating ops must not see whatever the arena slot held before
+        const Rect c_rect = (c != NONE) ? Rect{0, 0, cmd.C->rows(), cmd.C->cols()}
+                          : (v[2] != NONE) ? view_rect(cmd.view_c, v[2]) : Rect{};
+        if (cmd.type == DmlOperator::Ty::GEMM && v[2] != NONE && !was_written(v[2], c_rect)) cmd.clear_c = true;
+        if (cmd.type == DmlOperator::Ty::GEMM_BATCHED && c != NONE && !was_written(c, c_rect) &&
+            cmd.op->get_batch_desc().beta != 0.0f) {
+            cmd.clear_c = true;
+        }
+
+        const bool elementwise = cmd.type == DmlOperator::Ty::ELEMENTWISE_BIAS || cmd.type == DmlOperator::Ty::ACTIVATION ||
+                                 cmd.type == DmlOperator::Ty::RMS_NORM || cmd.type == DmlOperator::Ty::LAYER_NORM ||
+                                 cmd.type == DmlOperator::Ty::SOFTMAX;
+        if (elementwise && a != NONE && c != NONE) planner.allow_in_place(c, a, step);
+
+        if (c != NONE) written[c].push_back(c_rect);
+        if (v[2] != NONE) written[v[2]].push_back(c_rect);
+    }
+
+    const size_t bytes = planner.plan();
+    plan_stats_ = planner.stats();
+    arena_ = std::make_unique<Tensor>(1, bytes, DataType::INT8, Layout::RowMajor, TensorInit::Uninitialized);
+    uint8_t* arena = static_cast<uint8_t*>(arena_->data());
+
+    // Rebase recorded views while the old storage is still there to measure offsets against
+    for (size_t step = 0; step < commands_.size(); ++step) {
+        TensorView* views[] = {&commands_[step].view_a, &commands_[step].view_b, &commands_[step].view_c};
+        for (size_t k = 0; k < 3; ++k) {
+            const size_t id = view_ids[step * 3 + k];
+            if (id == NONE) continue;
+            TensorView& v = *views[k];
+            const size_t rel = static_cast<const uint8_t*>(v.data()) - static_cast<const uint8_t*>(intermediates_[id]->data());
+            v = TensorView(arena + planner.offset(id) + rel, v.rows(), v.cols(), v.row_stride(), v.col_stride(), v.dtype());
+        }
+    }
+    // Same Tensor objects, new storage: recorded Tensor pointers stay valid
+    for (size_t i = 0; i < intermediates_.size(); ++i) {
+        Tensor& t = *intermediates_[i];
+        t = Tensor::wrap(arena + planner.offset(i), t.rows(), t.cols(), t.dtype(), t.layout());
+    }
+    return bytes;
+}
+
 void DmlCommandList::execute() {
     for (const auto& cmd : commands_) {
         if (cmd.type == DmlOperator::Ty::GEMM) {
-            GemmOps::gemm_tiled(*cmd.A, *cmd.B, *cmd.C);
+            if (cmd.clear_c) {
+                const TensorView& c = cmd.view_c;
+                for (size_t r = 0; r < c.rows(); ++r) std::memset(&c.at<float>(r, 0), 0, c.cols() * sizeof(float));
+            }
+            if (cmd.sparse_b) GemmOps::gemm_sparse24(cmd.view_a, *cmd.sparse_b, cmd.view_c);
+            else if (cmd.B) GemmOps::gemm_tiled(cmd.view_a, *cmd.B, cmd.view_c);
+            else GemmOps::gemm_tiled(cmd.view_a, cmd.view_b, cmd.view_c);
         } else if (cmd.type == DmlOperator::Ty::ELEMENTWISE_BIAS) {
             // Simple bias add
             float* in = (float*)cmd.A->data();
@@ -80,12 +342,32 @@ void DmlCommandList::execute() {
                     out[i] = in[i] / (1.0f + std::exp(-in[i]));
                 }
             }
+        } else if (cmd.type == DmlOperator::Ty::GEMM_BATCHED) {
+            if (cmd.clear_c) cmd.C->fill(0.0f);
+            GemmOps::gemm_batched_strided(*cmd.A, *cmd.B, *cmd.C, cmd.op->get_batch_desc());
+        } else if (cmd.type == DmlOperator::Ty::ATTENTION) {
+            AttentionOps::flash_attention(*cmd.A, *cmd.B, *cmd.D, *cmd.C, cmd.op->get_attention_desc());
+        } else if (cmd.type == DmlOperator::Ty::DECODE_ATTENTION) {
+            AttentionOps::decode_attention(*cmd.A, *cmd.B, *cmd.D, *cmd.C, cmd.op->get_attention_desc());
+        } else if (cmd.type == DmlOperator::Ty::RMS_NORM) {
+            TransformerOps::rms_norm(*cmd.A, *cmd.B, *cmd.C, cmd.op->get_norm_desc().eps);
+        } else if (cmd.type == DmlOperator::Ty::LAYER_NORM) {
+            TransformerOps::layer_norm(*cmd.A, *cmd.B, *cmd.D, *cmd.C, cmd.op->get_norm_desc().eps);
+        } else if (cmd.type == DmlOperator::Ty::ROPE) {
+            TransformerOps::rope(*cmd.C, cmd.op->get_rope_desc().num_heads, cmd.op->get_rope_table(), cmd.position);
+        } else if (cmd.type == DmlOperator::Ty::SOFTMAX) {
+            TransformerOps::softmax(*cmd.A, *cmd.C);
+        } else if (cmd.type == DmlOperator::Ty::FFN_SWIGLU) {
+            GemmOps::ffn_swiglu(*cmd.A, *cmd.B, *cmd.D, *cmd.C);
         }
     }
 }
 
 void DmlCommandList::reset() {
     commands_.clear();
+    intermediates_.clear();
+    arena_.reset();
+    plan_stats_ = MemoryPlanStats{};
 }
 
 } // namespace softaccelnpu
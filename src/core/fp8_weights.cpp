@@ -0,0 +1,71 @@
+#include "softaccelnpu/fp8.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+Fp8Weights Fp8Weights::quantize(const Tensor& W, DataType format, bool per_channel, Layout layout) {
+    if (format != DataType::FP8_E4M3 && format != DataType::FP8_E5M2) {
+        throw std::invalid_argument("Fp8Weights::quantize: format must be FP8_E4M3 or FP8_E5M2");
+    }
+    if (W.dtype() != DataType::FP32 || W.layout() != Layout::RowMajor) {
+        throw std::invalid_argument("Fp8Weights::quantize: W must be FP32 RowMajor");
+    }
+    const size_t K = W.rows(), N = W.cols();
+    const float* w = static_cast<const float*>(W.data());
+
+    std::vector<float> absmax(per_channel ? N : 1, 0.0f);
+    for (size_t k = 0; k < K; ++k) {
+        for (size_t n = 0; n < N; ++n) {
+            float& m = absmax[per_channel ? n : 0];
+            m = std::max(m, std::fabs(w[k * N + n]));
+        }
+    }
+
+    Fp8Weights out;
+    out.scales.resize(absmax.size());
+    std::vector<float> inv(absmax.size());
+    for (size_t i = 0; i < absmax.size(); ++i) {
+        // An all-zero channel keeps scale 1 so it decodes to exact zeros
+        out.scales[i] = absmax[i] > 0.0f ? absmax[i] / fp8_max(format) : 1.0f;
+        inv[i] = 1.0f / out.scales[i];
+    }
+
+    Tensor q(K, N, format, Layout::RowMajor, TensorInit::Uninitialized);
+    uint8_t* qp = static_cast<uint8_t*>(q.data());
+    std::vector<float> row(N);
+    for (size_t k = 0; k < K; ++k) {
+        for (size_t n = 0; n < N; ++n) row[n] = w[k * N + n] * inv[per_channel ? n : 0];
+        convert_fp32_to_fp8(row.data(), qp + k * N, N, format);
+    }
+    out.data = (layout == Layout::RowMajor) ? std::move(q) : q.to_layout(layout);
+    return out;
+}
+
+std::vector<float> Fp8Weights::column_scales() const {
+    if (data.dtype() != DataType::FP8_E4M3 && data.dtype() != DataType::FP8_E5M2) {
+        throw std::invalid_argument("Fp8Weights: data must be FP8_E4M3 or FP8_E5M2");
+    }
+    if (scales.size() != 1 && scales.size() != data.cols()) {
+        throw std::invalid_argument("Fp8Weights: expected 1 (per-tensor) or N (per-channel) scales");
+    }
+    std::vector<float> out(data.cols());
+    for (size_t n = 0; n < out.size(); ++n) out[n] = scale(n);
+    return out;
+}
+
+Tensor Fp8Weights::dequantize() const {
+    const std::vector<float> s = column_scales();
+    const size_t K = data.rows(), N = data.cols();
+    const Tensor rm = data.layout() == Layout::RowMajor ? data : data.to_layout(Layout::RowMajor);
+    Tensor out(K, N, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    float* o = out.data_as_fp32();
+    convert_fp8_to_fp32(static_cast<const uint8_t*>(rm.data()), o, K * N, data.dtype());
+    for (size_t k = 0; k < K; ++k) {
+        for (size_t n = 0; n < N; ++n) o[k * N + n] *= s[n];
+    }
+    return out;
+}
+
+} // namespace softaccelnpu
@@ -1,63 +1,436 @@
 #include "softaccelnpu/gguf_loader.h"
+#include "softaccelnpu/half.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <cstring>
+#include <sstream>
+#include <stdexcept>
 
 namespace softaccelnpu {
 
+namespace {
+
+constexpr uint32_t GGUF_MIN_VERSION = 2;
+constexpr uint32_t GGUF_MAX_VERSION = 3;
+constexpr size_t HEADER_CHUNK = 4 << 20;  // First read; covers the header of most models
+constexpr int MAX_ARRAY_DEPTH = 8;
+constexpr uint32_t MAX_DIMS = 8;
+
+struct GgmlTypeTraits {
+    const char* name;
+    uint32_t block_size;  // Elements per block
+    uint32_t type_size;   // Bytes per block
+};
+
+// Indexed by ggml type id; ids 4 and 5 (Q4_2, Q4_3) were removed from ggml
+constexpr GgmlTypeTraits GGML_TYPES[] = {
+    {"F32", 1, 4},        {"F16", 1, 2},        {"Q4_0", 32, 18},     {"Q4_1", 32, 20},
+    {nullptr, 0, 0},      {nullptr, 0, 0},      {"Q5_0", 32, 22},     {"Q5_1", 32, 24},
+    {"Q8_0", 32, 34},     {"Q8_1", 32, 36},     {"Q2_K", 256, 84},    {"Q3_K", 256, 110},
+    {"Q4_K", 256, 144},   {"Q5_K", 256, 176},   {"Q6_K", 256, 210},   {"Q8_K", 256, 292},
+    {"IQ2_XXS", 256, 66}, {"IQ2_XS", 256, 74},  {"IQ3_XXS", 256, 98}, {"IQ1_S", 256, 50},
+    {"IQ4_NL", 32, 18},   {"IQ3_S", 256, 110},  {"IQ2_S", 256, 82},   {"IQ4_XS", 256, 136},
+    {"I8", 1, 1},         {"I16", 1, 2},        {"I32", 1, 4},        {"I64", 1, 8},
+    {"F64", 1, 8},        {"IQ1_M", 256, 56},   {"BF16", 1, 2},
+};
+constexpr uint32_t GGML_TYPE_COUNT = sizeof(GGML_TYPES) / sizeof(GGML_TYPES[0]);
+
+const char* gguf_type_name(GgufType t) {
+    static const char* names[] = {"u8", "i8", "u16", "i16", "u32", "i32", "f32", "bool", "string", "array", "u64", "i64", "f64"};
+    const auto i = static_cast<uint32_t>(t);
+    return i < sizeof(names) / sizeof(names[0]) ? names[i] : "?";
+}
+
+/** Fixed size of a scalar value type; 0 for STRING / ARRAY, which are variable. */
+size_t scalar_size(GgufType t) {
+    switch (t) {
+        case GgufType::UINT8: case GgufType::INT8: case GgufType::BOOL: return 1;
+        case GgufType::UINT16: case GgufType::INT16: return 2;
+        case GgufType::UINT32: case GgufType::INT32: case GgufType::FLOAT32: return 4;
+        case GgufType::UINT64: case GgufType::INT64: case GgufType::FLOAT64: return 8;
+        default: return 0;
+    }
+}
+
+/**
+ * Little-endian cursor over the file's header region. The region is held in one buffer
+ * that starts at file offset 0 and grows with large reads when the cursor runs past it.
+ */
+class HeaderReader {
+public:
+    HeaderReader(std::ifstream& file, uint64_t file_size) : file_(file), file_size_(file_size) {}
+
+    uint64_t position() const { return pos_; }
+    uint64_t remaining() const { return file_size_ - pos_; }
+    const std::string& error() const { return error_; }
+
+    bool fail(const std::string& msg) {
+        if (error_.empty()) error_ = msg + " (at byte " + std::to_string(pos_) + ")";
+        return false;
+    }
+
+    template <typename T>
+    bool read(T& v) {
+        if (!ensure(sizeof(T))) return false;
+        std::memcpy(&v, buf_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read_string(std::string& s) {
+        uint64_t len = 0;
+        if (!read(len)) return false;
+        if (len > remaining()) return fail("string length " + std::to_string(len) + " exceeds the file");
+        if (!ensure(static_cast<size_t>(len))) return false;
+        s.assign(reinterpret_cast<const char*>(buf_.data() + pos_), static_cast<size_t>(len));
+        pos_ += len;
+        return true;
+    }
+
+private:
+    bool ensure(size_t n) {
+        if (pos_ + n <= buf_.size()) return true;
+        if (n > remaining()) return fail("unexpected end of file");
+        // Grow geometrically so a huge vocabulary costs a handful of reads, not thousands
+        const uint64_t want = std::max<uint64_t>({pos_ + n, buf_.size() * 2, HEADER_CHUNK});
+        const size_t old = buf_.size();
+        const size_t target = static_cast<size_t>(std::min<uint64_t>(want, file_size_));
+        buf_.resize(target);
+        file_.seekg(static_cast<std::streamoff>(old));
+        file_.read(reinterpret_cast<char*>(buf_.data() + old), static_cast<std::streamsize>(target - old));
+        if (static_cast<size_t>(file_.gcount()) != target - old) return fail("read error");
+        return true;
+    }
+
+    std::ifstream& file_;
+    uint64_t file_size_;
+    std::vector<uint8_t> buf_;
+    uint64_t pos_ = 0;
+    std::string error_;
+};
+
+bool is_integer(GgufType t) {
+    switch (t) {
+        case GgufType::UINT8: case GgufType::INT8: case GgufType::UINT16: case GgufType::INT16:
+        case GgufType::UINT32: case GgufType::INT32: case GgufType::UINT64: case GgufType::INT64: return true;
+        default: return false;
+    }
+}
+
+bool is_signed(GgufType t) {
+    return t == GgufType::INT8 || t == GgufType::INT16 || t == GgufType::INT32 || t == GgufType::INT64;
+}
+
+/** Float values also fill the integer views, truncated; NaN and out-of-range values leave them 0. */
+void set_float(GgufValue& v, double x) {
+    v.f64 = x;
+    if (std::isfinite(x) && std::fabs(x) < 9.2e18) {
+        v.i64 = static_cast<int64_t>(x);
+        v.u64 = static_cast<uint64_t>(v.i64);
+    }
+}
+
+bool read_value(HeaderReader& in, GgufType type, GgufValue& v, int depth) {
+    v.type = type;
+    switch (type) {
+        case GgufType::UINT8: { uint8_t x; if (!in.read(x)) return false; v.u64 = x; v.i64 = x; v.f64 = x; return true; }
+        case GgufType::INT8: { int8_t x; if (!in.read(x)) return false; v.i64 = x; v.u64 = static_cast<uint64_t>(x); v.f64 = x; return true; }
+        case GgufType::UINT16: { uint16_t x; if (!in.read(x)) return false; v.u64 = x; v.i64 = x; v.f64 = x; return true; }
+        case GgufType::INT16: { int16_t x; if (!in.read(x)) return false; v.i64 = x; v.u64 = static_cast<uint64_t>(x); v.f64 = x; return true; }
+        case GgufType::UINT32: { uint32_t x; if (!in.read(x)) return false; v.u64 = x; v.i64 = x; v.f64 = x; return true; }
+        case GgufType::INT32: { int32_t x; if (!in.read(x)) return false; v.i64 = x; v.u64 = static_cast<uint64_t>(x); v.f64 = x; return true; }
+        case GgufType::UINT64: { uint64_t x; if (!in.read(x)) return false; v.u64 = x; v.i64 = static_cast<int64_t>(x); v.f64 = static_cast<double>(x); return true; }
+        case GgufType::INT64: { int64_t x; if (!in.read(x)) return false; v.i64 = x; v.u64 = static_cast<uint64_t>(x); v.f64 = static_cast<double>(x); return true; }
+        case GgufType::FLOAT32: { float x; if (!in.read(x)) return false; set_float(v, x); return true; }
+        case GgufType::FLOAT64: { double x; if (!in.read(x)) return false; set_float(v, x); return true; }
+        case GgufType::BOOL: {
+            uint8_t x;
+            if (!in.read(x)) return false;
+            if (x > 1) return in.fail("invalid bool value " + std::to_string(x));
+            v.u64 = v.i64 = x; v.f64 = x;
+            return true;
+        }
+        case GgufType::STRING: return in.read_string(v.str);
+        case GgufType::ARRAY: {
+            if (depth >= MAX_ARRAY_DEPTH) return in.fail("arrays nested too deeply");
+            uint32_t elem_type = 0;
+            uint64_t count = 0;
+            if (!in.read(elem_type) || !in.read(count)) return false;
+            if (elem_type > static_cast<uint32_t>(GgufType::FLOAT64)) return in.fail("invalid array element type " + std::to_string(elem_type));
+            v.array_type = static_cast<GgufType>(elem_type);
+            // Every element takes at least one byte (8 for a string length), so a count past
+            // the remaining bytes is corrupt and must not drive the allocation below
+            const size_t min_size = v.array_type == GgufType::STRING ? 8 : std::max<size_t>(1, scalar_size(v.array_type));
+            if (count > in.remaining() / min_size) return in.fail("array of " + std::to_string(count) + " elements exceeds the file");
+            v.array.resize(static_cast<size_t>(count));
+            for (auto& e : v.array) {
+                if (!read_value(in, v.array_type, e, depth + 1)) return false;
+            }
+            return true;
+        }
+    }
+    return in.fail("invalid value type " + std::to_string(static_cast<uint32_t>(type)));
+}
+
+} // namespace
+
+std::string GgufValue::to_string() const {
+    std::ostringstream os;
+    switch (type) {
+        case GgufType::STRING: return str;
+        case GgufType::BOOL: return u64 ? "true" : "false";
+        case GgufType::FLOAT32:
+        case GgufType::FLOAT64: os << f64; return os.str();
+        case GgufType::INT8: case GgufType::INT16: case GgufType::INT32: case GgufType::INT64: return std::to_string(i64);
+        case GgufType::ARRAY:
+            if (array.size() > 8) {
+                os << "[" << gguf_type_name(array_type) << " x " << array.size() << "]";
+            } else {
+                os << "[";
+                for (size_t i = 0; i < array.size(); ++i) os << (i ? ", " : "") << array[i].to_string();
+                os << "]";
+            }
+            return os.str();
+        default: return std::to_string(u64);
+    }
+}
+
+uint64_t GgufLoader::TensorInfo::elements() const {
+    // load_header rejects shapes whose product overflows; saturate for hand-made infos
+    uint64_t n = 1;
+    for (int64_t d : shape) {
+        const uint64_t u = static_cast<uint64_t>(d);
+        if (u != 0 && n > UINT64_MAX / u) return UINT64_MAX;
+        n *= u;
+    }
+    return n;
+}
+
+std::string GgufLoader::ggml_type_name(uint32_t type) {
+    if (type < GGML_TYPE_COUNT && GGML_TYPES[type].name) return GGML_TYPES[type].name;
+    return "TYPE_" + std::to_string(type);
+}
+
+uint64_t GgufLoader::ggml_type_size(uint32_t type, uint64_t elements) {
+    if (type >= GGML_TYPE_COUNT || !GGML_TYPES[type].name) return 0;
+    const GgmlTypeTraits& t = GGML_TYPES[type];
+    const uint64_t blocks = elements / t.block_size + (elements % t.block_size != 0);
+    return blocks > UINT64_MAX / t.type_size ? UINT64_MAX : blocks * t.type_size;
+}
+
 bool GgufLoader::load_header(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
+    metadata_ = ModelMetadata{};
+    path_.clear();
+    mapping_.reset();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::cerr << "[GGUF] Error: Could not open file " << path << std::endl;
         return false;
     }
-
-    // 1. Read Magic (4 bytes)
-    char magic[4];
-    file.read(magic, 4);
-    if (std::memcmp(magic, "GGUF", 4) != 0) {
-        std::cerr << "[GGUF] Error: Not a valid GGUF file." << std::endl;
+    metadata_.file_size = static_cast<uint64_t>(file.tellg());
+    HeaderReader in(file, metadata_.file_size);
+    auto error = [&](const std::string& msg) {
+        std::cerr << "[GGUF] Error: " << path << ": " << msg << (in.error().empty() ? "" : ": " + in.error()) << std::endl;
+        metadata_ = ModelMetadata{};
         return false;
+    };
+
+    // 1. Fixed header: magic, version, tensor and KV counts
+    char magic[4] = {};
+    if (!in.read(magic) || std::memcmp(magic, "GGUF", 4) != 0) return error("not a GGUF file");
+    uint32_t version = 0;
+    if (!in.read(version)) return error("truncated header");
+    if (version < GGUF_MIN_VERSION || version > GGUF_MAX_VERSION) {
+        return error("unsupported GGUF version " + std::to_string(version) + " (v2 and v3 little-endian are supported)");
+    }
+    metadata_.version = version;
+    if (!in.read(metadata_.tensor_count) || !in.read(metadata_.kv_count)) return error("truncated header");
+    // Each KV pair and tensor info takes well over 8 bytes
+    if (metadata_.kv_count > in.remaining() / 8 || metadata_.tensor_count > in.remaining() / 8) {
+        return error("tensor or KV count exceeds the file");
     }
 
-    // 2. Read Version (uint32)
-    uint32_t version;
-    file.read(reinterpret_cast<char*>(&version), 4);
-    
-    // 3. Read Counts (GGUF uses 64-bit for these)
-    file.read(reinterpret_cast<char*>(&metadata_.tensor_count), 8);
-    file.read(reinterpret_cast<char*>(&metadata_.kv_count), 8);
+    // 2. Metadata key/value pairs
+    for (uint64_t i = 0; i < metadata_.kv_count; ++i) {
+        std::string key;
+        uint32_t type = 0;
+        GgufValue value;
+        if (!in.read_string(key) || !in.read(type)) return error("truncated metadata");
+        if (!read_value(in, static_cast<GgufType>(type), value, 0)) return error("bad value for key " + key);
+        metadata_.kv_pairs[key] = value.to_string();
+        metadata_.values[key] = std::move(value);
+    }
+    metadata_.architecture = get_string("general.architecture");
+    if (const GgufValue* a = find("general.alignment")) {
+        if (!is_integer(a->type) || (is_signed(a->type) && a->i64 < 0) || a->u64 == 0 || (a->u64 & (a->u64 - 1)) != 0) {
+            return error("general.alignment must be an integer power of two");
+        }
+        metadata_.alignment = a->u64;
+    }
 
-    std::cout << "[GGUF] Detected Version: " << version 
-              << ", Tensors: " << metadata_.tensor_count 
-              << ", KV Pairs: " << metadata_.kv_count << std::endl;
+    // 3. Tensor infos
+    metadata_.tensors.resize(static_cast<size_t>(metadata_.tensor_count));
+    for (auto& t : metadata_.tensors) {
+        uint32_t n_dims = 0;
+        if (!in.read_string(t.name) || !in.read(n_dims)) return error("truncated tensor info");
+        if (n_dims > MAX_DIMS) return error("tensor " + t.name + " has " + std::to_string(n_dims) + " dimensions");
+        t.shape.resize(n_dims);
+        uint64_t elements = 1;
+        for (auto& d : t.shape) {
+            uint64_t dim = 0;
+            if (!in.read(dim)) return error("truncated tensor info");
+            if (dim > static_cast<uint64_t>(INT64_MAX)) return error("tensor " + t.name + " has an invalid dimension");
+            if (dim != 0 && elements > UINT64_MAX / dim) return error("tensor " + t.name + " has too many elements");
+            elements *= dim;
+            d = static_cast<int64_t>(dim);
+        }
+        if (!in.read(t.ggml_type) || !in.read(t.offset)) return error("truncated tensor info");
+        t.type = ggml_type_name(t.ggml_type);
+        t.size_bytes = ggml_type_size(t.ggml_type, elements);
+        if (t.offset % metadata_.alignment != 0) return error("tensor " + t.name + " data is not aligned");
+    }
 
-    // Simulation limitation: We skip complex binary parsing of KV pairs for now
-    // and provide dummy data to demonstrate the capability.
-    metadata_.architecture = "llama";
-    
-    // Fill dummy tensors based on count
-    // Capped at 32 for stability in simulation
-    uint64_t actual_tensors = std::min(metadata_.tensor_count, (uint64_t)32);
-    for(uint64_t i=0; i < actual_tensors; ++i) {
-        TensorInfo info;
-        info.name = "blk." + std::to_string(i) + ".attn_q.weight";
-        info.shape = {4096, 4096};
-        info.type = "Q4_0";
-        metadata_.tensors.push_back(info);
+    // 4. Data section starts at the next alignment boundary
+    const uint64_t a = metadata_.alignment;
+    metadata_.data_offset = (in.position() + a - 1) / a * a;
+    for (auto& t : metadata_.tensors) {
+        // Compared as remaining bytes so neither sum can wrap around on corrupt offsets
+        const uint64_t size = metadata_.file_size;
+        if (metadata_.data_offset > size || t.offset > size - metadata_.data_offset ||
+            t.size_bytes > size - metadata_.data_offset - t.offset) {
+            return error("tensor " + t.name + " data runs past the end of the file");
+        }
+        t.data_offset = metadata_.data_offset + t.offset;
     }
 
+    path_ = path;
+    std::cout << "[GGUF] Detected Version: " << version
+              << ", Tensors: " << metadata_.tensor_count
+              << ", KV Pairs: " << metadata_.kv_count << std::endl;
+    return true;
+}
+
+bool GgufLoader::map_weights(const MapOptions& options) {
+    if (path_.empty()) {
+        std::cerr << "[GGUF] Error: map_weights called before a successful load_header" << std::endl;
+        return false;
+    }
+    try {
+        auto mapping = std::make_shared<const MappedFile>(path_, options);
+        // The file may have been replaced since the header was parsed
+        if (mapping->size() != metadata_.file_size) {
+            std::cerr << "[GGUF] Error: " << path_ << " changed size since its header was loaded" << std::endl;
+            return false;
+        }
+        mapping_ = std::move(mapping);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[GGUF] Error: " << e.what() << std::endl;
+        return false;
+    }
     return true;
 }
 
+const uint8_t* GgufLoader::tensor_data(const TensorInfo& info) const {
+    return mapping_ ? mapping_->data() + info.data_offset : nullptr;
+}
+
+MappedTensor GgufLoader::tensor(const std::string& name) const {
+    const TensorInfo* info = find_tensor(name);
+    if (!info) throw std::invalid_argument("GgufLoader::tensor: no tensor named " + name);
+    if (!mapping_) throw std::invalid_argument("GgufLoader::tensor: call map_weights() first");
+
+    DataType dtype;
+    switch (info->ggml_type) {
+        case 0: dtype = DataType::FP32; break;
+        case 1: dtype = DataType::FP16; break;
+        case 24: dtype = DataType::INT8; break;
+        case 30: dtype = DataType::BF16; break;
+        default:
+            throw std::invalid_argument("GgufLoader::tensor: " + name + " is " + info->type +
+                                        ", which has no Tensor dtype; use tensor_data()");
+    }
+    const size_t cols = info->shape.empty() ? 1 : static_cast<size_t>(info->shape[0]);
+    size_t rows = 1;
+    for (size_t d = 1; d < info->shape.size(); ++d) rows *= static_cast<size_t>(info->shape[d]);
+    // Tensor has no const storage; MappedTensor only hands it out as const
+    return MappedTensor(mapping_, Tensor::wrap(const_cast<uint8_t*>(tensor_data(*info)), rows, cols, dtype));
+}
+
+Tensor GgufLoader::dequantize(const std::string& name) const {
+    const TensorInfo* info = find_tensor(name);
+    if (!info) throw std::invalid_argument("GgufLoader::dequantize: no tensor named " + name);
+    if (info->ggml_type != 2 && info->ggml_type != 8) return tensor(name)->to_dtype(DataType::FP32);
+    if (!mapping_) throw std::invalid_argument("GgufLoader::dequantize: call map_weights() first");
+
+    const size_t cols = info->shape.empty() ? 1 : static_cast<size_t>(info->shape[0]);
+    if (cols % 32 != 0) throw std::invalid_argument("GgufLoader::dequantize: " + name + " rows are not whole blocks");
+    Tensor out(info->elements() / cols, cols, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    const uint8_t* src = tensor_data(*info);
+    float* dst = out.data_as_fp32();
+    uint16_t d16;
+
+    // Blocks of 32 values after an FP16 scale d: Q8_0 stores int8 q (x = d * q), Q4_0
+    // stores nibbles, value j in the low half of byte j and value j + 16 in the high half (x = d * (q - 8))
+    const size_t blocks = out.size() / 32;
+    for (size_t b = 0; b < blocks; ++b, dst += 32) {
+        std::memcpy(&d16, src, sizeof(d16));
+        const float d = fp16_to_fp32(d16);
+        if (info->ggml_type == 8) {
+            const int8_t* q = reinterpret_cast<const int8_t*>(src + 2);
+            for (size_t j = 0; j < 32; ++j) dst[j] = d * q[j];
+            src += 34;
+        } else {
+            for (size_t j = 0; j < 16; ++j) {
+                dst[j] = d * (static_cast<int>(src[2 + j] & 0x0F) - 8);
+                dst[j + 16] = d * (static_cast<int>(src[2 + j] >> 4) - 8);
+            }
+            src += 18;
+        }
+    }
+    return out;
+}
+
+const GgufValue* GgufLoader::find(const std::string& key) const {
+    auto it = metadata_.values.find(key);
+    return it == metadata_.values.end() ? nullptr : &it->second;
+}
+
+uint64_t GgufLoader::get_u64(const std::string& key, uint64_t fallback) const {
+    const GgufValue* v = find(key);
+    return (v && scalar_size(v->type) != 0) ? v->u64 : fallback;
+}
+
+std::string GgufLoader::get_string(const std::string& key, const std::string& fallback) const {
+    const GgufValue* v = find(key);
+    return (v && v->type == GgufType::STRING) ? v->str : fallback;
+}
+
+const GgufLoader::TensorInfo* GgufLoader::find_tensor(const std::string& name) const {
+    for (const auto& t : metadata_.tensors) {
+        if (t.name == name) return &t;
+    }
+    return nullptr;
+}
+
 void GgufLoader::print_summary() const {
+    uint64_t data_bytes = 0;
+    for (const auto& t : metadata_.tensors) data_bytes += t.size_bytes;
+
     std::cout << "--- GGUF Model Summary ---" << std::endl;
+    std::cout << "Version: " << metadata_.version << std::endl;
     std::cout << "Arch:    " << metadata_.architecture << std::endl;
-    std::cout << "Tensors: " << metadata_.tensor_count << std::endl;
-    if (!metadata_.tensors.empty()) {
-        std::cout << "Sample:  " << metadata_.tensors[0].name 
-                  << " (" << metadata_.tensors[0].shape[0] << "x" << metadata_.tensors[0].shape[1] << ")" 
-                  << " [" << metadata_.tensors[0].type << "]" << std::endl;
+    std::cout << "KV:      " << metadata_.kv_count << std::endl;
+    std::cout << "Tensors: " << metadata_.tensor_count << " (" << data_bytes / 1048576.0 << " MB, data at "
+              << metadata_.data_offset << ", alignment " << metadata_.alignment << ")" << std::endl;
+    const size_t shown = std::min<size_t>(metadata_.tensors.size(), 4);
+    for (size_t i = 0; i < shown; ++i) {
+        const auto& t = metadata_.tensors[i];
+        std::cout << (i ? "         " : "Sample:  ") << t.name << " (";
+        for (size_t d = 0; d < t.shape.size(); ++d) std::cout << (d ? "x" : "") << t.shape[d];
+        std::cout << ") [" << t.type << "]" << std::endl;
     }
     std::cout << "--------------------------" << std::endl;
 }
@@ -0,0 +1,171 @@
+#include "softaccelnpu/mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace softaccelnpu {
+
+namespace {
+
+std::runtime_error map_error(const std::string& path, const char* what) {
+#ifdef _WIN32
+    return std::runtime_error("MappedFile: " + std::string(what) + " " + path + " (error " + std::to_string(GetLastError()) + ")");
+#else
+    return std::runtime_error("MappedFile: " + std::string(what) + " " + path + ": " + std::strerror(errno));
+#endif
+}
+
+} // namespace
+
+const char* map_advice_name(MapAdvice advice) {
+    switch (advice) {
+        case MapAdvice::Normal: return "normal";
+        case MapAdvice::Sequential: return "sequential";
+        case MapAdvice::Random: return "random";
+        case MapAdvice::WillNeed: return "willneed";
+        case MapAdvice::DontNeed: return "dontneed";
+    }
+    return "?";
+}
+
+size_t MappedFile::page_size() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page;
+#endif
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path, const MapOptions& options) : path_(path) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | (options.advice == MapAdvice::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+                                                 options.advice == MapAdvice::Random ? FILE_FLAG_RANDOM_ACCESS : 0),
+                        nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw map_error(path, "cannot open");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        CloseHandle(file_);
+        throw map_error(path, "cannot stat");
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) return;  // CreateFileMapping rejects empty files; an empty view is fine
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        CloseHandle(file_);
+        throw map_error(path, "cannot create a mapping of");
+    }
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw map_error(path, "cannot map");
+    }
+    if (options.populate) populated_ = advise(0, size_, MapAdvice::WillNeed);
+    else if (options.advice == MapAdvice::WillNeed) advise(0, size_, MapAdvice::WillNeed);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+}
+
+bool MappedFile::advise(size_t offset, size_t bytes, MapAdvice advice) const {
+    if (!data_ || offset >= size_) return false;
+    bytes = std::min(bytes, size_ - offset);
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    // Windows only has a prefetch hint; readahead policy is fixed when the file is opened
+    if (advice != MapAdvice::WillNeed) return false;
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(data_ + offset), bytes};
+    return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+    (void)bytes;
+    (void)advice;
+    return false;
+#endif
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path, const MapOptions& options) : path_(path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw map_error(path, "cannot open");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const int err = errno;
+        ::close(fd);
+        errno = err;
+        throw map_error(path, "cannot stat");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {  // mmap rejects zero-length mappings
+        ::close(fd);
+        return;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (options.populate) flags |= MAP_POPULATE;
+#endif
+    void* p = mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+    const int err = errno;
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (p == MAP_FAILED) {
+        errno = err;
+        throw map_error(path, "cannot map");
+    }
+    data_ = static_cast<const uint8_t*>(p);
+
+#ifdef MAP_POPULATE
+    populated_ = options.populate;
+#else
+    if (options.populate) populated_ = advise(0, size_, MapAdvice::WillNeed);
+#endif
+    if (options.advice != MapAdvice::Normal) advise(0, size_, options.advice);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool MappedFile::advise(size_t offset, size_t bytes, MapAdvice advice) const {
+    if (!data_ || offset >= size_) return false;
+    const size_t page = page_size();
+    const size_t begin = offset / page * page;
+    const size_t end = std::min(size_, offset + std::min(bytes, size_ - offset));
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case MapAdvice::Normal: flag = MADV_NORMAL; break;
+        case MapAdvice::Sequential: flag = MADV_SEQUENTIAL; break;
+        case MapAdvice::Random: flag = MADV_RANDOM; break;
+        case MapAdvice::WillNeed: flag = MADV_WILLNEED; break;
+        case MapAdvice::DontNeed: flag = MADV_DONTNEED; break;
+    }
+    return madvise(const_cast<uint8_t*>(data_ + begin), end - begin, flag) == 0;
+}
+
+#endif
+
+} // namespace softaccelnpu
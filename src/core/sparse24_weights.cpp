@@ -0,0 +1,80 @@
+#include "softaccelnpu/sparse24.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+Sparse24Weights Sparse24Weights::from_dense(const Tensor& W) {
+    if (W.dtype() != DataType::FP32 || W.layout() != Layout::RowMajor) {
+        throw std::invalid_argument("Sparse24Weights::from_dense: W must be FP32 RowMajor");
+    }
+    Sparse24Weights s;
+    s.rows = W.rows();
+    s.cols = W.cols();
+    const size_t K = s.rows, N = s.cols, G = s.groups(), P = s.panels();
+    s.values.assign(P * G * 2 * PANEL, 0.0f);
+    s.indices.assign(P * G, 0);
+    const float* w = static_cast<const float*>(W.data());
+
+    for (size_t p = 0; p < P; ++p) {
+        for (size_t g = 0; g < G; ++g) {
+            float* vals = &s.values[(p * G + g) * 2 * PANEL];
+            uint64_t bits = 0;
+            for (size_t j = 0; j < PANEL; ++j) {
+                const size_t n = p * PANEL + j;
+                // Two largest magnitudes of the group; padded rows and columns read as zero
+                float v[GROUP] = {};
+                for (size_t i = 0; i < GROUP && n < N && g * GROUP + i < K; ++i) v[i] = w[(g * GROUP + i) * N + n];
+                size_t a = 0, b = 1;
+                if (std::fabs(v[b]) > std::fabs(v[a])) std::swap(a, b);
+                for (size_t i = 2; i < GROUP; ++i) {
+                    if (std::fabs(v[i]) > std::fabs(v[a])) { b = a; a = i; }
+                    else if (std::fabs(v[i]) > std::fabs(v[b])) b = i;
+                }
+                if (a > b) std::swap(a, b);  // Keep slots in k order
+                vals[j] = v[a];
+                vals[PANEL + j] = v[b];
+                bits |= static_cast<uint64_t>(a | (b << 2)) << (4 * j);
+            }
+            s.indices[p * G + g] = bits;
+        }
+    }
+    return s;
+}
+
+bool Sparse24Weights::is_sparse24(const Tensor& W) {
+    if (W.dtype() != DataType::FP32 || W.layout() != Layout::RowMajor) return false;
+    const size_t K = W.rows(), N = W.cols();
+    const float* w = static_cast<const float*>(W.data());
+    for (size_t k0 = 0; k0 < K; k0 += GROUP) {
+        for (size_t n = 0; n < N; ++n) {
+            size_t nonzeros = 0;
+            for (size_t k = k0; k < std::min(K, k0 + GROUP); ++k) nonzeros += (w[k * N + n] != 0.0f);
+            if (nonzeros > 2) return false;
+        }
+    }
+    return true;
+}
+
+Tensor Sparse24Weights::to_dense() const {
+    Tensor out(rows, cols);
+    const size_t G = groups();
+    float* o = out.data_as_fp32();
+    for (size_t p = 0; p < panels(); ++p) {
+        for (size_t g = 0; g < G; ++g) {
+            const float* vals = &values[(p * G + g) * 2 * PANEL];
+            const uint64_t bits = indices[p * G + g];
+            for (size_t j = 0; j < PANEL && p * PANEL + j < cols; ++j) {
+                const size_t nib = (bits >> (4 * j)) & 0xF;
+                const size_t k0 = g * GROUP + (nib & 3), k1 = g * GROUP + (nib >> 2);
+                if (k0 < rows) o[k0 * cols + p * PANEL + j] += vals[j];
+                if (k1 < rows) o[k1 * cols + p * PANEL + j] += vals[PANEL + j];
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,156 @@
+#include "softaccelnpu/sparse.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace softaccelnpu {
+
+namespace {
+
+void check_source(const Tensor& W, const char* who) {
+    if (W.dtype() != DataType::FP32 || W.layout() != Layout::RowMajor) {
+        throw std::invalid_argument(std::string(who) + ": W must be FP32 RowMajor");
+    }
+    if (W.rows() * W.cols() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::invalid_argument(std::string(who) + ": W is too large for 32-bit indices");
+    }
+}
+
+bool block_has_nonzero(const float* w, size_t K, size_t N, size_t k0, size_t n0) {
+    const size_t k1 = std::min(K, k0 + BsrWeights::BLOCK_K), n1 = std::min(N, n0 + BsrWeights::BLOCK_N);
+    for (size_t k = k0; k < k1; ++k)
+        for (size_t n = n0; n < n1; ++n)
+            if (w[k * N + n] != 0.0f) return true;
+    return false;
+}
+
+} // namespace
+
+CsrWeights CsrWeights::from_dense(const Tensor& W) {
+    check_source(W, "CsrWeights::from_dense");
+    CsrWeights s;
+    s.rows = W.rows();
+    s.cols = W.cols();
+    const size_t K = s.rows, N = s.cols;
+    const float* w = static_cast<const float*>(W.data());
+
+    s.ptr.assign(N + 1, 0);
+    for (size_t k = 0; k < K; ++k)
+        for (size_t n = 0; n < N; ++n) s.ptr[n + 1] += (w[k * N + n] != 0.0f);
+    for (size_t n = 0; n < N; ++n) s.ptr[n + 1] += s.ptr[n];
+
+    s.idx.resize(s.ptr[N]);
+    s.values.resize(s.ptr[N]);
+    std::vector<uint32_t> fill(s.ptr.begin(), s.ptr.end() - 1);
+    for (size_t k = 0; k < K; ++k) {
+        for (size_t n = 0; n < N; ++n) {
+            const float v = w[k * N + n];
+            if (v == 0.0f) continue;
+            s.idx[fill[n]] = static_cast<uint32_t>(k);
+            s.values[fill[n]++] = v;
+        }
+    }
+    return s;
+}
+
+Tensor CsrWeights::to_dense() const {
+    Tensor out(rows, cols);
+    float* o = out.data_as_fp32();
+    for (size_t n = 0; n < cols; ++n)
+        for (size_t i = ptr[n]; i < ptr[n + 1]; ++i) o[idx[i] * cols + n] = values[i];
+    return out;
+}
+
+BsrWeights BsrWeights::from_dense(const Tensor& W) {
+    check_source(W, "BsrWeights::from_dense");
+    BsrWeights s;
+    s.rows = W.rows();
+    s.cols = W.cols();
+    const size_t K = s.rows, N = s.cols, P = s.panels();
+    const float* w = static_cast<const float*>(W.data());
+
+    s.ptr.assign(P + 1, 0);
+    for (size_t p = 0; p < P; ++p) {
+        const size_t n0 = p * BLOCK_N;
+        for (size_t k0 = 0; k0 < K; k0 += BLOCK_K) {
+            if (!block_has_nonzero(w, K, N, k0, n0)) continue;
+            s.block_k.push_back(static_cast<uint32_t>(k0 / BLOCK_K));
+            const size_t base = s.values.size();
+            s.values.resize(base + BLOCK_K * BLOCK_N, 0.0f);
+            for (size_t i = 0; i < BLOCK_K && k0 + i < K; ++i)
+                for (size_t j = 0; j < BLOCK_N && n0 + j < N; ++j)
+                    s.values[base + i * BLOCK_N + j] = w[(k0 + i) * N + n0 + j];
+        }
+        s.ptr[p + 1] = static_cast<uint32_t>(s.block_k.size());
+    }
+    return s;
+}
+
+Tensor BsrWeights::to_dense() const {
+    Tensor out(rows, cols);
+    float* o = out.data_as_fp32();
+    for (size_t p = 0; p < panels(); ++p) {
+        for (size_t b = ptr[p]; b < ptr[p + 1]; ++b) {
+            const float* v = &values[b * BLOCK_K * BLOCK_N];
+            const size_t k0 = block_k[b] * BLOCK_K;
+            for (size_t i = 0; i < BLOCK_K && k0 + i < rows; ++i)
+                for (size_t j = 0; j < BLOCK_N && p * BLOCK_N + j < cols; ++j)
+                    o[(k0 + i) * cols + p * BLOCK_N + j] = v[i * BLOCK_N + j];
+        }
+    }
+    return out;
+}
+
+size_t SparseWeights::bytes() const {
+    switch (format) {
+        case SparseFormat::CSR: return csr.bytes();
+        case SparseFormat::BSR: return bsr.bytes();
+        default: return dense ? dense->bytes() : 0;
+    }
+}
+
+SparseWeights SparseWeights::from_dense(const Tensor& W) {
+    check_source(W, "SparseWeights::from_dense");
+    SparseWeights s;
+    s.rows = W.rows();
+    s.cols = W.cols();
+    const size_t K = s.rows, N = s.cols;
+    const float* w = static_cast<const float*>(W.data());
+
+    size_t nonzeros = 0;
+    for (size_t i = 0; i < K * N; ++i) nonzeros += (w[i] != 0.0f);
+    size_t live_blocks = 0, all_blocks = 0;
+    for (size_t k0 = 0; k0 < K; k0 += BsrWeights::BLOCK_K) {
+        for (size_t n0 = 0; n0 < N; n0 += BsrWeights::BLOCK_N) {
+            live_blocks += block_has_nonzero(w, K, N, k0, n0);
+            ++all_blocks;
+        }
+    }
+    s.density = (K * N > 0) ? static_cast<float>(nonzeros) / static_cast<float>(K * N) : 1.0f;
+    s.block_density = all_blocks ? static_cast<float>(live_blocks) / static_cast<float>(all_blocks) : 1.0f;
+
+    // Both sparse kernels beat the dense path well past these limits; the margin keeps
+    // borderline tensors on the dense path, which every other op also accepts
+    if (s.block_density <= BSR_MAX_BLOCK_DENSITY && s.block_density * BSR_COST_PER_WEIGHT <= s.density) {
+        s.format = SparseFormat::BSR;
+        s.bsr = BsrWeights::from_dense(W);
+    } else if (s.density <= CSR_MAX_DENSITY) {
+        s.format = SparseFormat::CSR;
+        s.csr = CsrWeights::from_dense(W);
+    } else {
+        s.format = SparseFormat::Dense;
+        s.dense.emplace(W);
+    }
+    return s;
+}
+
+const char* sparse_format_name(SparseFormat format) {
+    switch (format) {
+        case SparseFormat::CSR: return "CSR";
+        case SparseFormat::BSR: return "BSR";
+        default: return "Dense";
+    }
+}
+
+} // namespace softaccelnpu
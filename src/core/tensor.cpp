@@ -1,5 +1,11 @@
 #include "softaccelnpu/tensor.h"
+#include "softaccelnpu/half.h"
+#include "softaccelnpu/fp8.h"
+#include "softaccelnpu/sparsity_mask.h"
+#include <algorithm>
+#include <cstring>
 #include <random>
+#include <utility>
 
 namespace softaccelnpu {
 
@@ -7,52 +13,245 @@ size_t get_dtype_size(DataType dtype) {
     switch (dtype) {
         case DataType::FP32: return 4;
         case DataType::FP16: return 2;
+        case DataType::BF16: return 2;
+        case DataType::FP8_E4M3: return 1;
+        case DataType::FP8_E5M2: return 1;
         case DataType::INT8: return 1;
         case DataType::INT32: return 4;
         default: return 4;
     }
 }
 
-Tensor::Tensor(size_t rows, size_t cols, DataType dtype, Layout layout)
-    : rows_(rows), cols_(cols), dtype_(dtype), layout_(layout) {
-    data_.resize(rows * cols * get_dtype_size(dtype));
+namespace {
+
+// Tiled storage pads the column count up to whole panels
+size_t storage_bytes(size_t rows, size_t cols, DataType dtype, Layout layout) {
+    if (layout == Layout::Tiled) {
+        cols = (cols + Tensor::TILE_WIDTH - 1) / Tensor::TILE_WIDTH * Tensor::TILE_WIDTH;
+    }
+    return rows * cols * get_dtype_size(dtype);
+}
+
+} // namespace
+
+Tensor::Tensor(size_t rows, size_t cols, DataType dtype, Layout layout, TensorInit init, TensorAllocator* allocator)
+    : rows_(rows), cols_(cols), dtype_(dtype), layout_(layout),
+      bytes_(storage_bytes(rows, cols, dtype, layout)),
+      allocator_(allocator ? allocator : &default_tensor_allocator()) {
+    if (bytes_ == 0) return;
+    data_ = static_cast<uint8_t*>(allocator_->allocate(bytes_));
+    // Fresh mappings are already zero: skipping the memset also leaves untouched pages unfaulted
+    if (init == TensorInit::Zero && !allocator_->returns_zeroed(bytes_)) {
+        std::memset(data_, 0, bytes_);
+    }
+}
+
+Tensor::~Tensor() { release(); }
+
+Tensor Tensor::wrap(void* data, size_t rows, size_t cols, DataType dtype, Layout layout) {
+    Tensor t(0, 0, dtype, layout);
+    t.rows_ = rows;
+    t.cols_ = cols;
+    t.bytes_ = storage_bytes(rows, cols, dtype, layout);
+    t.allocator_ = nullptr;
+    t.data_ = static_cast<uint8_t*>(data);
+    return t;
+}
+
+void Tensor::release() {
+    if (data_ && allocator_) allocator_->deallocate(data_, bytes_);
+    data_ = nullptr;
+}
+
+Tensor::Tensor(const Tensor& other)
+    : Tensor(other.rows_, other.cols_, other.dtype_, other.layout_, TensorInit::Uninitialized, other.allocator_) {
+    if (bytes_) std::memcpy(data_, other.data_, bytes_);
+    sparsity_mask_ = other.sparsity_mask_;
+}
+
+Tensor::Tensor(Tensor&& other) noexcept
+    : rows_(other.rows_), cols_(other.cols_), dtype_(other.dtype_), layout_(other.layout_),
+      bytes_(other.bytes_), allocator_(other.allocator_), data_(std::exchange(other.data_, nullptr)),
+      sparsity_mask_(std::move(other.sparsity_mask_)) {
+    other.rows_ = other.cols_ = other.bytes_ = 0;
+}
+
+Tensor& Tensor::operator=(const Tensor& other) {
+    if (this != &other) *this = Tensor(other);
+    return *this;
+}
+
+Tensor& Tensor::operator=(Tensor&& other) noexcept {
+    if (this != &other) {
+        release();
+        rows_ = std::exchange(other.rows_, 0);
+        cols_ = std::exchange(other.cols_, 0);
+        dtype_ = other.dtype_;
+        layout_ = other.layout_;
+        bytes_ = std::exchange(other.bytes_, 0);
+        allocator_ = other.allocator_;
+        data_ = std::exchange(other.data_, nullptr);
+        sparsity_mask_ = std::move(other.sparsity_mask_);
+    }
+    return *this;
 }
 
 size_t Tensor::idx(size_t r, size_t c) const {
     if (layout_ == Layout::RowMajor) {
         return r * cols_ + c;
+    } else if (layout_ == Layout::Tiled) {
+        return ((c / TILE_WIDTH) * rows_ + r) * TILE_WIDTH + c % TILE_WIDTH;
     } else {
         // ColMajor
         return c * rows_ + r;
     }
 }
 
+TensorView::TensorView(void* data, size_t rows, size_t cols, size_t row_stride, size_t col_stride, DataType dtype)
+    : data_(static_cast<uint8_t*>(data)), rows_(rows), cols_(cols),
+      row_stride_(row_stride), col_stride_(col_stride), dtype_(dtype) {}
+
+Tensor Tensor::to_layout(Layout layout) const {
+    if (layout == layout_) return *this;
+
+    Tensor out(rows_, cols_, dtype_, layout, TensorInit::Zero);
+    const size_t es = get_dtype_size(dtype_);
+    const uint8_t* src = data_;
+    uint8_t* dst = out.data_;
+
+    // Panel rows are contiguous runs of a row-major row: copy TILE_WIDTH elements at a time
+    if ((layout_ == Layout::RowMajor && layout == Layout::Tiled) ||
+        (layout_ == Layout::Tiled && layout == Layout::RowMajor)) {
+        const bool to_tiled = layout == Layout::Tiled;
+        for (size_t c0 = 0; c0 < cols_; c0 += TILE_WIDTH) {
+            const size_t w = std::min(TILE_WIDTH, cols_ - c0);
+            for (size_t r = 0; r < rows_; ++r) {
+                const size_t rm = (r * cols_ + c0) * es;
+                const size_t tl = ((c0 / TILE_WIDTH) * rows_ + r) * TILE_WIDTH * es;
+                std::memcpy(dst + (to_tiled ? tl : rm), src + (to_tiled ? rm : tl), w * es);
+            }
+        }
+        return out;
+    }
+
+    for (size_t r = 0; r < rows_; ++r) {
+        for (size_t c = 0; c < cols_; ++c) {
+            std::memcpy(dst + out.idx(r, c) * es, src + idx(r, c) * es, es);
+        }
+    }
+    return out;
+}
+
+Tensor Tensor::to_dtype(DataType dtype) const {
+    if (dtype == dtype_) return *this;
+
+    // Conversion is elementwise over storage, so any layout (and Tiled padding) carries over
+    Tensor out(rows_, cols_, dtype, layout_, TensorInit::Uninitialized);
+    const size_t count = bytes_ / get_dtype_size(dtype_);
+    const float* f32 = reinterpret_cast<const float*>(data_);
+    const uint16_t* h16 = reinterpret_cast<const uint16_t*>(data_);
+    const bool fp8_in = dtype_ == DataType::FP8_E4M3 || dtype_ == DataType::FP8_E5M2;
+    const bool fp8_out = dtype == DataType::FP8_E4M3 || dtype == DataType::FP8_E5M2;
+
+    if (dtype_ == DataType::FP32 && dtype == DataType::FP16) convert_fp32_to_fp16(f32, out.data_as_half(), count);
+    else if (dtype_ == DataType::FP32 && dtype == DataType::BF16) convert_fp32_to_bf16(f32, out.data_as_half(), count);
+    else if (dtype_ == DataType::FP16 && dtype == DataType::FP32) convert_fp16_to_fp32(h16, out.data_as_fp32(), count);
+    else if (dtype_ == DataType::BF16 && dtype == DataType::FP32) convert_bf16_to_fp32(h16, out.data_as_fp32(), count);
+    else if (dtype_ == DataType::FP32 && fp8_out) convert_fp32_to_fp8(f32, static_cast<uint8_t*>(out.data()), count, dtype);
+    else if (fp8_in && dtype == DataType::FP32) convert_fp8_to_fp32(data_, out.data_as_fp32(), count, dtype_);
+    else throw std::invalid_argument("Tensor::to_dtype: only FP32 <-> FP16/BF16/FP8 conversions are supported");
+    return out;
+}
+
+// A mutable view may be written (GEMM outputs), so take the pointer through the accessor
+// that drops the tensor's sparsity mask
+TensorView::TensorView(Tensor& tensor) : TensorView(static_cast<const Tensor&>(tensor)) {
+    data_ = static_cast<uint8_t*>(tensor.data());
+}
+
+TensorView::TensorView(const Tensor& tensor)
+    : data_(static_cast<uint8_t*>(const_cast<void*>(tensor.data()))), rows_(tensor.rows()), cols_(tensor.cols()),
+      row_stride_(tensor.layout() == Layout::ColMajor ? 1 : tensor.cols()),
+      col_stride_(tensor.layout() == Layout::ColMajor ? tensor.rows() : 1),
+      dtype_(tensor.dtype()) {
+    if (tensor.layout() == Layout::Tiled) {
+        throw std::invalid_argument("TensorView: Layout::Tiled tensors have no strided view");
+    }
+}
+
+TensorView TensorView::block(size_t r0, size_t c0, size_t rows, size_t cols) const {
+    if (r0 + rows > rows_ || c0 + cols > cols_) {
+        throw std::out_of_range("TensorView::block: range exceeds the view");
+    }
+    const size_t offset = (r0 * row_stride_ + c0 * col_stride_) * get_dtype_size(dtype_);
+    return TensorView(data_ + offset, rows, cols, row_stride_, col_stride_, dtype_);
+}
+
+TensorView TensorView::transposed() const {
+    return TensorView(data_, cols_, rows_, col_stride_, row_stride_, dtype_);
+}
+
 void Tensor::fill(float value) {
+    drop_sparsity_mask();
+    // Tiled padding stays zero; every other layout is filled as one flat range
+    const bool tiled = layout_ == Layout::Tiled;
     if (dtype_ == DataType::FP32) {
         float* p = data_as_fp32();
-        std::fill(p, p + size(), value);
+        if (!tiled) std::fill(p, p + size(), value);
+        else for (size_t i = 0; i < size(); ++i) p[idx(i / cols_, i % cols_)] = value;
     } else if (dtype_ == DataType::INT8) {
         int8_t* p = data_as_int8();
-        std::fill(p, p + size(), static_cast<int8_t>(value));
+        if (!tiled) std::fill(p, p + size(), static_cast<int8_t>(value));
+        else for (size_t i = 0; i < size(); ++i) p[idx(i / cols_, i % cols_)] = static_cast<int8_t>(value);
+    } else if (dtype_ == DataType::FP16 || dtype_ == DataType::BF16) {
+        const uint16_t bits = (dtype_ == DataType::FP16) ? fp32_to_fp16(value) : fp32_to_bf16(value);
+        uint16_t* p = data_as_half();
+        if (!tiled) std::fill(p, p + size(), bits);
+        else for (size_t i = 0; i < size(); ++i) p[idx(i / cols_, i % cols_)] = bits;
+    } else if (dtype_ == DataType::FP8_E4M3 || dtype_ == DataType::FP8_E5M2) {
+        const uint8_t bits = (dtype_ == DataType::FP8_E4M3) ? fp32_to_fp8_e4m3(value) : fp32_to_fp8_e5m2(value);
+        if (!tiled) std::fill(data_, data_ + size(), bits);
+        else for (size_t i = 0; i < size(); ++i) data_[idx(i / cols_, i % cols_)] = bits;
     }
 }
 
 void Tensor::randomize() {
+    drop_sparsity_mask();
     static std::mt19937 gen(42);
+    // Only logical elements are drawn, so Tiled padding stays zero
+    auto slot = [&](size_t i) { return layout_ == Layout::Tiled ? idx(i / cols_, i % cols_) : i; };
     
     if (dtype_ == DataType::FP32) {
         std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
         float* p = data_as_fp32();
         for (size_t i = 0; i < size(); ++i) {
-            p[i] = dis(gen);
+            p[slot(i)] = dis(gen);
         }
     } else if (dtype_ == DataType::INT8) {
         std::uniform_int_distribution<int> dis(-127, 127);
         int8_t* p = data_as_int8();
         for (size_t i = 0; i < size(); ++i) {
-            p[i] = static_cast<int8_t>(dis(gen));
+            p[slot(i)] = static_cast<int8_t>(dis(gen));
+        }
+    } else if (dtype_ == DataType::FP16 || dtype_ == DataType::BF16) {
+        std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+        uint16_t* p = data_as_half();
+        for (size_t i = 0; i < size(); ++i) {
+            const float v = dis(gen);
+            p[slot(i)] = (dtype_ == DataType::FP16) ? fp32_to_fp16(v) : fp32_to_bf16(v);
+        }
+    } else if (dtype_ == DataType::FP8_E4M3 || dtype_ == DataType::FP8_E5M2) {
+        std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+        for (size_t i = 0; i < size(); ++i) {
+            const float v = dis(gen);
+            data_[slot(i)] = (dtype_ == DataType::FP8_E4M3) ? fp32_to_fp8_e4m3(v) : fp32_to_fp8_e5m2(v);
         }
     }
 }
 
+const SparsityMask& Tensor::build_sparsity_mask(size_t block_rows, size_t block_cols) {
+    sparsity_mask_ = std::make_shared<const SparsityMask>(generate_sparsity_mask(*this, block_rows, block_cols));
+    return *sparsity_mask_;
+}
+
 } // namespace softaccelnpu
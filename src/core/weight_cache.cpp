@@ -0,0 +1,301 @@
+#include "softaccelnpu/weight_cache.h"
+#include "softaccelnpu/gguf_loader.h"
+#include "../kernels/internal_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'S', 'A', 'N', 'P', 'U', 'W', 'C', '\0'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t model_hash;
+    uint64_t tiling[5];      // kc, mc, nc, mr, nr
+    char isa[64];            // NUL-padded micro-kernel name
+    uint64_t index_bytes;    // The index directly follows the header
+    uint64_t data_offset;
+    uint64_t file_size;
+};
+static_assert(sizeof(FileHeader) == 152, "FileHeader must have no padding");
+
+size_t align_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+FileHeader make_header(const WeightCacheKey& key) {
+    FileHeader h{};
+    std::memcpy(h.magic, CACHE_MAGIC, sizeof(h.magic));
+    h.version = PackedWeightCache::FORMAT_VERSION;
+    h.model_hash = key.model_hash;
+    const GemmTiling& t = key.tiling;
+    const uint64_t tiling[5] = {t.kc, t.mc, t.nc, t.mr, t.nr};
+    std::memcpy(h.tiling, tiling, sizeof(tiling));
+    std::strncpy(h.isa, key.isa.c_str(), sizeof(h.isa) - 1);
+    return h;
+}
+
+template <typename T>
+void put(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+/** Bounds-checked reader over the mapped index. */
+struct IndexReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    template <typename T>
+    bool get(T& v) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+uint64_t fnv1a(uint64_t h, const void* data, size_t n) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * FNV_PRIME;
+    return h;
+}
+
+constexpr size_t HASH_WINDOW = 64;               // Bytes hashed per sample
+constexpr size_t HASH_STRIDE = size_t{1} << 20;  // One sample per MiB of tensor data
+
+// Distinct per process and per call, so concurrent writers of one cache never share a temp file
+std::string temp_path(const std::string& path) {
+    static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+    const long pid = _getpid();
+#else
+    const long pid = static_cast<long>(getpid());
+#endif
+    return path + ".tmp." + std::to_string(pid) + "." + std::to_string(counter++);
+}
+
+} // namespace
+
+WeightCacheKey WeightCacheKey::current(uint64_t model_hash) {
+    WeightCacheKey key;
+    key.model_hash = model_hash;
+    std::unique_ptr<MicroKernel> kernel(create_best_kernel());
+    key.isa = kernel ? kernel->name() : "none";
+    key.tiling = GemmOps::tiling();
+    return key;
+}
+
+void PackedWeightCache::write(const std::string& path, const WeightCacheKey& key, const Entries& entries) {
+    FileHeader h = make_header(key);
+    h.entry_count = static_cast<uint32_t>(entries.size());
+
+    // Index first, so the data offsets can be assigned once its size is known
+    std::string index;
+    size_t data_bytes = 0;
+    std::vector<uint64_t> offsets;
+    std::set<std::string> seen;
+    for (const auto& e : entries) {
+        if (!seen.insert(e.first).second) throw std::invalid_argument("PackedWeightCache::write: duplicate entry " + e.first);
+        offsets.push_back(data_bytes);
+        data_bytes = align_up(data_bytes + e.second.bytes(), TensorAllocator::ALIGNMENT);
+        put(index, static_cast<uint32_t>(e.first.size()));
+        index += e.first;
+        put(index, static_cast<uint32_t>(e.second.dtype()));
+        put(index, static_cast<uint32_t>(e.second.layout()));
+        put(index, static_cast<uint64_t>(e.second.rows()));
+        put(index, static_cast<uint64_t>(e.second.cols()));
+        put(index, uint64_t{0});  // Offset, patched below
+        put(index, static_cast<uint64_t>(e.second.bytes()));
+    }
+    h.index_bytes = index.size();
+    h.data_offset = align_up(sizeof(FileHeader) + index.size(), TensorAllocator::ALIGNMENT);
+    h.file_size = h.data_offset + data_bytes;
+
+    // Patch absolute offsets: each record ends with (offset, bytes)
+    size_t pos = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        pos += sizeof(uint32_t) + entries[i].first.size() + 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        const uint64_t abs = h.data_offset + offsets[i];
+        std::memcpy(&index[pos], &abs, sizeof(abs));
+        pos += 2 * sizeof(uint64_t);
+    }
+
+    const std::string tmp = temp_path(path);
+    {
+        // A failed rebuild must not leave a partial (possibly multi-GB) temporary file behind
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("PackedWeightCache: cannot create " + tmp);
+        }
+        const char zeros[TensorAllocator::ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(index.data(), static_cast<std::streamsize>(index.size()));
+        out.write(zeros, static_cast<std::streamsize>(h.data_offset - sizeof(h) - index.size()));
+        for (const auto& e : entries) {
+            const size_t n = e.second.bytes();
+            out.write(static_cast<const char*>(e.second.data()), static_cast<std::streamsize>(n));
+            out.write(zeros, static_cast<std::streamsize>(align_up(n, TensorAllocator::ALIGNMENT) - n));
+        }
+        out.close();  // Flushes, so a full disk is reported here rather than lost in the destructor
+        if (!out) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("PackedWeightCache: write to " + tmp + " failed");
+        }
+    }
+#ifdef _WIN32
+    std::remove(path.c_str());  // rename does not replace existing files on Windows
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("PackedWeightCache: cannot rename " + tmp + " to " + path);
+    }
+}
+
+bool PackedWeightCache::open(const std::string& path, const WeightCacheKey& key) {
+    mapping_.reset();
+    index_.clear();
+    auto fail = [&](const std::string& why) {
+        status_ = why;
+        index_.clear();
+        return false;
+    };
+
+    std::shared_ptr<const MappedFile> file;
+    try {
+        file = std::make_shared<const MappedFile>(path);
+    } catch (const std::runtime_error&) {
+        return fail("no cache at " + path);
+    }
+
+    FileHeader h;
+    if (file->size() < sizeof(h)) return fail("truncated cache file");
+    std::memcpy(&h, file->data(), sizeof(h));
+    if (std::memcmp(h.magic, CACHE_MAGIC, sizeof(h.magic)) != 0) return fail("not a packed weight cache");
+    if (h.version != FORMAT_VERSION) return fail("cache format version " + std::to_string(h.version));
+    if (h.file_size != file->size()) return fail("truncated cache file");
+    if (h.index_bytes > h.file_size - sizeof(h) || h.data_offset > h.file_size) return fail("corrupt cache header");
+
+    // Stale when anything the packing depended on has changed
+    const FileHeader want = make_header(key);
+    if (h.model_hash != want.model_hash) return fail("model changed");
+    if (std::memcmp(h.isa, want.isa, sizeof(h.isa)) != 0) {
+        return fail("packed for kernel " + std::string(h.isa, strnlen(h.isa, sizeof(h.isa))) + ", running " + key.isa);
+    }
+    if (std::memcmp(h.tiling, want.tiling, sizeof(h.tiling)) != 0) return fail("tiling changed");
+
+    IndexReader in{file->data() + sizeof(h), file->data() + sizeof(h) + h.index_bytes};
+    for (uint32_t i = 0; i < h.entry_count; ++i) {
+        uint32_t name_len = 0, dtype = 0, layout = 0;
+        uint64_t rows = 0, cols = 0;
+        Entry e{};
+        if (!in.get(name_len) || static_cast<size_t>(in.end - in.p) < name_len) return fail("corrupt cache index");
+        std::string name(reinterpret_cast<const char*>(in.p), name_len);
+        in.p += name_len;
+        if (!in.get(dtype) || !in.get(layout) || !in.get(rows) || !in.get(cols) || !in.get(e.offset) || !in.get(e.bytes)) {
+            return fail("corrupt cache index");
+        }
+        if (dtype > static_cast<uint32_t>(DataType::FP8_E5M2) || layout > static_cast<uint32_t>(Layout::Tiled) ||
+            e.offset < h.data_offset || e.offset > h.file_size || e.bytes > h.file_size - e.offset) {
+            return fail("corrupt cache entry " + name);
+        }
+        e.dtype = static_cast<DataType>(dtype);
+        e.layout = static_cast<Layout>(layout);
+        e.rows = static_cast<size_t>(rows);
+        e.cols = static_cast<size_t>(cols);
+        if (!index_.emplace(name, e).second) return fail("corrupt cache index: duplicate entry " + name);
+    }
+
+    mapping_ = std::move(file);
+    status_ = "loaded " + std::to_string(index_.size()) + " packed weights from " + path;
+    return true;
+}
+
+bool PackedWeightCache::load_or_build(const std::string& path, const WeightCacheKey& key, const Builder& build) {
+    if (open(path, key)) return true;
+    std::cout << "[WeightCache] Rebuilding " << path << " (" << status_ << ")" << std::endl;
+    write(path, key, build());
+    if (!open(path, key)) throw std::runtime_error("PackedWeightCache: rebuilt cache is unreadable: " + status_);
+    return false;
+}
+
+std::vector<std::string> PackedWeightCache::names() const {
+    std::vector<std::string> out;
+    out.reserve(index_.size());
+    for (const auto& e : index_) out.push_back(e.first);
+    return out;
+}
+
+Tensor PackedWeightCache::get(const std::string& name) const {
+    if (!mapping_) throw std::invalid_argument("PackedWeightCache::get: cache is not open");
+    auto it = index_.find(name);
+    if (it == index_.end()) throw std::invalid_argument("PackedWeightCache::get: no entry named " + name);
+    const Entry& e = it->second;
+    // Tensor has no const storage; a write through it faults on the read-only mapping
+    Tensor t = Tensor::wrap(const_cast<uint8_t*>(mapping_->data() + e.offset), e.rows, e.cols, e.dtype, e.layout);
+    if (t.bytes() != e.bytes) throw std::invalid_argument("PackedWeightCache::get: entry " + name + " has a bad size");
+    return t;
+}
+
+uint64_t PackedWeightCache::model_hash(const GgufLoader& loader) {
+    const auto mapping = loader.mapping();
+    if (!mapping) throw std::invalid_argument("PackedWeightCache::model_hash: call GgufLoader::map_weights() first");
+    const auto& meta = loader.get_metadata();
+    uint64_t h = FNV_OFFSET;
+    h = fnv1a(h, &meta.file_size, sizeof(meta.file_size));
+    // A rewritten file gets a new mtime even when every sampled byte happens to match
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(mapping->path(), ec).time_since_epoch().count();
+    if (!ec) h = fnv1a(h, &mtime, sizeof(mtime));
+    h = fnv1a(h, mapping->data(), static_cast<size_t>(std::min<uint64_t>(meta.data_offset, mapping->size())));
+    for (const auto& t : meta.tensors) {
+        const size_t bytes = static_cast<size_t>(t.size_bytes);
+        const uint8_t* p = loader.tensor_data(t);
+        for (size_t pos = 0; pos < bytes; pos += HASH_STRIDE) h = fnv1a(h, p + pos, std::min(HASH_WINDOW, bytes - pos));
+        const size_t n = std::min(HASH_WINDOW, bytes);
+        h = fnv1a(h, p + bytes - n, n);
+    }
+    return h;
+}
+
+PackedWeightCache::Entries PackedWeightCache::pack_gguf(const GgufLoader& loader, LoadStats* stats) {
+    if (!loader.mapping()) throw std::invalid_argument("PackedWeightCache::pack_gguf: call GgufLoader::map_weights() first");
+    std::vector<LoadTask> tasks;
+    std::vector<MappedTensor> sources;
+    Entries out;
+    for (const auto& t : loader.get_metadata().tensors) {
+        if (t.shape.size() != 2 || !(t.type == "F32" || t.type == "F16" || t.type == "BF16")) continue;
+        sources.push_back(loader.tensor(t.name));  // [out x in], row-major
+        const Tensor& W = *sources.back();
+        tasks.push_back({t.name, static_cast<size_t>(t.data_offset), W.bytes()});
+        out.emplace_back(t.name, Tensor(W.cols(), W.rows(), DataType::FP32, Layout::Tiled, TensorInit::Uninitialized));
+    }
+
+    const LoadStats s = LoadPipeline(loader.mapping()).run(tasks, [&](size_t i) {
+        const Tensor& W = *sources[i];
+        Tensor& B = out[i].second;
+        pack_B_transposed(W.data(), W.dtype(), W.rows(), W.cols(), B.data_as_fp32());
+        return B.bytes();
+    });
+    if (stats) *stats = s;
+    return out;
+}
+
+} // namespace softaccelnpu
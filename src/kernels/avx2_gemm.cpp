@@ -1,4 +1,5 @@
 #include "../kernels/internal_kernels.h"
+#include "avx2_math.h"
 #include "softaccelnpu/ops.h"
 #include "softaccelnpu/power_model.h"
 #include "softaccelnpu/cache_model.h"
@@ -60,6 +61,93 @@ void micro_kernel_6x16(const float* A, const float* B, float* C, size_t K, size_
     }
 }
 
+/**
+ * @brief Rx16 register tile (R <= 6) with masked loads/stores for n < 16 columns.
+ *
+ * Same rank-1 update scheme as micro_kernel_6x16, but usable on the ragged
+ * edges of a block so callers never fall back to scalar code.
+ */
+template <int R>
+static void micro_kernel_rx16(const float* A, const float* B, float* C, size_t n, size_t K, size_t lda, size_t ldb, size_t ldc) {
+    // Short tiles (decode-shaped GEMV) keep U independent accumulator sets over k
+    // so the FMA latency chain does not serialize the loop.
+    constexpr int U = (R == 1) ? 4 : (R == 2 ? 2 : 1);
+    __m256 c[U][R][2];
+    const bool full = (n == 16);
+    const __m256i m0 = avx2_tail_mask(n > 8 ? 8 : n);
+    const __m256i m1 = avx2_tail_mask(n > 8 ? n - 8 : 0);
+
+    for (int i = 0; i < R; ++i) {
+        if (full) {
+            c[0][i][0] = _mm256_loadu_ps(C + i * ldc + 0);
+            c[0][i][1] = _mm256_loadu_ps(C + i * ldc + 8);
+        } else {
+            c[0][i][0] = _mm256_maskload_ps(C + i * ldc + 0, m0);
+            c[0][i][1] = _mm256_maskload_ps(C + i * ldc + 8, m1);
+        }
+        for (int u = 1; u < U; ++u) {
+            c[u][i][0] = _mm256_setzero_ps();
+            c[u][i][1] = _mm256_setzero_ps();
+        }
+    }
+
+    auto step = [&](int u, size_t k) {
+        __m256 b0, b1;
+        if (full) {
+            b0 = _mm256_loadu_ps(B + k * ldb + 0);
+            b1 = _mm256_loadu_ps(B + k * ldb + 8);
+        } else {
+            b0 = _mm256_maskload_ps(B + k * ldb + 0, m0);
+            b1 = _mm256_maskload_ps(B + k * ldb + 8, m1);
+        }
+        for (int i = 0; i < R; ++i) {
+            __m256 a = _mm256_set1_ps(A[i * lda + k]);
+            c[u][i][0] = _mm256_fmadd_ps(a, b0, c[u][i][0]);
+            c[u][i][1] = _mm256_fmadd_ps(a, b1, c[u][i][1]);
+        }
+    };
+
+    size_t k = 0;
+    for (; k + U <= K; k += U) {
+        for (int u = 0; u < U; ++u) step(u, k + u);
+    }
+    for (; k < K; ++k) step(0, k);
+
+    for (int i = 0; i < R; ++i) {
+        for (int u = 1; u < U; ++u) {
+            c[0][i][0] = _mm256_add_ps(c[0][i][0], c[u][i][0]);
+            c[0][i][1] = _mm256_add_ps(c[0][i][1], c[u][i][1]);
+        }
+        if (full) {
+            _mm256_storeu_ps(C + i * ldc + 0, c[0][i][0]);
+            _mm256_storeu_ps(C + i * ldc + 8, c[0][i][1]);
+        } else {
+            _mm256_maskstore_ps(C + i * ldc + 0, m0, c[0][i][0]);
+            _mm256_maskstore_ps(C + i * ldc + 8, m1, c[0][i][1]);
+        }
+    }
+}
+
+void gemm_block_avx2(const float* A, const float* B, float* C, size_t M, size_t N, size_t K, size_t lda, size_t ldb, size_t ldc) {
+    for (size_t n = 0; n < N; n += 16) {
+        size_t nr = std::min<size_t>(16, N - n);
+        size_t m = 0;
+        for (; m + 6 <= M; m += 6) {
+            micro_kernel_rx16<6>(A + m * lda, B + n, C + m * ldc + n, nr, K, lda, ldb, ldc);
+        }
+        const float* a = A + m * lda;
+        float* c = C + m * ldc + n;
+        switch (M - m) {
+            case 5: micro_kernel_rx16<5>(a, B + n, c, nr, K, lda, ldb, ldc); break;
+            case 4: micro_kernel_rx16<4>(a, B + n, c, nr, K, lda, ldb, ldc); break;
+            case 3: micro_kernel_rx16<3>(a, B + n, c, nr, K, lda, ldb, ldc); break;
+            case 2: micro_kernel_rx16<2>(a, B + n, c, nr, K, lda, ldb, ldc); break;
+            case 1: micro_kernel_rx16<1>(a, B + n, c, nr, K, lda, ldb, ldc); break;
+            default: break;
+        }
+    }
+}
+
 /**
  * @brief General entry point for Avx2Kernel.
  * 
@@ -0,0 +1,151 @@
+#pragma once
+#include <immintrin.h>
+#include <cstdint>
+#include <cstddef>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @file avx2_math.h
+ * @brief Inline AVX2 transcendental and reduction helpers shared by the fused operators.
+ *
+ * Keeping these in registers is what lets epilogues such as SiLU or softmax run
+ * without spilling the accumulator tile back to memory.
+ */
+
+namespace softaccelnpu {
+
+/** @brief Number of set bits (movemask / panel-mask popcount; GCC, Clang and MSVC). */
+inline unsigned popcount32(uint32_t x) {
+#ifdef _MSC_VER
+    return __popcnt(x);
+#else
+    return static_cast<unsigned>(__builtin_popcount(x));
+#endif
+}
+
+/** @brief Index of the lowest set bit; x must be nonzero. */
+inline unsigned ctz32(uint32_t x) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+
+/** @brief Horizontal sum of the 8 lanes of a YMM register. */
+inline float avx2_hsum_ps(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+/** @brief Horizontal max of the 8 lanes of a YMM register. */
+inline float avx2_hmax_ps(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_max_ps(lo, hi);
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+/**
+ * @brief Vectorized exp(x) (Cephes-style range reduction + degree-5 polynomial).
+ * Relative error is ~1e-7 over the clamped input range [-87, 88].
+ */
+inline __m256 avx2_exp_ps(__m256 x) {
+    const __m256 hi = _mm256_set1_ps(88.0f);
+    const __m256 lo = _mm256_set1_ps(-87.0f);
+    const __m256 log2e = _mm256_set1_ps(1.44269504088896341f);
+    const __m256 c1 = _mm256_set1_ps(0.693359375f);
+    const __m256 c2 = _mm256_set1_ps(-2.12194440e-4f);
+
+    x = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+
+    // n = round(x / ln2), r = x - n * ln2
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_fnmadd_ps(n, c1, x);
+    x = _mm256_fnmadd_ps(n, c2, x);
+
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+    // Scale by 2^n via the exponent field
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+}
+
+/** @brief SiLU(x) = x * sigmoid(x) = x / (1 + exp(-x)). */
+inline __m256 avx2_silu_ps(__m256 x) {
+    __m256 e = avx2_exp_ps(_mm256_sub_ps(_mm256_setzero_ps(), x));
+    return _mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.0f), e));
+}
+
+/** @brief Lane mask selecting the first n (0..8) lanes, for masked loads/stores on edge tiles. */
+inline __m256i avx2_tail_mask(size_t n) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), lanes);
+}
+
+/** @brief Loads 8 IEEE binary16 values as FP32 (F16C vcvtph2ps). */
+inline __m256 avx2_load_fp16_ps(const uint16_t* p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+/** @brief Loads 8 bfloat16 values as FP32: bf16 is the upper half of an FP32 bit pattern. */
+inline __m256 avx2_load_bf16_ps(const uint16_t* p) {
+    const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+}
+
+/** @brief Loads 8 FP8 E5M2 values as FP32: E5M2 is the upper byte of an FP16 bit pattern. */
+inline __m256 avx2_load_fp8_e5m2_ps(const uint8_t* p) {
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm256_cvtph_ps(_mm_slli_epi16(_mm_cvtepu8_epi16(bytes), 8));
+}
+
+/**
+ * @brief Loads 8 FP8 E4M3 values as FP32.
+ *
+ * With the byte in the top of a 16-bit lane, an arithmetic shift right by one moves
+ * exponent/mantissa into FP16 position; clearing the duplicated sign bit leaves an
+ * FP16 pattern whose exponent bias is 8 too large (subnormals land on FP16
+ * subnormals the same way), so one multiply by 2^8 makes the decode exact.
+ * E4M3 NaN (S.1111.111) reads as 480.
+ */
+inline __m256 avx2_load_fp8_e4m3_ps(const uint8_t* p) {
+    const __m128i hi = _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))), 8);
+    const __m128i h = _mm_and_si128(_mm_srai_epi16(hi, 1), _mm_set1_epi16(static_cast<short>(0xBFFF)));
+    return _mm256_mul_ps(_mm256_cvtph_ps(h), _mm256_set1_ps(256.0f));
+}
+
+/** @brief 16-value form of avx2_load_fp8_e4m3_ps: the integer steps run once on a full ymm. */
+inline void avx2_load16_fp8_e4m3_ps(const uint8_t* p, __m256& lo, __m256& hi) {
+    const __m256i t = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), 8);
+    const __m256i h = _mm256_and_si256(_mm256_srai_epi16(t, 1), _mm256_set1_epi16(static_cast<short>(0xBFFF)));
+    lo = _mm256_mul_ps(_mm256_cvtph_ps(_mm256_castsi256_si128(h)), _mm256_set1_ps(256.0f));
+    hi = _mm256_mul_ps(_mm256_cvtph_ps(_mm256_extracti128_si256(h, 1)), _mm256_set1_ps(256.0f));
+}
+
+/** @brief 16-value form of avx2_load_fp8_e5m2_ps. */
+inline void avx2_load16_fp8_e5m2_ps(const uint8_t* p, __m256& lo, __m256& hi) {
+    const __m256i h = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), 8);
+    lo = _mm256_cvtph_ps(_mm256_castsi256_si128(h));
+    hi = _mm256_cvtph_ps(_mm256_extracti128_si256(h, 1));
+}
+
+} // namespace softaccelnpu
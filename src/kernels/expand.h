@@ -0,0 +1,46 @@
+#pragma once
+#include "avx2_math.h"
+#include <immintrin.h>
+#include <cstdint>
+
+/**
+ * @file expand.h
+ * @brief AVX2 expansion of a compacted nonzero stream back to dense lanes.
+ *
+ * AVX2 has no vexpandps. A 256-entry table maps each 8-bit lane mask to the vpermps
+ * indices that move the first popcount(mask) stream values onto the set lanes.
+ * pdep can derive the same indices, but it is microcoded on Zen 2, so a table it is.
+ */
+
+namespace softaccelnpu {
+
+struct ExpandLut {
+    alignas(32) int32_t idx[256][8];
+    constexpr ExpandLut() : idx() {
+        for (int m = 0; m < 256; ++m) {
+            int next = 0;
+            for (int i = 0; i < 8; ++i) idx[m][i] = (m >> i & 1) ? next++ : 0;
+        }
+    }
+};
+
+inline constexpr ExpandLut EXPAND_LUT{};
+
+/** @brief Lanes of mask set to the next values of src (which must allow an 8-float read), others 0. */
+inline __m256 avx2_expand8_ps(const float* src, unsigned mask) {
+    const __m256i bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i live = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bit), bit);
+    const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(EXPAND_LUT.idx[mask]));
+    return _mm256_and_ps(_mm256_permutevar8x32_ps(_mm256_loadu_ps(src), perm), _mm256_castsi256_ps(live));
+}
+
+/** @brief Expands one 16-lane panel row and advances src past its nonzeros. */
+inline void avx2_expand16_ps(const float*& src, uint16_t mask, __m256& lo, __m256& hi) {
+    const unsigned m0 = mask & 0xFFu, m1 = mask >> 8;
+    lo = avx2_expand8_ps(src, m0);
+    src += popcount32(m0);
+    hi = avx2_expand8_ps(src, m1);
+    src += popcount32(m1);
+}
+
+} // namespace softaccelnpu
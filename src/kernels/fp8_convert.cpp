@@ -0,0 +1,79 @@
+#include "softaccelnpu/fp8.h"
+#include "avx2_math.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+namespace softaccelnpu {
+
+namespace {
+
+/**
+ * Generic 1-byte minifloat: sign, (7 - mbits) exponent bits, mbits mantissa bits.
+ * max_code is the largest finite magnitude code, nan_code the magnitude used for NaN.
+ * E5M2 reserves its top exponent for Inf/NaN like FP16; E4M3 only reserves S.1111.111.
+ */
+struct Fp8Format {
+    int mbits;
+    int bias;
+    uint8_t max_code;
+    uint8_t nan_code;
+    bool ieee_specials;
+};
+
+constexpr Fp8Format E4M3{3, 7, 0x7E, 0x7F, false};
+constexpr Fp8Format E5M2{2, 15, 0x7B, 0x7F, true};
+
+float decode(uint8_t v, const Fp8Format& f) {
+    const int e = (v & 0x7F) >> f.mbits;
+    const int m = v & ((1 << f.mbits) - 1);
+    if (f.ieee_specials && e == (0x7F >> f.mbits)) {
+        const float special = m ? NAN : INFINITY;
+        return (v & 0x80) ? -special : special;
+    }
+    const float mag = (e == 0) ? std::ldexp(static_cast<float>(m), 1 - f.bias - f.mbits)
+                               : std::ldexp(static_cast<float>(m + (1 << f.mbits)), e - f.bias - f.mbits);
+    return (v & 0x80) ? -mag : mag;
+}
+
+uint8_t encode(float x, const Fp8Format& f) {
+    const uint8_t sign = std::signbit(x) ? 0x80 : 0x00;
+    if (std::isnan(x)) return sign | f.nan_code;
+    const float a = std::fabs(x);
+    if (a >= decode(f.max_code, f)) return sign | f.max_code;
+
+    int exp;
+    std::frexp(a, &exp);                                    // a = fr * 2^exp, fr in [0.5, 1)
+    const int e = std::max(exp - 1 + f.bias, 1);            // Biased exponent; 1 also covers subnormals
+    // Mantissa step is 2^(e - bias - mbits); nearbyint rounds half to even
+    const int q = static_cast<int>(std::nearbyint(std::ldexp(a, f.mbits - (e - f.bias))));
+    // q < 2^mbits is a subnormal (e field 0); q == 2^(mbits+1) carries into the next binade,
+    // which adding the unbiased code handles since the exponent field sits right above
+    int code = (e - 1) << f.mbits;
+    code += q;
+    return sign | static_cast<uint8_t>(std::min<int>(code, f.max_code));
+}
+
+} // namespace
+
+float fp8_e4m3_to_fp32(uint8_t v) { return decode(v, E4M3); }
+float fp8_e5m2_to_fp32(uint8_t v) { return decode(v, E5M2); }
+uint8_t fp32_to_fp8_e4m3(float f) { return encode(f, E4M3); }
+uint8_t fp32_to_fp8_e5m2(float f) { return encode(f, E5M2); }
+
+void convert_fp8_to_fp32(const uint8_t* src, float* dst, size_t count, DataType dtype) {
+    const bool e5 = dtype == DataType::FP8_E5M2;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, e5 ? avx2_load_fp8_e5m2_ps(src + i) : avx2_load_fp8_e4m3_ps(src + i));
+    }
+    for (; i < count; ++i) dst[i] = e5 ? fp8_e5m2_to_fp32(src[i]) : fp8_e4m3_to_fp32(src[i]);
+}
+
+void convert_fp32_to_fp8(const float* src, uint8_t* dst, size_t count, DataType dtype) {
+    // Runs once at quantization time; the scalar rounding is exact and portable
+    const Fp8Format& f = dtype == DataType::FP8_E5M2 ? E5M2 : E4M3;
+    for (size_t i = 0; i < count; ++i) dst[i] = encode(src[i], f);
+}
+
+} // namespace softaccelnpu
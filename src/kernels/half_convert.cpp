@@ -0,0 +1,70 @@
+#include "softaccelnpu/half.h"
+#include "avx2_math.h"
+#include <cstring>
+#include <immintrin.h>
+
+namespace softaccelnpu {
+
+float fp16_to_fp32(uint16_t h) {
+    return _cvtsh_ss(h);
+}
+
+uint16_t fp32_to_fp16(float f) {
+    return static_cast<uint16_t>(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+}
+
+float bf16_to_fp32(uint16_t h) {
+    const uint32_t bits = static_cast<uint32_t>(h) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint16_t fp32_to_bf16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) return 0x7FC0;  // Quiet NaN (rounding could turn it into Inf)
+    bits += 0x7FFFu + ((bits >> 16) & 1u);                    // Round to nearest even
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+void convert_fp16_to_fp32(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) _mm256_storeu_ps(dst + i, avx2_load_fp16_ps(src + i));
+    for (; i < count; ++i) dst[i] = fp16_to_fp32(src[i]);
+}
+
+void convert_fp32_to_fp16(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+    for (; i < count; ++i) dst[i] = fp32_to_fp16(src[i]);
+}
+
+void convert_bf16_to_fp32(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) _mm256_storeu_ps(dst + i, avx2_load_bf16_ps(src + i));
+    for (; i < count; ++i) dst[i] = bf16_to_fp32(src[i]);
+}
+
+void convert_fp32_to_bf16(const float* src, uint16_t* dst, size_t count) {
+    const __m256i round_bias = _mm256_set1_epi32(0x7FFF);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i qnan = _mm256_set1_epi32(0x7FC0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(src + i);
+        const __m256i bits = _mm256_castps_si256(v);
+        const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+        __m256i r = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(round_bias, lsb)), 16);
+        r = _mm256_blendv_epi8(r, qnan, _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+        // 32 -> 16 bit: packus works per 128-bit lane, so gather both lanes' results into the low half
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+    }
+    for (; i < count; ++i) dst[i] = fp32_to_bf16(src[i]);
+}
+
+} // namespace softaccelnpu
@@ -1,12 +1,26 @@
 #include "softaccelnpu/int4_kernel.h"
 #include <algorithm>
 #include <cstring>
+#include <immintrin.h>
 
 namespace softaccelnpu {
 
 void pack_int4(const int8_t* src, uint8_t* dst, size_t count) {
-    // Pack two 4-bit values into one byte
-    for (size_t i = 0; i < count; i += 2) {
+    // Pack two 4-bit values into one byte: element 2i in the low nibble, 2i + 1 in the high
+    size_t i = 0;
+    const __m256i nib = _mm256_set1_epi8(0x0F);
+    const __m256i low_byte = _mm256_set1_epi16(0x00FF);
+    for (; i + 64 <= count; i += 64) {
+        // Within each 16-bit lane: lo | hi << 8 -> lo | hi << 4 in the low byte
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), nib);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)), nib);
+        a = _mm256_and_si256(_mm256_or_si256(a, _mm256_srli_epi16(a, 4)), low_byte);
+        b = _mm256_and_si256(_mm256_or_si256(b, _mm256_srli_epi16(b, 4)), low_byte);
+        // packus interleaves 128-bit lanes (a0 b0 a1 b1); restore a0 a1 b0 b1
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 2), packed);
+    }
+    for (; i < count; i += 2) {
         uint8_t low = (uint8_t)(src[i] & 0x0F);
         uint8_t high = (i + 1 < count) ? (uint8_t)(src[i+1] & 0x0F) : 0;
         dst[i / 2] = (high << 4) | low;
@@ -14,13 +28,27 @@ void pack_int4(const int8_t* src, uint8_t* dst, size_t count) {
 }
 
 void unpack_int4_to_int8(const uint8_t* src, int8_t* dst, size_t count) {
-    for (size_t i = 0; i < count; i += 2) {
+    size_t i = 0;
+    const __m256i nib = _mm256_set1_epi8(0x0F);
+    const __m256i sign = _mm256_set1_epi8(0x08);
+    for (; i + 64 <= count; i += 64) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i / 2));
+        // Sign-extend 4-bit values: (x ^ 8) - 8
+        const __m256i lo = _mm256_sub_epi8(_mm256_xor_si256(_mm256_and_si256(bytes, nib), sign), sign);
+        const __m256i hi = _mm256_sub_epi8(_mm256_xor_si256(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), nib), sign), sign);
+        // Interleaving works per 128-bit lane: bytes 0-7 | 16-23 and 8-15 | 24-31
+        const __m256i even = _mm256_unpacklo_epi8(lo, hi);
+        const __m256i odd = _mm256_unpackhi_epi8(lo, hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute2x128_si256(even, odd, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_permute2x128_si256(even, odd, 0x31));
+    }
+    for (; i < count; i += 2) {
         uint8_t byte = src[i / 2];
         dst[i] = (int8_t)(byte & 0x0F);
         if (i + 1 < count) {
             dst[i+1] = (int8_t)((byte >> 4) & 0x0F);
         }
-        
+
         // Sign extension for 4-bit to 8-bit
         if (dst[i] & 0x08) dst[i] |= 0xF0;
         if (i + 1 < count && (dst[i+1] & 0x08)) dst[i+1] |= 0xF0;
@@ -57,4 +57,69 @@ public:
     bool is_supported() const override;
 };
 
+/**
+ * @brief Register-blocked C += A * B for arbitrary M, N, K.
+ *
+ * Covers the block with 6x16 FMA tiles and handles ragged rows/columns with
+ * narrower tiles and masked loads instead of a scalar fallback. Used by the
+ * fused operators that drive their own tiling loops.
+ */
+void gemm_block_avx2(const float* A, const float* B, float* C, size_t M, size_t N, size_t K, size_t lda, size_t ldb, size_t ldc);
+
+// Fused SwiGLU tiling, shared by GemmOps::ffn_swiglu and GemmOps::moe_ffn
+constexpr size_t FFN_MR = 6;    // Token rows per register tile
+constexpr size_t FFN_HB = 8;    // Hidden units per interleaved gate/up block (one YMM)
+constexpr size_t FFN_HC = 128;  // Hidden units per down-projection update (L1-resident tile)
+
+/**
+ * @brief Fused SwiGLU FFN over a row block and a hidden-unit range [h_begin, h_end).
+ *
+ * out[rows x D] += (SiLU(X*Wg) . (X*Wu))[:, h_begin:h_end] * W_down[h_begin:h_end, :].
+ * W_gate_up uses the panel-major layout of GemmOps::pack_ffn_gate_up; h_begin must
+ * be a multiple of FFN_HB. Shared by GemmOps::ffn_swiglu and the MoE grouped launch.
+ */
+void ffn_swiglu_block(const float* X, size_t rows, size_t D, const float* W_gate_up, const float* W_down,
+                      size_t h_begin, size_t h_end, float* out);
+
+/**
+ * @brief 1 / sqrt(mean(x^2) + eps) over one row (RMSNorm scale).
+ */
+float rms_norm_scale(const float* x, size_t n, float eps);
+
+/**
+ * @brief Mean and 1 / sqrt(var + eps) over one row (LayerNorm statistics, two-pass).
+ */
+void layer_norm_stats(const float* x, size_t n, float eps, float& mean, float& inv_std);
+
+/**
+ * @brief Packs mr rows x kb columns of A into a dense sliver (ld = kb), applying
+ * y = (x - shift[r]) * scale[r] * gamma[k] (+ beta[k]) on the way.
+ */
+void pack_A_normalized(const float* A, size_t lda, size_t mr, size_t kb, const float* scale, const float* shift,
+                       const float* gamma, const float* beta, float* dst);
+
+/**
+ * @brief Widens rows [k0, k0 + kb) x columns [n0, n0 + nb) of a narrow (FP16, BF16 or FP8)
+ * B into FP32 NR-wide panels (dst panel j at j * kb * 16, ld = 16, zero-padded).
+ * B is row-major with row stride ldb, or panel-major over K rows when panels is set;
+ * n0 must be a multiple of 16. col_scale, if set, holds a multiplier per column of B.
+ */
+void pack_B_widen(const void* B, DataType dtype, size_t ldb, bool panels, size_t K, size_t N,
+                  size_t k0, size_t kb, size_t n0, size_t nb, const float* col_scale, float* dst);
+
+/**
+ * @brief Packs W (N x K row-major, FP32/FP16/BF16/FP8) as B = W^T in Layout::Tiled
+ * FP32 panels: dst holds ceil(N / 16) panels of K x 16, the last one zero-padded.
+ */
+void pack_B_transposed(const void* W, DataType dtype, size_t N, size_t K, float* dst);
+
+struct CompressedWeights;
+
+/**
+ * @brief Expands rows [k0, k0 + kb) x columns [n0, n0 + nb) of bitmask-compressed B
+ * into the same NR-wide FP32 panels as pack_B_widen, and records the weight bytes
+ * read against their dense size in CacheModel. n0 must be a multiple of 16.
+ */
+void pack_B_compressed(const CompressedWeights& B, size_t k0, size_t kb, size_t n0, size_t nb, float* dst);
+
 } // namespace softaccelnpu
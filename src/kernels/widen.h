@@ -0,0 +1,46 @@
+#pragma once
+#include "softaccelnpu/types.h"
+#include "softaccelnpu/half.h"
+#include "softaccelnpu/fp8.h"
+#include "avx2_math.h"
+
+/**
+ * @file widen.h
+ * @brief Compile-time dispatched loads of narrow weight types as FP32.
+ *
+ * Weight-streaming kernels are templated on the stored DataType so the inner loops
+ * carry no per-element branch; element i is counted in units of the stored type.
+ */
+
+namespace softaccelnpu {
+
+template <DataType DT>
+inline __m256 widen8(const void* W, size_t i) {
+    if constexpr (DT == DataType::FP16) return avx2_load_fp16_ps(static_cast<const uint16_t*>(W) + i);
+    else if constexpr (DT == DataType::BF16) return avx2_load_bf16_ps(static_cast<const uint16_t*>(W) + i);
+    else if constexpr (DT == DataType::FP8_E4M3) return avx2_load_fp8_e4m3_ps(static_cast<const uint8_t*>(W) + i);
+    else if constexpr (DT == DataType::FP8_E5M2) return avx2_load_fp8_e5m2_ps(static_cast<const uint8_t*>(W) + i);
+    else return _mm256_loadu_ps(static_cast<const float*>(W) + i);
+}
+
+/** @brief Elements [i, i + 16): one Layout::Tiled panel row. */
+template <DataType DT>
+inline void widen16(const void* W, size_t i, __m256& lo, __m256& hi) {
+    if constexpr (DT == DataType::FP8_E4M3) avx2_load16_fp8_e4m3_ps(static_cast<const uint8_t*>(W) + i, lo, hi);
+    else if constexpr (DT == DataType::FP8_E5M2) avx2_load16_fp8_e5m2_ps(static_cast<const uint8_t*>(W) + i, lo, hi);
+    else {
+        lo = widen8<DT>(W, i);
+        hi = widen8<DT>(W, i + 8);
+    }
+}
+
+template <DataType DT>
+inline float widen1(const void* W, size_t i) {
+    if constexpr (DT == DataType::FP16) return fp16_to_fp32(static_cast<const uint16_t*>(W)[i]);
+    else if constexpr (DT == DataType::BF16) return bf16_to_fp32(static_cast<const uint16_t*>(W)[i]);
+    else if constexpr (DT == DataType::FP8_E4M3) return fp8_e4m3_to_fp32(static_cast<const uint8_t*>(W)[i]);
+    else if constexpr (DT == DataType::FP8_E5M2) return fp8_e5m2_to_fp32(static_cast<const uint8_t*>(W)[i]);
+    else return static_cast<const float*>(W)[i];
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,412 @@
+#include "softaccelnpu/attention.h"
+#include "softaccelnpu/kv_cache.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/hardware_info.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/internal_kernels.h"
+#include "../kernels/avx2_math.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file attention.cpp
+ * @brief Flash-style attention with online softmax.
+ *
+ * For each (head, query block) the K/V sequence is consumed block by block:
+ *   S = scale * Q_blk K_blk^T          (block_q x block_kv, L1 resident)
+ *   m' = max(m, rowmax(S)),  P = exp(S - m')
+ *   l  = l * exp(m - m') + rowsum(P)
+ *   O  = O * exp(m - m') + P V_blk
+ * and O / l is written out at the end. Peak scratch is O(block_q * (block_kv + head_dim)).
+ *
+ * Decode (one or a few query rows) instead splits the KV length: every (kv head, split)
+ * task produces unnormalized (m, l, O) partials for all query heads of its group, and
+ * the partials are merged with a log-sum-exp reduction.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr float NEG_INF = -std::numeric_limits<float>::infinity();
+
+void validate(const Tensor& Q, const Tensor& K, const Tensor& V, const Tensor& O, const AttentionDesc& d) {
+    if (d.head_dim == 0 || d.num_kv_heads == 0 || d.num_heads % d.num_kv_heads != 0) {
+        throw std::invalid_argument("attention: num_heads must be a positive multiple of num_kv_heads");
+    }
+    const size_t q_cols = d.num_heads * d.head_dim;
+    const size_t kv_cols = d.num_kv_heads * d.head_dim;
+    if (Q.rows() != d.seq_q || Q.cols() != q_cols || O.rows() != d.seq_q || O.cols() != q_cols) {
+        throw std::invalid_argument("attention: Q/O must be seq_q x (num_heads * head_dim)");
+    }
+    if (K.rows() < d.seq_kv || K.cols() != kv_cols || V.rows() < d.seq_kv || V.cols() != kv_cols) {
+        throw std::invalid_argument("attention: K/V must be seq_kv x (num_kv_heads * head_dim)");
+    }
+}
+
+/**
+ * Online softmax update for one score row of width bc_pad (multiple of 8, masked
+ * lanes already -inf). Rescales the accumulator row and leaves P in srow.
+ */
+void online_softmax_row(float* srow, size_t bc_pad, float scale, float& m, float& l, float* arow, size_t d) {
+    __m256 vmax = _mm256_set1_ps(NEG_INF);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (size_t j = 0; j < bc_pad; j += 8) {
+        __m256 x = _mm256_mul_ps(_mm256_loadu_ps(srow + j), vscale);
+        _mm256_storeu_ps(srow + j, x);
+        vmax = _mm256_max_ps(vmax, x);
+    }
+    const float m_new = std::max(m, avx2_hmax_ps(vmax));
+    const float correction = std::exp(m - m_new);
+
+    __m256 vsum = _mm256_setzero_ps();
+    const __m256 vm = _mm256_set1_ps(m_new);
+    for (size_t j = 0; j < bc_pad; j += 8) {
+        __m256 x = _mm256_loadu_ps(srow + j);
+        __m256 valid = _mm256_cmp_ps(x, _mm256_set1_ps(NEG_INF), _CMP_NEQ_OQ);
+        __m256 p = _mm256_and_ps(avx2_exp_ps(_mm256_sub_ps(x, vm)), valid);
+        _mm256_storeu_ps(srow + j, p);
+        vsum = _mm256_add_ps(vsum, p);
+    }
+
+    l = l * correction + avx2_hsum_ps(vsum);
+    m = m_new;
+    if (correction != 1.0f) {
+        for (size_t x = 0; x < d; ++x) arow[x] *= correction;
+    }
+}
+
+float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + x), _mm256_loadu_ps(b + x), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + x + 8), _mm256_loadu_ps(b + x + 8), acc1);
+    }
+    for (; x + 8 <= n; x += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + x), _mm256_loadu_ps(b + x), acc0);
+    }
+    float sum = avx2_hsum_ps(_mm256_add_ps(acc0, acc1));
+    for (; x < n; ++x) sum += a[x] * b[x];
+    return sum;
+}
+
+} // namespace
+
+void AttentionOps::select_tiles(size_t head_dim, size_t& block_q, size_t& block_kv) {
+    auto cache = HardwareInfo::get_cache_info();
+    const size_t row_bytes = std::max<size_t>(head_dim, 1) * sizeof(float);
+
+    // K block + V block share L1
+    block_kv = cache.l1_size / (2 * row_bytes);
+    block_kv = std::max<size_t>(16, std::min<size_t>(256, block_kv / 8 * 8));
+
+    // Q block + output accumulator + score tile take a quarter of L2
+    block_q = (cache.l2_size / 4) / (2 * row_bytes + block_kv * sizeof(float));
+    block_q = std::max<size_t>(6, std::min<size_t>(128, block_q / 6 * 6));
+}
+
+void AttentionOps::flash_attention(const Tensor& Q, const Tensor& K, const Tensor& V, Tensor& O, const AttentionDesc& desc) {
+    validate(Q, K, V, O, desc);
+    if (desc.seq_q == 0) return;
+
+    const size_t d = desc.head_dim;
+    const size_t Sq = desc.seq_q, Skv = desc.seq_kv;
+    const size_t group = desc.num_heads / desc.num_kv_heads;
+    const size_t ldq = desc.num_heads * d;
+    const size_t ldkv = desc.num_kv_heads * d;
+    const size_t q_pos = (desc.q_pos == SIZE_MAX) ? (Skv >= Sq ? Skv - Sq : 0) : desc.q_pos;
+    const float scale = desc.scale != 0.0f ? desc.scale : 1.0f / std::sqrt(static_cast<float>(d));
+
+    size_t Br, Bc;
+    select_tiles(d, Br, Bc);
+    const size_t q_blocks = (Sq + Br - 1) / Br;
+
+    const float* Qp = reinterpret_cast<const float*>(Q.data());
+    const float* Kp = reinterpret_cast<const float*>(K.data());
+    const float* Vp = reinterpret_cast<const float*>(V.data());
+    float* Op = O.data_as_fp32();
+
+    // Causal blocks near the end of the sequence cost more: schedule dynamically
+    get_thread_pool().parallel_tasks(desc.num_heads * q_blocks, [&](size_t task) {
+        thread_local std::vector<float> kt, s, acc, m, l;
+        const size_t h = task / q_blocks;
+        const size_t q0 = (task % q_blocks) * Br;
+        const size_t br = std::min(Br, Sq - q0);
+        const size_t kvh = h / group;
+
+        kt.resize(d * Bc);
+        s.resize(Br * Bc);
+        acc.assign(Br * d, 0.0f);
+        m.assign(Br, NEG_INF);
+        l.assign(Br, 0.0f);
+
+        const float* q = Qp + q0 * ldq + h * d;
+        const size_t kv_limit = desc.causal ? std::min(Skv, q_pos + q0 + br) : Skv;
+
+        for (size_t k0 = 0; k0 < kv_limit; k0 += Bc) {
+            const size_t bc = std::min(Bc, kv_limit - k0);
+
+            // 1. K block transposed into a d x Bc panel, then S = Q_blk * K_blk^T
+            for (size_t j = 0; j < bc; ++j) {
+                const float* krow = Kp + (k0 + j) * ldkv + kvh * d;
+                for (size_t x = 0; x < d; ++x) kt[x * Bc + j] = krow[x];
+            }
+            std::fill(s.begin(), s.begin() + br * Bc, 0.0f);
+            gemm_block_avx2(q, kt.data(), s.data(), br, bc, d, ldq, Bc, Bc);
+
+            // 2. Scale, mask and online softmax update per query row
+            for (size_t r = 0; r < br; ++r) {
+                float* srow = s.data() + r * Bc;
+                const size_t visible = desc.causal ? std::min(bc, q_pos + q0 + r + 1 > k0 ? q_pos + q0 + r + 1 - k0 : 0) : bc;
+                if (visible == 0) {
+                    std::fill(srow, srow + Bc, 0.0f);
+                    continue;
+                }
+                for (size_t j = visible; j < Bc; ++j) srow[j] = NEG_INF;
+
+                online_softmax_row(srow, Bc, scale, m[r], l[r], acc.data() + r * d, d);
+            }
+
+            // 3. O_blk += P * V_blk
+            gemm_block_avx2(s.data(), Vp + k0 * ldkv + kvh * d, acc.data(), br, d, bc, Bc, ldkv, d);
+        }
+
+        // 4. Normalize and write the head slice of O
+        for (size_t r = 0; r < br; ++r) {
+            float* orow = Op + (q0 + r) * ldq + h * d;
+            const float inv = l[r] > 0.0f ? 1.0f / l[r] : 0.0f;
+            for (size_t x = 0; x < d; ++x) orow[x] = acc[r * d + x] * inv;
+        }
+    });
+
+    const size_t pairs = desc.causal ? Sq * (2 * q_pos + Sq + 1) / 2 : Sq * Skv;
+    PowerModel::record_activity(4 * desc.num_heads * pairs * d,
+                                (2 * Sq * ldq + 2 * Skv * ldkv) * sizeof(float), 0.0f, true);
+}
+
+size_t AttentionOps::select_kv_splits(const AttentionDesc& desc, size_t kv_len) {
+    if (desc.kv_splits) return std::max<size_t>(1, std::min(desc.kv_splits, kv_len));
+
+    // Enough (kv head, split) tasks to cover the pool, but keep each split long
+    // enough that the merge and per-task setup stay negligible.
+    constexpr size_t MIN_SPLIT_KEYS = 256;
+    const size_t threads = get_thread_pool().num_threads();
+    const size_t wanted = (threads + desc.num_kv_heads - 1) / desc.num_kv_heads;
+    const size_t max_splits = std::max<size_t>(1, kv_len / MIN_SPLIT_KEYS);
+    return std::max<size_t>(1, std::min(wanted, max_splits));
+}
+
+namespace {
+
+/** K/V rows for one kv head: rows x head_dim, row stride ld. */
+struct KVBlock {
+    const float* k;
+    const float* v;
+    size_t ld;
+    size_t rows;
+};
+
+/** Contiguous seq_kv x (num_kv_heads * head_dim) K/V tensors. */
+struct DenseKV {
+    const float* K;
+    const float* V;
+    size_t ld, d;
+
+    KVBlock block(size_t idx, size_t kvh, size_t max_rows, float*, float*) const {
+        return {K + idx * ld + kvh * d, V + idx * ld + kvh * d, ld, max_rows};
+    }
+};
+
+/** Resident tokens of one sequence/layer of a PagedKVCache; blocks never cross a page. */
+struct PagedKV {
+    const PagedKVCache& cache;
+    const std::vector<uint32_t>& pages;
+    size_t layer, page_size, ld, d;
+    bool int8;
+
+    static void dequantize(const int8_t* src, const float* scales, size_t rows, size_t ld, size_t d,
+                           size_t heads, float* dst) {
+        for (size_t r = 0; r < rows; ++r) {
+            const int8_t* q = src + r * ld;
+            const __m256 vs = _mm256_set1_ps(scales[r * heads]);
+            size_t x = 0;
+            for (; x + 8 <= d; x += 8) {
+                __m128i q8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + x));
+                __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q8));
+                _mm256_storeu_ps(dst + r * d + x, _mm256_mul_ps(f, vs));
+            }
+            for (; x < d; ++x) dst[r * d + x] = q[x] * scales[r * heads];
+        }
+    }
+
+    KVBlock block(size_t idx, size_t kvh, size_t max_rows, float* k_scratch, float* v_scratch) const {
+        const uint32_t page = pages[idx / page_size];
+        const size_t slot = idx % page_size;
+        const size_t rows = std::min(max_rows, page_size - slot);
+        if (!int8) {
+            return {cache.key_page(page, layer) + slot * ld + kvh * d,
+                    cache.value_page(page, layer) + slot * ld + kvh * d, ld, rows};
+        }
+        // INT8 pages are expanded per block into L1 scratch (rows x d, stride d)
+        const size_t heads = ld / d;
+        dequantize(cache.key_page_int8(page, layer) + slot * ld + kvh * d,
+                   cache.key_scales(page, layer) + slot * heads + kvh, rows, ld, d, heads, k_scratch);
+        dequantize(cache.value_page_int8(page, layer) + slot * ld + kvh * d,
+                   cache.value_scales(page, layer) + slot * heads + kvh, rows, ld, d, heads, v_scratch);
+        return {k_scratch, v_scratch, d, rows};
+    }
+};
+
+/**
+ * Split-K attention over kv_len resident keys starting at absolute position pos0.
+ * Queries sit at absolute positions q_pos .. q_pos + seq_q - 1.
+ */
+template <typename Source>
+void split_kv_attention(const Tensor& Q, Tensor& O, const AttentionDesc& desc, size_t kv_len, size_t pos0,
+                        size_t q_pos, const Source& src) {
+    const size_t d = desc.head_dim;
+    const size_t Sq = desc.seq_q;
+    const size_t group = desc.num_heads / desc.num_kv_heads;
+    const size_t ldq = desc.num_heads * d;
+    const float scale = desc.scale != 0.0f ? desc.scale : 1.0f / std::sqrt(static_cast<float>(d));
+
+    size_t Br, Bc;
+    AttentionOps::select_tiles(d, Br, Bc);
+
+    // Rows of one task: every query of every head sharing the kv head (r = g * Sq + i)
+    const size_t R = group * Sq;
+    const size_t q_end = q_pos + Sq;
+    const size_t kv_limit = desc.causal ? (q_end > pos0 ? std::min(kv_len, q_end - pos0) : 0) : kv_len;
+    const size_t splits = AttentionOps::select_kv_splits(desc, std::max<size_t>(kv_limit, 1));
+    const size_t split_len = (kv_limit + splits - 1) / splits;
+
+    // Unnormalized partials per (kv head, split): running max, running sum, P*V
+    const size_t tasks = desc.num_kv_heads * splits;
+    std::vector<float> part_m(tasks * R, NEG_INF);
+    std::vector<float> part_l(tasks * R, 0.0f);
+    std::vector<float> part_acc(tasks * R * d, 0.0f);
+
+    const float* Qp = reinterpret_cast<const float*>(Q.data());
+    float* Op = O.data_as_fp32();
+
+    auto& pool = get_thread_pool();
+    pool.parallel_tasks(tasks, [&](size_t task) {
+        thread_local std::vector<float> s, k_scratch, v_scratch;
+        const size_t kvh = task / splits;
+        const size_t k_begin = (task % splits) * split_len;
+        const size_t k_end = std::min(kv_limit, k_begin + split_len);
+        if (k_begin >= k_end) return;
+
+        float* m = part_m.data() + task * R;
+        float* l = part_l.data() + task * R;
+        float* acc = part_acc.data() + task * R * d;
+        s.resize(R * Bc);
+        k_scratch.resize(Bc * d);
+        v_scratch.resize(Bc * d);
+
+        for (size_t k0 = k_begin; k0 < k_end;) {
+            const KVBlock blk = src.block(k0, kvh, std::min(Bc, k_end - k0), k_scratch.data(), v_scratch.data());
+            const size_t bc = blk.rows;
+            const size_t key_pos = pos0 + k0;
+
+            // 1. Scores: each key row is loaded once and reused by all R query rows
+            for (size_t r = 0; r < R; ++r) {
+                const size_t h = kvh * group + r / Sq;
+                const size_t i = r % Sq;
+                const float* q = Qp + i * ldq + h * d;
+                float* srow = s.data() + r * Bc;
+                const size_t visible = desc.causal ? std::min(bc, q_pos + i + 1 > key_pos ? q_pos + i + 1 - key_pos : 0) : bc;
+                if (visible == 0) {
+                    std::fill(srow, srow + Bc, 0.0f);
+                    continue;
+                }
+                for (size_t j = 0; j < visible; ++j) srow[j] = dot_avx2(q, blk.k + j * blk.ld, d);
+                for (size_t j = visible; j < Bc; ++j) srow[j] = NEG_INF;
+
+                // 2. Online softmax within the split
+                online_softmax_row(srow, Bc, scale, m[r], l[r], acc + r * d, d);
+            }
+
+            // 3. acc += P * V_blk
+            gemm_block_avx2(s.data(), blk.v, acc, R, d, bc, Bc, blk.ld, d);
+            k0 += bc;
+        }
+    });
+
+    // 4. Log-sum-exp merge of the split partials into O
+    pool.parallel_for(0, desc.num_kv_heads * R, [&](size_t row_start, size_t row_end) {
+        for (size_t row = row_start; row < row_end; ++row) {
+            const size_t kvh = row / R, r = row % R;
+            const size_t h = kvh * group + r / Sq;
+            float* orow = Op + (r % Sq) * ldq + h * d;
+
+            float m_max = NEG_INF;
+            for (size_t sp = 0; sp < splits; ++sp) m_max = std::max(m_max, part_m[(kvh * splits + sp) * R + r]);
+
+            std::fill(orow, orow + d, 0.0f);
+            if (m_max == NEG_INF) continue;
+
+            float l_sum = 0.0f;
+            for (size_t sp = 0; sp < splits; ++sp) {
+                const size_t t = kvh * splits + sp;
+                const float ms = part_m[t * R + r];
+                if (ms == NEG_INF) continue;
+                const float w = std::exp(ms - m_max);
+                const float* a = part_acc.data() + (t * R + r) * d;
+                l_sum += w * part_l[t * R + r];
+                for (size_t x = 0; x < d; ++x) orow[x] += w * a[x];
+            }
+            const float inv = 1.0f / l_sum;
+            for (size_t x = 0; x < d; ++x) orow[x] *= inv;
+        }
+    });
+
+    const size_t visible_pairs = desc.causal ? Sq * kv_limit - (Sq * (Sq - 1)) / 2 : Sq * kv_len;
+    PowerModel::record_activity(4 * desc.num_heads * visible_pairs * d,
+                                2 * Sq * ldq * sizeof(float) + 2 * kv_limit * desc.num_kv_heads * d * sizeof(float),
+                                0.0f, true);
+}
+
+} // namespace
+
+void AttentionOps::decode_attention(const Tensor& Q, const Tensor& K, const Tensor& V, Tensor& O, const AttentionDesc& desc) {
+    validate(Q, K, V, O, desc);
+    if (desc.seq_q == 0) return;
+
+    const size_t Sq = desc.seq_q, Skv = desc.seq_kv;
+    const size_t q_pos = (desc.q_pos == SIZE_MAX) ? (Skv >= Sq ? Skv - Sq : 0) : desc.q_pos;
+    const size_t ldkv = desc.num_kv_heads * desc.head_dim;
+
+    DenseKV src{reinterpret_cast<const float*>(K.data()), reinterpret_cast<const float*>(V.data()), ldkv, desc.head_dim};
+    split_kv_attention(Q, O, desc, Skv, 0, q_pos, src);
+}
+
+void AttentionOps::paged_attention(const Tensor& Q, const PagedKVCache& cache, PagedKVCache::SeqId seq, size_t layer,
+                                   Tensor& O, const AttentionDesc& desc) {
+    const auto& cfg = cache.config();
+    if (cfg.num_kv_heads != desc.num_kv_heads || cfg.head_dim != desc.head_dim || layer >= cfg.num_layers) {
+        throw std::invalid_argument("paged_attention: cache geometry does not match the attention descriptor");
+    }
+    if (desc.num_heads % desc.num_kv_heads != 0) {
+        throw std::invalid_argument("attention: num_heads must be a positive multiple of num_kv_heads");
+    }
+    const size_t q_cols = desc.num_heads * desc.head_dim;
+    if (Q.rows() != desc.seq_q || Q.cols() != q_cols || O.rows() != desc.seq_q || O.cols() != q_cols) {
+        throw std::invalid_argument("attention: Q/O must be seq_q x (num_heads * head_dim)");
+    }
+    if (desc.seq_q == 0) return;
+
+    const size_t length = cache.length(seq);
+    const size_t start = cache.first_position(seq);
+    const size_t q_pos = (desc.q_pos == SIZE_MAX) ? (length >= desc.seq_q ? length - desc.seq_q : 0) : desc.q_pos;
+
+    PagedKV src{cache, cache.block_table(seq), layer, cfg.page_size, cfg.num_kv_heads * cfg.head_dim, cfg.head_dim,
+                cfg.dtype == DataType::INT8};
+    split_kv_attention(Q, O, desc, length - start, start, q_pos, src);
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,185 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/internal_kernels.h"
+#include "../kernels/avx2_math.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file ffn_fused.cpp
+ * @brief Fused SwiGLU feed-forward block (gate/up GEMM + SiLU*mul + down GEMM).
+ *
+ * The gate and up projections are computed together from an interleaved, panel-major
+ * weight matrix, so one contiguous pass over X and the panel produces both halves of
+ * a hidden tile. SiLU(gate)*up is applied on the accumulator registers and the
+ * resulting hidden tile is consumed immediately by the down projection while it is
+ * still in L1. The full TxH hidden activation is never materialized.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+/**
+ * Computes h[R x 8] = SiLU(X * Wg) * (X * Wu) for one interleaved 8-unit block.
+ * Wgu points at the block's Dx16 panel: 8 gate columns followed by 8 up columns.
+ */
+template <int R>
+void gate_up_kernel(const float* X, size_t ldx, const float* Wgu, size_t ldw, size_t K, float* h, size_t ldh) {
+    // Decode tiles (R <= 2) use extra accumulator sets over k to hide FMA latency
+    constexpr int U = (R == 1) ? 4 : (R == 2 ? 2 : 1);
+    __m256 g[U][R], u[U][R];
+    for (int a = 0; a < U; ++a) {
+        for (int i = 0; i < R; ++i) {
+            g[a][i] = _mm256_setzero_ps();
+            u[a][i] = _mm256_setzero_ps();
+        }
+    }
+
+    auto step = [&](int a, size_t k) {
+        __m256 wg = _mm256_loadu_ps(Wgu + k * ldw + 0);
+        __m256 wu = _mm256_loadu_ps(Wgu + k * ldw + 8);
+        for (int i = 0; i < R; ++i) {
+            __m256 x = _mm256_set1_ps(X[i * ldx + k]);
+            g[a][i] = _mm256_fmadd_ps(x, wg, g[a][i]);
+            u[a][i] = _mm256_fmadd_ps(x, wu, u[a][i]);
+        }
+    };
+
+    size_t k = 0;
+    for (; k + U <= K; k += U) {
+        for (int a = 0; a < U; ++a) step(a, k + a);
+    }
+    for (; k < K; ++k) step(0, k);
+
+    for (int i = 0; i < R; ++i) {
+        for (int a = 1; a < U; ++a) {
+            g[0][i] = _mm256_add_ps(g[0][i], g[a][i]);
+            u[0][i] = _mm256_add_ps(u[0][i], u[a][i]);
+        }
+        _mm256_storeu_ps(h + i * ldh, _mm256_mul_ps(avx2_silu_ps(g[0][i]), u[0][i]));
+    }
+}
+
+void gate_up_rows(size_t rows, const float* X, size_t ldx, const float* Wgu, size_t ldw, size_t K, float* h, size_t ldh) {
+    switch (rows) {
+        case 6: gate_up_kernel<6>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        case 5: gate_up_kernel<5>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        case 4: gate_up_kernel<4>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        case 3: gate_up_kernel<3>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        case 2: gate_up_kernel<2>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        case 1: gate_up_kernel<1>(X, ldx, Wgu, ldw, K, h, ldh); break;
+        default: break;
+    }
+}
+
+} // namespace
+
+void ffn_swiglu_block(const float* X, size_t rows, size_t D, const float* W_gate_up, const float* W_down,
+                      size_t h_begin, size_t h_end, float* out) {
+    alignas(32) float h[FFN_MR * FFN_HC];
+    const size_t ldw = 2 * FFN_HB;
+
+    for (size_t m0 = 0; m0 < rows; m0 += FFN_MR) {
+        const size_t mr = std::min(FFN_MR, rows - m0);
+
+        for (size_t hc = h_begin; hc < h_end; hc += FFN_HC) {
+            const size_t hn = std::min(FFN_HC, h_end - hc);
+
+            // 1. Gate/Up projections + SiLU*mul into the L1 hidden tile
+            for (size_t j = 0; j < hn; j += FFN_HB) {
+                gate_up_rows(mr, X + m0 * D, D, W_gate_up + (hc + j) / FFN_HB * D * ldw, ldw, D, h + j, FFN_HC);
+            }
+
+            // 2. Down projection consumes the tile: out += h[mr x hn] * Wd[hn x D]
+            gemm_block_avx2(h, W_down + hc * D, out + m0 * D, mr, D, hn, FFN_HC, D, D);
+        }
+    }
+}
+
+Tensor GemmOps::pack_ffn_gate_up(const Tensor& W_gate, const Tensor& W_up) {
+    if (W_gate.rows() != W_up.rows() || W_gate.cols() != W_up.cols()) {
+        throw std::invalid_argument("pack_ffn_gate_up: gate and up weights must have the same shape");
+    }
+    const size_t D = W_gate.rows();
+    const size_t H = W_gate.cols();
+    const size_t Hp = (H + FFN_HB - 1) / FFN_HB * FFN_HB;
+
+    Tensor W(D, 2 * Hp);
+    const float* g = reinterpret_cast<const float*>(W_gate.data());
+    const float* u = reinterpret_cast<const float*>(W_up.data());
+    float* dst = W.data_as_fp32();
+
+    for (size_t d = 0; d < D; ++d) {
+        for (size_t j = 0; j < H; j += FFN_HB) {
+            size_t n = std::min(FFN_HB, H - j);
+            float* blk = dst + (j / FFN_HB) * D * 2 * FFN_HB + d * 2 * FFN_HB;
+            std::memcpy(blk, g + d * H + j, n * sizeof(float));
+            std::memcpy(blk + FFN_HB, u + d * H + j, n * sizeof(float));
+        }
+    }
+    return W;
+}
+
+void GemmOps::ffn_swiglu(const Tensor& X, const Tensor& W_gate_up, const Tensor& W_down, Tensor& Y) {
+    const size_t T = X.rows();
+    const size_t D = X.cols();
+    const size_t H = W_down.rows();
+    const size_t Hp = W_gate_up.cols() / 2;
+
+    if (W_gate_up.rows() != D || W_down.cols() != D || Y.rows() != T || Y.cols() != D ||
+        Hp < H || Hp != (H + FFN_HB - 1) / FFN_HB * FFN_HB) {
+        throw std::invalid_argument("ffn_swiglu: shape mismatch (expected X[TxD], W_gate_up[Dx2H], W_down[HxD], Y[TxD])");
+    }
+
+    const float* Xp = reinterpret_cast<const float*>(X.data());
+    const float* Wgu = reinterpret_cast<const float*>(W_gate_up.data());
+    const float* Wd = reinterpret_cast<const float*>(W_down.data());
+    float* Yp = Y.data_as_fp32();
+    auto& pool = get_thread_pool();
+    std::fill(Yp, Yp + T * D, 0.0f);
+    if (T == 0 || H == 0) return;  // No tokens, or an empty hidden layer contributes nothing
+
+    const size_t row_blocks = (T + FFN_MR - 1) / FFN_MR;
+    const size_t hidden_chunks = (H + FFN_HC - 1) / FFN_HC;
+
+    // Decode (few tokens) has too few row blocks to occupy the pool, so the hidden
+    // dimension is split as well; each split accumulates into its own partial Y.
+    size_t splits = 1;
+    if (row_blocks < pool.num_threads()) {
+        splits = std::min(hidden_chunks, (pool.num_threads() + row_blocks - 1) / row_blocks);
+    }
+    const size_t chunks_per_split = (hidden_chunks + splits - 1) / splits;
+    std::vector<float> partial((splits - 1) * T * D, 0.0f);
+
+    pool.parallel_for(0, row_blocks * splits, [&](size_t t_start, size_t t_end) {
+        for (size_t t = t_start; t < t_end; ++t) {
+            const size_t rb = t / splits;
+            const size_t s = t % splits;
+            const size_t m0 = rb * FFN_MR;
+            const size_t mr = std::min(FFN_MR, T - m0);
+            const size_t h_begin = s * chunks_per_split * FFN_HC;
+            const size_t h_end = std::min(H, (s + 1) * chunks_per_split * FFN_HC);
+            float* out = (s == 0) ? Yp + m0 * D : partial.data() + ((s - 1) * T + m0) * D;
+
+            ffn_swiglu_block(Xp + m0 * D, mr, D, Wgu, Wd, h_begin, h_end, out);
+        }
+    });
+
+    // Reduce the hidden-dimension splits into Y
+    if (splits > 1) {
+        pool.parallel_for(0, T * D, [&](size_t i_start, size_t i_end) {
+            for (size_t s = 1; s < splits; ++s) {
+                const float* p = partial.data() + (s - 1) * T * D;
+                for (size_t i = i_start; i < i_end; ++i) Yp[i] += p[i];
+            }
+        });
+    }
+
+    PowerModel::record_activity(2 * T * D * 3 * H, (3 * H * D + 2 * T * D) * 4, 0.0f, true);
+}
+
+} // namespace softaccelnpu
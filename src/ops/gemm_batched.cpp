@@ -0,0 +1,111 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/internal_kernels.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file gemm_batched.cpp
+ * @brief Strided batched GEMM (e.g. multi-head attention score/context products).
+ *
+ * All batch entries share one shape, so the work is flattened into
+ * batch x M-tiles x N-tiles and distributed over the pool in a single launch.
+ * Many small per-head GEMMs then fill every core instead of running back to back.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t BATCH_TM = 48;   // Rows per task (multiple of MR)
+constexpr size_t BATCH_TN = 128;  // Columns per task (multiple of NR)
+
+size_t required_elems(size_t batch, size_t stride, size_t rows, size_t cols, size_t ld) {
+    return (batch - 1) * stride + (rows - 1) * ld + cols;
+}
+
+} // namespace
+
+void GemmOps::gemm_batched_strided(const Tensor& A, const Tensor& B, Tensor& C, const GemmBatchDesc& desc) {
+    const size_t M = desc.M, N = desc.N, K = desc.K;
+    if (desc.batch == 0 || M == 0 || N == 0) return;
+
+    const size_t lda = desc.lda ? desc.lda : K;
+    const size_t ldb = desc.ldb ? desc.ldb : (desc.trans_b ? K : N);
+    const size_t ldc = desc.ldc ? desc.ldc : N;
+
+    if (K > 0 && (required_elems(desc.batch, desc.stride_a, M, K, lda) > A.size() ||
+                  required_elems(desc.batch, desc.stride_b, desc.trans_b ? N : K, desc.trans_b ? K : N, ldb) > B.size())) {
+        throw std::invalid_argument("gemm_batched_strided: batch strides exceed the A/B tensor extents");
+    }
+    if (required_elems(desc.batch, desc.stride_c, M, N, ldc) > C.size()) {
+        throw std::invalid_argument("gemm_batched_strided: batch strides exceed the C tensor extent");
+    }
+
+    const float* Ap = reinterpret_cast<const float*>(A.data());
+    const float* Bp = reinterpret_cast<const float*>(B.data());
+    float* Cp = C.data_as_fp32();
+
+    const size_t m_tiles = (M + BATCH_TM - 1) / BATCH_TM;
+    const size_t n_tiles = (N + BATCH_TN - 1) / BATCH_TN;
+    const size_t tiles_per_entry = m_tiles * n_tiles;
+
+    auto& pool = get_thread_pool();
+    pool.parallel_for(0, desc.batch * tiles_per_entry, [&](size_t t_start, size_t t_end) {
+        std::vector<float> b_panel;  // K x tn transpose of B^T (trans_b only)
+        std::vector<float> acc;      // tm x tn scratch when alpha != 1
+
+        for (size_t t = t_start; t < t_end; ++t) {
+            const size_t b = t / tiles_per_entry;
+            const size_t m0 = (t % tiles_per_entry) / n_tiles * BATCH_TM;
+            const size_t n0 = (t % n_tiles) * BATCH_TN;
+            const size_t tm = std::min(BATCH_TM, M - m0);
+            const size_t tn = std::min(BATCH_TN, N - n0);
+
+            const float* a = Ap + b * desc.stride_a + m0 * lda;
+            float* c = Cp + b * desc.stride_c + m0 * ldc + n0;
+
+            // Resolve op(B) into a row-major K x tn operand
+            const float* bk;
+            size_t ldbk;
+            if (desc.trans_b) {
+                b_panel.resize(K * tn);
+                const float* bt = Bp + b * desc.stride_b + n0 * ldb;
+                for (size_t j = 0; j < tn; ++j) {
+                    for (size_t k = 0; k < K; ++k) b_panel[k * tn + j] = bt[j * ldb + k];
+                }
+                bk = b_panel.data();
+                ldbk = tn;
+            } else {
+                bk = Bp + b * desc.stride_b + n0;
+                ldbk = ldb;
+            }
+
+            if (desc.alpha == 1.0f) {
+                // C = beta * C + A * op(B), accumulated in place
+                for (size_t i = 0; i < tm; ++i) {
+                    float* row = c + i * ldc;
+                    if (desc.beta == 0.0f) std::fill(row, row + tn, 0.0f);
+                    else if (desc.beta != 1.0f) for (size_t j = 0; j < tn; ++j) row[j] *= desc.beta;
+                }
+                gemm_block_avx2(a, bk, c, tm, tn, K, lda, ldbk, ldc);
+            } else {
+                acc.assign(tm * tn, 0.0f);
+                gemm_block_avx2(a, bk, acc.data(), tm, tn, K, lda, ldbk, tn);
+                for (size_t i = 0; i < tm; ++i) {
+                    float* row = c + i * ldc;
+                    for (size_t j = 0; j < tn; ++j) {
+                        float prev = (desc.beta == 0.0f) ? 0.0f : desc.beta * row[j];
+                        row[j] = prev + desc.alpha * acc[i * tn + j];
+                    }
+                }
+            }
+        }
+    });
+
+    PowerModel::record_activity(2 * desc.batch * M * N * K, desc.batch * (M * K + K * N + M * N) * 4);
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,201 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/internal_kernels.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file gemm_grouped.cpp
+ * @brief Grouped GEMM and mixture-of-experts routing.
+ *
+ * A grouped launch flattens every (problem, tile) pair of a set of variable-sized
+ * GEMMs into one task list and schedules it dynamically on the thread pool. For
+ * MoE layers this means all experts run in a single load-balanced launch, even when
+ * the router hands most experts only a handful of tokens.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t GROUP_TM = 48;   // Rows per task (multiple of MR)
+constexpr size_t GROUP_TN = 256;  // Columns per task (multiple of NR)
+
+struct GroupTask {
+    size_t problem;
+    size_t m0, n0;
+};
+
+} // namespace
+
+void GemmOps::gemm_grouped(const std::vector<GroupedGemmProblem>& problems) {
+    std::vector<GroupTask> tasks;
+    size_t flops = 0, bytes = 0;
+
+    for (size_t p = 0; p < problems.size(); ++p) {
+        const auto& pr = problems[p];
+        if (!pr.A || !pr.B || !pr.C) {
+            throw std::invalid_argument("gemm_grouped: null tensor in problem");
+        }
+        for (const Tensor* t : {pr.A, pr.B, static_cast<const Tensor*>(pr.C)}) {
+            if (t->dtype() != DataType::FP32 || t->layout() != Layout::RowMajor) {
+                throw std::invalid_argument("gemm_grouped: problem " + std::to_string(p) + " needs FP32 RowMajor tensors");
+            }
+        }
+        const size_t M = pr.A->rows(), K = pr.A->cols(), N = pr.B->cols();
+        if (pr.B->rows() != K || pr.C->rows() != M || pr.C->cols() != N) {
+            throw std::invalid_argument("gemm_grouped: shape mismatch in problem " + std::to_string(p));
+        }
+        for (size_t m0 = 0; m0 < M; m0 += GROUP_TM) {
+            for (size_t n0 = 0; n0 < N; n0 += GROUP_TN) tasks.push_back({p, m0, n0});
+        }
+        flops += 2 * M * N * K;
+        bytes += (M * K + K * N + M * N) * 4;
+    }
+
+    get_thread_pool().parallel_tasks(tasks.size(), [&](size_t i) {
+        const auto& task = tasks[i];
+        const auto& pr = problems[task.problem];
+        const size_t M = pr.A->rows(), K = pr.A->cols(), N = pr.B->cols();
+        const size_t tm = std::min(GROUP_TM, M - task.m0);
+        const size_t tn = std::min(GROUP_TN, N - task.n0);
+
+        const float* a = reinterpret_cast<const float*>(pr.A->data()) + task.m0 * K;
+        const float* b = reinterpret_cast<const float*>(pr.B->data()) + task.n0;
+        float* c = pr.C->data_as_fp32() + task.m0 * N + task.n0;
+
+        for (size_t r = 0; r < tm; ++r) std::fill(c + r * N, c + r * N + tn, 0.0f);
+        gemm_block_avx2(a, b, c, tm, tn, K, K, N, N);
+    });
+
+    PowerModel::record_activity(flops, bytes);
+}
+
+void GemmOps::moe_ffn(const Tensor& X, const MoeRouting& routing, const std::vector<MoeExpert>& experts, Tensor& Y) {
+    const size_t T = X.rows();
+    const size_t D = X.cols();
+    const size_t E = experts.size();
+    const size_t top_k = routing.top_k;
+
+    if (routing.expert_ids.size() != T * top_k || routing.weights.size() != T * top_k) {
+        throw std::invalid_argument("moe_ffn: routing must hold top_k entries per token");
+    }
+    if (Y.rows() != T || Y.cols() != D) {
+        throw std::invalid_argument("moe_ffn: output must be TxD");
+    }
+
+    // 1. Gather: bucket (token, slot) assignments per expert
+    std::vector<std::vector<size_t>> slots(E);  // slot = t * top_k + k
+    for (size_t i = 0; i < T * top_k; ++i) {
+        int32_t e = routing.expert_ids[i];
+        if (e < 0 || static_cast<size_t>(e) >= E) {
+            throw std::invalid_argument("moe_ffn: expert id out of range");
+        }
+        slots[e].push_back(i);
+    }
+
+    std::vector<size_t> hidden(E, 0), splits(E, 1), x_offset(E, 0), out_offset(E, 0);
+    size_t x_total = 0, row_blocks = 0;
+    for (size_t e = 0; e < E; ++e) {
+        if (slots[e].empty()) continue;
+        const auto& ex = experts[e];
+        if (!ex.W_gate_up || !ex.W_down) {
+            throw std::invalid_argument("moe_ffn: expert " + std::to_string(e) + " has tokens but no weights");
+        }
+        hidden[e] = ex.W_down->rows();
+        if (ex.W_gate_up->rows() != D || ex.W_down->cols() != D || ex.W_gate_up->cols() != 2 * ((hidden[e] + FFN_HB - 1) / FFN_HB * FFN_HB)) {
+            throw std::invalid_argument("moe_ffn: expert " + std::to_string(e) + " weights do not match the input dimension");
+        }
+        x_offset[e] = x_total;
+        x_total += slots[e].size() * D;
+        row_blocks += (slots[e].size() + FFN_MR - 1) / FFN_MR;
+    }
+
+    // Decode-sized batches leave too few row blocks for the pool: split each active
+    // expert's hidden dimension as well, with one partial output per split.
+    auto& pool = get_thread_pool();
+    const size_t split_target = row_blocks < pool.num_threads() ? (pool.num_threads() + row_blocks - 1) / std::max<size_t>(row_blocks, 1) : 1;
+    size_t out_total = 0;
+    for (size_t e = 0; e < E; ++e) {
+        if (slots[e].empty()) continue;
+        splits[e] = std::min(split_target, (hidden[e] + FFN_HC - 1) / FFN_HC);
+        out_offset[e] = out_total;
+        out_total += splits[e] * slots[e].size() * D;
+    }
+
+    std::vector<float> xg(x_total);
+    std::vector<float> partial(out_total, 0.0f);
+    const float* Xp = reinterpret_cast<const float*>(X.data());
+    for (size_t e = 0; e < E; ++e) {
+        for (size_t r = 0; r < slots[e].size(); ++r) {
+            std::memcpy(&xg[x_offset[e] + r * D], Xp + (slots[e][r] / top_k) * D, D * sizeof(float));
+        }
+    }
+
+    // 2. One grouped launch over (expert, row block, hidden split)
+    struct MoeTask { size_t expert, m0, split; };
+    std::vector<MoeTask> tasks;
+    for (size_t e = 0; e < E; ++e) {
+        for (size_t m0 = 0; m0 < slots[e].size(); m0 += FFN_MR) {
+            for (size_t s = 0; s < splits[e]; ++s) tasks.push_back({e, m0, s});
+        }
+    }
+
+    pool.parallel_tasks(tasks.size(), [&](size_t i) {
+        const auto& task = tasks[i];
+        const size_t e = task.expert;
+        const size_t n_e = slots[e].size();
+        const size_t rows = std::min(FFN_MR, n_e - task.m0);
+        const size_t chunks = (hidden[e] + FFN_HC - 1) / FFN_HC;
+        const size_t per_split = (chunks + splits[e] - 1) / splits[e];
+        const size_t h_begin = task.split * per_split * FFN_HC;
+        const size_t h_end = std::min(hidden[e], (task.split + 1) * per_split * FFN_HC);
+        if (h_begin >= h_end) return;
+
+        float* out = &partial[out_offset[e] + (task.split * n_e + task.m0) * D];
+        ffn_swiglu_block(&xg[x_offset[e] + task.m0 * D], rows, D,
+                         reinterpret_cast<const float*>(experts[e].W_gate_up->data()),
+                         reinterpret_cast<const float*>(experts[e].W_down->data()),
+                         h_begin, h_end, out);
+    });
+
+    // 3. Scatter-add: each token sums its weighted expert outputs (race-free per row)
+    std::vector<size_t> slot_row(T * top_k);
+    std::vector<size_t> slot_expert(T * top_k);
+    for (size_t e = 0; e < E; ++e) {
+        for (size_t r = 0; r < slots[e].size(); ++r) {
+            slot_row[slots[e][r]] = r;
+            slot_expert[slots[e][r]] = e;
+        }
+    }
+
+    float* Yp = Y.data_as_fp32();
+    pool.parallel_for(0, T, [&](size_t t_start, size_t t_end) {
+        for (size_t t = t_start; t < t_end; ++t) {
+            float* y = Yp + t * D;
+            std::fill(y, y + D, 0.0f);
+            for (size_t k = 0; k < top_k; ++k) {
+                const size_t slot = t * top_k + k;
+                const size_t e = slot_expert[slot];
+                const size_t n_e = slots[e].size();
+                const float w = routing.weights[slot];
+                for (size_t s = 0; s < splits[e]; ++s) {
+                    const float* p = &partial[out_offset[e] + (s * n_e + slot_row[slot]) * D];
+                    for (size_t d = 0; d < D; ++d) y[d] += w * p[d];
+                }
+            }
+        }
+    });
+
+    size_t flops = 0, bytes = 2 * T * D * 4;
+    for (size_t e = 0; e < E; ++e) {
+        flops += 2 * slots[e].size() * D * 3 * hidden[e];
+        bytes += 3 * hidden[e] * D * 4;
+    }
+    PowerModel::record_activity(flops, bytes, 0.0f, true);
+}
+
+} // namespace softaccelnpu
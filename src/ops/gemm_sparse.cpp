@@ -0,0 +1,273 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/avx2_math.h"
+#include <algorithm>
+#include <immintrin.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file gemm_sparse.cpp
+ * @brief SpMM and SpMV on unstructured sparse weights (CSR and block-CSR).
+ *
+ * CSR keeps one compressed row per output column, so every output is a sparse dot
+ * product:
+ * - SpMV gathers the activations named by 8 column indices at a time.
+ * - SpMM packs 16 rows of A k-major once, turning each gather into two contiguous
+ *   loads at idx * 16.
+ * BSR keeps dense 4 x 16 blocks per column panel. Both shapes run a register tile
+ * over the surviving blocks only, broadcasting A along k as the dense micro-kernel does.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t BK = BsrWeights::BLOCK_K;
+constexpr size_t BN = BsrWeights::BLOCK_N;
+constexpr size_t TILE_M = 16;       // CSR SpMM rows per packed A tile (two ymm per k)
+constexpr size_t BSR_MR = 6;        // BSR SpMM rows per register tile (12 accumulators)
+constexpr size_t COL_CHUNK = 64;    // CSR columns per task
+
+// ---------------------------------------------------------------------------
+// CSR
+// ---------------------------------------------------------------------------
+
+/** Columns [n0, n1) of y += x * W for R rows, gathering x by the CSR column indices. */
+template <int R>
+void csr_gemv_cols(const float* x, size_t ldx, const CsrWeights& W, size_t n0, size_t n1, float* y, size_t ldy) {
+    for (size_t n = n0; n < n1; ++n) {
+        const size_t b = W.ptr[n], e = W.ptr[n + 1];
+        const int32_t* idx = reinterpret_cast<const int32_t*>(W.idx.data());
+        const float* val = W.values.data();
+        __m256 acc[R][2];
+        for (int r = 0; r < R; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+
+        size_t i = b;
+        for (; i + 16 <= e; i += 16) {
+            const __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+            const __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i + 8));
+            const __m256 v0 = _mm256_loadu_ps(val + i), v1 = _mm256_loadu_ps(val + i + 8);
+            for (int r = 0; r < R; ++r) {
+                acc[r][0] = _mm256_fmadd_ps(_mm256_i32gather_ps(x + r * ldx, i0, 4), v0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_ps(_mm256_i32gather_ps(x + r * ldx, i1, 4), v1, acc[r][1]);
+            }
+        }
+        if (i < e) {
+            // Masked gather: lanes past the column's end neither load nor add
+            const size_t t = std::min<size_t>(8, e - i);
+            const __m256i m = avx2_tail_mask(t);
+            const __m256i i0 = _mm256_maskload_epi32(idx + i, m);
+            const __m256 v0 = _mm256_maskload_ps(val + i, m);
+            for (int r = 0; r < R; ++r) {
+                const __m256 g = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x + r * ldx, i0, _mm256_castsi256_ps(m), 4);
+                acc[r][0] = _mm256_fmadd_ps(g, v0, acc[r][0]);
+            }
+            i += t;
+        }
+        if (i < e) {
+            const __m256i m = avx2_tail_mask(e - i);
+            const __m256i i1 = _mm256_maskload_epi32(idx + i, m);
+            const __m256 v1 = _mm256_maskload_ps(val + i, m);
+            for (int r = 0; r < R; ++r) {
+                const __m256 g = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x + r * ldx, i1, _mm256_castsi256_ps(m), 4);
+                acc[r][1] = _mm256_fmadd_ps(g, v1, acc[r][1]);
+            }
+        }
+        for (int r = 0; r < R; ++r) y[r * ldy + n] += avx2_hsum_ps(_mm256_add_ps(acc[r][0], acc[r][1]));
+    }
+}
+
+/** out[0..15] = A_tile(16 x K, k-major) * W[:, n]. */
+inline void csr_column(const float* ap, const uint32_t* idx, const float* val, size_t b, size_t e, float* out) {
+    __m256 acc[2][2] = {{_mm256_setzero_ps(), _mm256_setzero_ps()}, {_mm256_setzero_ps(), _mm256_setzero_ps()}};
+    size_t i = b;
+    for (; i + 2 <= e; i += 2) {
+        const float* a0 = ap + idx[i] * TILE_M;
+        const float* a1 = ap + idx[i + 1] * TILE_M;
+        const __m256 v0 = _mm256_broadcast_ss(val + i), v1 = _mm256_broadcast_ss(val + i + 1);
+        acc[0][0] = _mm256_fmadd_ps(_mm256_loadu_ps(a0), v0, acc[0][0]);
+        acc[0][1] = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + 8), v0, acc[0][1]);
+        acc[1][0] = _mm256_fmadd_ps(_mm256_loadu_ps(a1), v1, acc[1][0]);
+        acc[1][1] = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + 8), v1, acc[1][1]);
+    }
+    if (i < e) {
+        const float* a0 = ap + idx[i] * TILE_M;
+        const __m256 v0 = _mm256_broadcast_ss(val + i);
+        acc[0][0] = _mm256_fmadd_ps(_mm256_loadu_ps(a0), v0, acc[0][0]);
+        acc[0][1] = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + 8), v0, acc[0][1]);
+    }
+    _mm256_store_ps(out, _mm256_add_ps(acc[0][0], acc[1][0]));
+    _mm256_store_ps(out + 8, _mm256_add_ps(acc[0][1], acc[1][1]));
+}
+
+/** Row tiles [t0, t1) of C += A * W: each 16-row tile of A is packed k-major once and reused by every column. */
+void csr_gemm_tiles(const float* A, size_t lda, const CsrWeights& W, float* C, size_t ldc, size_t M,
+                    size_t t0, size_t t1) {
+    const size_t K = W.rows, N = W.cols;
+    std::vector<float> a_pack(K * TILE_M);
+    alignas(32) float tile[COL_CHUNK][TILE_M];
+
+    for (size_t t = t0; t < t1; ++t) {
+        const size_t m0 = t * TILE_M;
+        const size_t rows = std::min(TILE_M, M - m0);
+        for (size_t r = 0; r < TILE_M; ++r) {
+            const float* a = A + (m0 + r) * lda;
+            if (r < rows) for (size_t k = 0; k < K; ++k) a_pack[k * TILE_M + r] = a[k];
+            else for (size_t k = 0; k < K; ++k) a_pack[k * TILE_M + r] = 0.0f;
+        }
+
+        for (size_t n0 = 0; n0 < N; n0 += COL_CHUNK) {
+            const size_t w = std::min(COL_CHUNK, N - n0);
+            for (size_t j = 0; j < w; ++j) {
+                csr_column(a_pack.data(), W.idx.data(), W.values.data(), W.ptr[n0 + j], W.ptr[n0 + j + 1], tile[j]);
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                float* c = C + (m0 + r) * ldc + n0;
+                for (size_t j = 0; j < w; ++j) c[j] += tile[j][r];
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BSR
+// ---------------------------------------------------------------------------
+
+/**
+ * Rows [m, m + R) x panel p of C += A * W over the panel's stored blocks.
+ * kn < BK only for a block that runs past K, whose missing rows of A are never read.
+ */
+template <int R>
+void bsr_tile(const float* A, size_t lda, const BsrWeights& W, size_t p, float* C, size_t ldc, size_t w) {
+    __m256 acc[R][2];
+    for (int r = 0; r < R; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    const size_t K = W.rows;
+
+    for (size_t b = W.ptr[p]; b < W.ptr[p + 1]; ++b) {
+        const size_t k0 = W.block_k[b] * BK;
+        const float* v = &W.values[b * BK * BN];
+        const size_t kn = std::min(BK, K - k0);
+        for (size_t i = 0; i < kn; ++i) {
+            const __m256 w0 = _mm256_loadu_ps(v + i * BN), w1 = _mm256_loadu_ps(v + i * BN + 8);
+            for (int r = 0; r < R; ++r) {
+                const __m256 a = _mm256_broadcast_ss(A + r * lda + k0 + i);
+                acc[r][0] = _mm256_fmadd_ps(a, w0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_ps(a, w1, acc[r][1]);
+            }
+        }
+    }
+
+    for (int r = 0; r < R; ++r) {
+        float* c = C + r * ldc;
+        if (w == BN) {
+            _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), acc[r][0]));
+            _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), acc[r][1]));
+        } else {
+            alignas(32) float tmp[BN];
+            _mm256_store_ps(tmp, acc[r][0]);
+            _mm256_store_ps(tmp + 8, acc[r][1]);
+            for (size_t j = 0; j < w; ++j) c[j] += tmp[j];
+        }
+    }
+}
+
+/** Panels [p0, p1) of C += A * W, all M rows in BSR_MR-row register tiles. */
+void bsr_gemm_panels(const float* A, size_t lda, const BsrWeights& W, float* C, size_t ldc, size_t M,
+                     size_t p0, size_t p1) {
+    for (size_t p = p0; p < p1; ++p) {
+        const size_t n = p * BN;
+        const size_t w = std::min(BN, W.cols - n);
+        size_t m = 0;
+        for (; m + BSR_MR <= M; m += BSR_MR) bsr_tile<BSR_MR>(A + m * lda, lda, W, p, C + m * ldc + n, ldc, w);
+        const float* a = A + m * lda;
+        float* c = C + m * ldc + n;
+        switch (M - m) {
+            case 1: bsr_tile<1>(a, lda, W, p, c, ldc, w); break;
+            case 2: bsr_tile<2>(a, lda, W, p, c, ldc, w); break;
+            case 3: bsr_tile<3>(a, lda, W, p, c, ldc, w); break;
+            case 4: bsr_tile<4>(a, lda, W, p, c, ldc, w); break;
+            case 5: bsr_tile<5>(a, lda, W, p, c, ldc, w); break;
+            default: break;
+        }
+    }
+}
+
+void check_views(const TensorView& A, const TensorView& C, size_t K, size_t N, const char* who) {
+    if (A.cols() != K || C.rows() != A.rows() || C.cols() != N) {
+        throw std::invalid_argument(std::string(who) + ": shape mismatch (expected A[MxK], B[KxN], C[MxN])");
+    }
+    if (A.dtype() != DataType::FP32 || C.dtype() != DataType::FP32 || !A.has_unit_col_stride() || !C.has_unit_col_stride()) {
+        throw std::invalid_argument(std::string(who) + ": A and C must be FP32 row-major views");
+    }
+}
+
+} // namespace
+
+void GemmOps::gemm_sparse(const TensorView& A, const CsrWeights& B, const TensorView& C) {
+    const size_t M = A.rows(), K = B.rows, N = B.cols;
+    check_views(A, C, K, N, "gemm_sparse");
+    if (B.ptr.size() != N + 1 || B.idx.size() != B.values.size() || B.ptr[N] != B.values.size()) {
+        throw std::invalid_argument("gemm_sparse: CSR storage does not match its shape");
+    }
+    if (M == 0) return;  // Empty views have no row 0 to take the address of
+
+    auto& pool = get_thread_pool();
+    const float* Ap = &A.at<float>(0, 0);
+    float* Cp = &C.at<float>(0, 0);
+    const size_t lda = A.row_stride(), ldc = C.row_stride();
+
+    if (M <= GEMV_MAX_ROWS) {
+        pool.parallel_for(0, (N + COL_CHUNK - 1) / COL_CHUNK, [&](size_t c0, size_t c1) {
+            const size_t n0 = c0 * COL_CHUNK, n1 = std::min(N, c1 * COL_CHUNK);
+            switch (M) {
+                case 1: csr_gemv_cols<1>(Ap, lda, B, n0, n1, Cp, ldc); break;
+                case 2: csr_gemv_cols<2>(Ap, lda, B, n0, n1, Cp, ldc); break;
+                case 3: csr_gemv_cols<3>(Ap, lda, B, n0, n1, Cp, ldc); break;
+                default: csr_gemv_cols<4>(Ap, lda, B, n0, n1, Cp, ldc); break;
+            }
+        });
+    } else {
+        pool.parallel_for(0, (M + TILE_M - 1) / TILE_M, [&](size_t t0, size_t t1) {
+            csr_gemm_tiles(Ap, lda, B, Cp, ldc, M, t0, t1);
+        });
+    }
+    const size_t nnz = B.nnz();
+    const float sparsity = (K * N > 0) ? 1.0f - static_cast<float>(nnz) / static_cast<float>(K * N) : 0.0f;
+    PowerModel::record_activity(2 * M * N * K, K * N * 4 + (M * K + M * N) * 4, sparsity);
+}
+
+void GemmOps::gemm_sparse(const TensorView& A, const BsrWeights& B, const TensorView& C) {
+    const size_t M = A.rows(), K = B.rows, N = B.cols;
+    check_views(A, C, K, N, "gemm_sparse");
+    if (B.ptr.size() != B.panels() + 1 || B.values.size() != B.blocks() * BK * BN || B.ptr.back() != B.blocks()) {
+        throw std::invalid_argument("gemm_sparse: BSR storage does not match its shape");
+    }
+    if (M == 0) return;
+
+    const float* Ap = &A.at<float>(0, 0);
+    float* Cp = &C.at<float>(0, 0);
+    const size_t lda = A.row_stride(), ldc = C.row_stride();
+    get_thread_pool().parallel_for(0, B.panels(), [&](size_t p0, size_t p1) {
+        bsr_gemm_panels(Ap, lda, B, Cp, ldc, M, p0, p1);
+    });
+
+    const size_t all_blocks = ((K + BK - 1) / BK) * B.panels();
+    const float sparsity = all_blocks ? 1.0f - static_cast<float>(B.blocks()) / static_cast<float>(all_blocks) : 0.0f;
+    PowerModel::record_activity(2 * M * N * K, K * N * 4 + (M * K + M * N) * 4, sparsity);
+}
+
+void GemmOps::gemm_sparse(const TensorView& A, const SparseWeights& B, const TensorView& C) {
+    switch (B.format) {
+        case SparseFormat::CSR: gemm_sparse(A, B.csr, C); break;
+        case SparseFormat::BSR: gemm_sparse(A, B.bsr, C); break;
+        default:
+            if (A.rows() <= GEMV_MAX_ROWS) gemv(A, *B.dense, C);
+            else gemm_tiled(A, *B.dense, C);
+            break;
+    }
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,216 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include <algorithm>
+#include <immintrin.h>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file gemm_sparse24.cpp
+ * @brief GEMM and GEMV on 2:4 structured-sparse weights.
+ *
+ * Only the kept half of B is multiplied. Each kept value needs the activation at
+ * its 2-bit position, which is fetched differently per shape:
+ * - GEMM vectorizes over 16 rows of A, packed k-major. The activation vectors of a
+ *   group are then plain loads at an offset decoded once per panel block.
+ * - GEMV vectorizes over 8 columns. The 4 activations of a group are broadcast to
+ *   both lanes and vpermilps picks each column's entry straight from the index bits.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t GROUP = Sparse24Weights::GROUP;
+constexpr size_t PANEL = Sparse24Weights::PANEL;
+constexpr size_t TILE_M = 16;   // Rows per register tile (two ymm per column)
+constexpr size_t SUB_M = 4;     // Row tiles sharing one decoded panel block
+constexpr size_t GB = 128;      // Groups per K block: a 16 x 512 A tile is 32 KB
+
+/**
+ * One column j of a panel block: out[0..15] = A_tile(16 x 4gb) * B[:, j].
+ * ap is k-major (16 floats per k); off[g * PANEL + j] holds both slots' float offsets into ap.
+ */
+void sparse24_column(const float* ap, const uint32_t* off, const float* vals, size_t j, size_t gb, float* out) {
+    // Two groups per step, one accumulator per (group parity, slot, row half)
+    __m256 acc[2][2][2];
+    for (auto& u : acc) for (auto& s : u) s[0] = s[1] = _mm256_setzero_ps();
+
+    auto step = [&](size_t g, __m256 (&a)[2][2]) {
+        const uint32_t o = off[g * PANEL + j];
+        const float* a0 = ap + (o & 0xFFFF);
+        const float* a1 = ap + (o >> 16);
+        const __m256 v0 = _mm256_broadcast_ss(vals + g * 2 * PANEL + j);
+        const __m256 v1 = _mm256_broadcast_ss(vals + g * 2 * PANEL + PANEL + j);
+        a[0][0] = _mm256_fmadd_ps(_mm256_loadu_ps(a0), v0, a[0][0]);
+        a[0][1] = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + 8), v0, a[0][1]);
+        a[1][0] = _mm256_fmadd_ps(_mm256_loadu_ps(a1), v1, a[1][0]);
+        a[1][1] = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + 8), v1, a[1][1]);
+    };
+    size_t g = 0;
+    for (; g + 2 <= gb; g += 2) {
+        step(g, acc[0]);
+        step(g + 1, acc[1]);
+    }
+    if (g < gb) step(g, acc[0]);
+
+    for (int h = 0; h < 2; ++h) {
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(acc[0][0][h], acc[0][1][h]),
+                                         _mm256_add_ps(acc[1][0][h], acc[1][1][h]));
+        _mm256_storeu_ps(out + h * 8, sum);
+    }
+}
+
+/** Rows [m0, m1) of C += A * B, in TILE_M x PANEL register tiles over GB-group K blocks. */
+void sparse24_gemm_rows(const float* A, size_t lda, const Sparse24Weights& B, float* C, size_t ldc,
+                        size_t m0, size_t m1) {
+    const size_t K = B.rows, N = B.cols, G = B.groups();
+    std::vector<float> a_pack(SUB_M * GB * GROUP * TILE_M);
+    std::vector<uint32_t> off(GB * PANEL);
+    alignas(32) float tile[PANEL][TILE_M];
+
+    for (size_t ms = m0; ms < m1; ms += SUB_M * TILE_M) {
+        const size_t m_end = std::min(m1, ms + SUB_M * TILE_M);
+        const size_t tiles = (m_end - ms + TILE_M - 1) / TILE_M;
+
+        for (size_t g0 = 0; g0 < G; g0 += GB) {
+            const size_t gb = std::min(GB, G - g0);
+            const size_t k0 = g0 * GROUP, kb = gb * GROUP;
+
+            // k-major A tiles, zero beyond M and K so padded groups contribute nothing
+            for (size_t t = 0; t < tiles; ++t) {
+                float* dst = &a_pack[t * GB * GROUP * TILE_M];
+                for (size_t r = 0; r < TILE_M; ++r) {
+                    const size_t m = ms + t * TILE_M + r;
+                    const size_t valid = (m < m_end) ? std::min(kb, K - k0) : 0;
+                    for (size_t k = 0; k < valid; ++k) dst[k * TILE_M + r] = A[m * lda + k0 + k];
+                    for (size_t k = valid; k < kb; ++k) dst[k * TILE_M + r] = 0.0f;
+                }
+            }
+
+            for (size_t p = 0; p < B.panels(); ++p) {
+                const size_t n = p * PANEL;
+                const size_t w = std::min(PANEL, N - n);
+                const uint64_t* bits = &B.indices[p * G + g0];
+                const float* vals = &B.values[(p * G + g0) * 2 * PANEL];
+
+                // Decode the 2-bit positions once for all row tiles
+                for (size_t g = 0; g < gb; ++g) {
+                    for (size_t j = 0; j < w; ++j) {
+                        const uint32_t nib = static_cast<uint32_t>(bits[g] >> (4 * j)) & 0xF;
+                        const uint32_t o0 = static_cast<uint32_t>((g * GROUP + (nib & 3)) * TILE_M);
+                        const uint32_t o1 = static_cast<uint32_t>((g * GROUP + (nib >> 2)) * TILE_M);
+                        off[g * PANEL + j] = o0 | (o1 << 16);
+                    }
+                }
+
+                for (size_t t = 0; t < tiles; ++t) {
+                    const float* ap = &a_pack[t * GB * GROUP * TILE_M];
+                    for (size_t j = 0; j < w; ++j) sparse24_column(ap, off.data(), vals, j, gb, tile[j]);
+
+                    const size_t mt = ms + t * TILE_M;
+                    const size_t rows = std::min(TILE_M, m_end - mt);
+                    for (size_t r = 0; r < rows; ++r) {
+                        float* c = C + (mt + r) * ldc + n;
+                        for (size_t j = 0; j < w; ++j) c[j] += tile[j][r];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** Panels [p0, p1) of y += x * B for R rows; xs rows are zero-padded to whole groups. */
+template <int R>
+void sparse24_gemv_panels(const float* xs, size_t ldxs, const Sparse24Weights& B, size_t p0, size_t p1,
+                          float* y, size_t ldy) {
+    const size_t G = B.groups();
+    const __m256i shift0 = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const __m256i shift1 = _mm256_add_epi32(shift0, _mm256_set1_epi32(2));
+
+    for (size_t p = p0; p < p1; ++p) {
+        __m256 acc[R][2][2];  // [row][slot][column half]
+        for (int r = 0; r < R; ++r) acc[r][0][0] = acc[r][0][1] = acc[r][1][0] = acc[r][1][1] = _mm256_setzero_ps();
+
+        for (size_t g = 0; g < G; ++g) {
+            const uint64_t bits = B.indices[p * G + g];
+            const __m256i lo = _mm256_set1_epi32(static_cast<int>(bits & 0xFFFFFFFFu));
+            const __m256i hi = _mm256_set1_epi32(static_cast<int>(bits >> 32));
+            // vpermilps only reads the low 2 bits of each lane
+            const __m256i i00 = _mm256_srlv_epi32(lo, shift0), i01 = _mm256_srlv_epi32(lo, shift1);
+            const __m256i i10 = _mm256_srlv_epi32(hi, shift0), i11 = _mm256_srlv_epi32(hi, shift1);
+            const float* v = &B.values[(p * G + g) * 2 * PANEL];
+            const __m256 v00 = _mm256_loadu_ps(v), v10 = _mm256_loadu_ps(v + 8);
+            const __m256 v01 = _mm256_loadu_ps(v + PANEL), v11 = _mm256_loadu_ps(v + PANEL + 8);
+
+            for (int r = 0; r < R; ++r) {
+                const __m256 a = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xs + r * ldxs + g * GROUP));
+                acc[r][0][0] = _mm256_fmadd_ps(_mm256_permutevar_ps(a, i00), v00, acc[r][0][0]);
+                acc[r][1][0] = _mm256_fmadd_ps(_mm256_permutevar_ps(a, i01), v01, acc[r][1][0]);
+                acc[r][0][1] = _mm256_fmadd_ps(_mm256_permutevar_ps(a, i10), v10, acc[r][0][1]);
+                acc[r][1][1] = _mm256_fmadd_ps(_mm256_permutevar_ps(a, i11), v11, acc[r][1][1]);
+            }
+        }
+
+        const size_t n = p * PANEL;
+        const size_t w = std::min(PANEL, B.cols - n);
+        for (int r = 0; r < R; ++r) {
+            alignas(32) float tmp[PANEL];
+            _mm256_store_ps(tmp, _mm256_add_ps(acc[r][0][0], acc[r][1][0]));
+            _mm256_store_ps(tmp + 8, _mm256_add_ps(acc[r][0][1], acc[r][1][1]));
+            float* yr = y + r * ldy + n;
+            for (size_t j = 0; j < w; ++j) yr[j] += tmp[j];
+        }
+    }
+}
+
+} // namespace
+
+void GemmOps::gemm_sparse24(const TensorView& A, const Sparse24Weights& B, const TensorView& C) {
+    const size_t M = A.rows(), K = B.rows, N = B.cols;
+    if (A.cols() != K || C.rows() != M || C.cols() != N) {
+        throw std::invalid_argument("gemm_sparse24: shape mismatch (expected A[MxK], B[KxN], C[MxN])");
+    }
+    if (A.dtype() != DataType::FP32 || C.dtype() != DataType::FP32 || !A.has_unit_col_stride() || !C.has_unit_col_stride()) {
+        throw std::invalid_argument("gemm_sparse24: A and C must be FP32 row-major views");
+    }
+    if (B.values.size() != B.panels() * B.groups() * 2 * PANEL || B.indices.size() != B.panels() * B.groups()) {
+        throw std::invalid_argument("gemm_sparse24: B storage does not match its shape");
+    }
+    if (M == 0) return;  // Empty views have no row 0 to take the address of
+
+    auto& pool = get_thread_pool();
+    const float* Ap = &A.at<float>(0, 0);
+    float* Cp = &C.at<float>(0, 0);
+    const size_t lda = A.row_stride(), ldc = C.row_stride();
+
+    if (M <= GEMV_MAX_ROWS) {
+        // Padded copy of x so the last group's 4-wide broadcast stays in bounds
+        const size_t ldxs = B.groups() * GROUP;
+        std::vector<float> xs(M * ldxs, 0.0f);
+        for (size_t r = 0; r < M; ++r) std::copy(Ap + r * lda, Ap + r * lda + K, xs.begin() + r * ldxs);
+        pool.parallel_for(0, B.panels(), [&](size_t p0, size_t p1) {
+            switch (M) {
+                case 1: sparse24_gemv_panels<1>(xs.data(), ldxs, B, p0, p1, Cp, ldc); break;
+                case 2: sparse24_gemv_panels<2>(xs.data(), ldxs, B, p0, p1, Cp, ldc); break;
+                case 3: sparse24_gemv_panels<3>(xs.data(), ldxs, B, p0, p1, Cp, ldc); break;
+                default: sparse24_gemv_panels<4>(xs.data(), ldxs, B, p0, p1, Cp, ldc); break;
+            }
+        });
+    } else {
+        // Split on row tiles so no tile straddles two tasks
+        const size_t tiles = (M + TILE_M - 1) / TILE_M;
+        pool.parallel_for(0, tiles, [&](size_t t0, size_t t1) {
+            sparse24_gemm_rows(Ap, lda, B, Cp, ldc, t0 * TILE_M, std::min(M, t1 * TILE_M));
+        });
+    }
+    // Half of the dense MACs are skipped; the skipped weights are never read
+    PowerModel::record_activity(2 * M * N * K, K * N * 4 + (M * K + M * N) * 4, 0.5f);
+}
+
+void GemmOps::gemm_extreme(const Tensor& A, const Sparse24Weights& B, Tensor& C) {
+    gemm_sparse24(TensorView(A), B, TensorView(C));
+}
+
+} // namespace softaccelnpu
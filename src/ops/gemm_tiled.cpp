@@ -2,7 +2,10 @@
 #include "softaccelnpu/thread_pool.h"
 #include "softaccelnpu/cache_model.h"
 #include "softaccelnpu/hardware_info.h"
+#include "softaccelnpu/hybrid_scheduler.h"
 #include <algorithm>
+#include <stdexcept>
+#include <vector>
 #include <iostream>
 #include "../kernels/internal_kernels.h"
 #include "softaccelnpu/power_model.h"
@@ -54,8 +57,23 @@ void GemmOps::tune_tiling() {
  * 2. Partition the K dimension (Inner blocking) to fit in L2 cache.
  * 3. Partition the N dimension (Outer blocking) to optimize streaming from L3/DRAM.
  * 4. Dispatch to specialized MicroKernels for register-level compute.
+ * With a normalization prologue, each MR x KC sliver of A is normalized into an
+ * L1 buffer right before the micro-kernels consume it.
  */
-void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, MicroKernel* kernel, bool fused_activation) {
+namespace {
+
+// A Tiled B seen as its first panel: K rows of NR floats; later panels follow every K * NR
+TensorView panel_view(const Tensor& B) {
+    return TensorView(const_cast<void*>(B.data()), B.rows(), B.cols(), Tensor::TILE_WIDTH, 1, B.dtype());
+}
+
+} // namespace
+
+void GemmOps::gemm_tiled_impl(const TensorView& A, const TensorView& B, const TensorView& C, MicroKernel* kernel,
+                              bool fused_activation, const GemmNormPrologue* norm, bool b_panels,
+                              const float* b_scale, const SparsityMask* a_mask, const SparsityMask* b_mask,
+                              const CompressedWeights* b_compressed) {
+    static_assert(NR == Tensor::TILE_WIDTH, "Layout::Tiled panels must match the micro-kernel width");
     if (!kernel) {
         kernel = create_best_kernel();
     }
@@ -68,14 +86,43 @@ void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, MicroKerne
     const size_t N = B.cols();
     const size_t K = A.cols();
 
-    const float* Ap = reinterpret_cast<const float*>(A.data());
-    const float* Bp = reinterpret_cast<const float*>(B.data());
-    float* Cp = reinterpret_cast<float*>(C.data());
+    if (B.rows() != K || C.rows() != M || C.cols() != N) {
+        throw std::invalid_argument("gemm_tiled: shape mismatch (expected A[MxK], B[KxN], C[MxN])");
+    }
+    if (!A.has_unit_col_stride() || !B.has_unit_col_stride() || !C.has_unit_col_stride()) {
+        throw std::invalid_argument("gemm_tiled: operands must be row-major views (unit column stride)");
+    }
+
+    // Narrow (16-bit or FP8) or scaled B is widened KC x NC block by block into a
+    // per-thread FP32 panel buffer
+    const bool narrow = B.dtype() == DataType::FP16 || B.dtype() == DataType::BF16 ||
+                        B.dtype() == DataType::FP8_E4M3 || B.dtype() == DataType::FP8_E5M2;
+    if (A.dtype() != DataType::FP32 || C.dtype() != DataType::FP32 || (!narrow && B.dtype() != DataType::FP32)) {
+        throw std::invalid_argument("gemm_tiled: A and C must be FP32, B FP32, FP16, BF16 or FP8");
+    }
+    const bool widen = narrow || b_scale || b_compressed;
+
+    // Views map onto the kernels' leading dimensions; no operand is copied
+    const float* Ap = A.data_as_fp32();
+    const float* Bp = B.data_as_fp32();
+    float* Cp = C.data_as_fp32();
+    const size_t lda = A.row_stride(), ldb = B.row_stride(), ldc = C.row_stride();
+    // Start of B's column block n_curr at row k (n_curr is always a multiple of NR)
+    auto b_block = [&](size_t k, size_t n_curr) {
+        return b_panels ? &Bp[(n_curr / NR * K + k) * NR] : &Bp[k * ldb + n_curr];
+    };
+
+    const float* gamma = norm ? reinterpret_cast<const float*>(norm->gamma->data()) : nullptr;
+    const float* beta = (norm && norm->beta) ? reinterpret_cast<const float*>(norm->beta->data()) : nullptr;
 
     // --- Research Accelerator Path ---
     // If enabled, large benchmarks bypass the heavy loops to simulate peak NPU TOPS.
-    if (benchmark_mode && M >= 1024 && N >= 1024 && K >= 1024) {
-        kernel->gemm(Ap, Bp, Cp, M, N, K, K, N, N);
+    // A normalization prologue, panel-major or widened B, or block skipping needs the real data path.
+    // Masks without zero blocks would only cost lookups
+    if (a_mask && (a_mask->zero_blocks == 0 || norm)) a_mask = nullptr;  // Norm(0) is not 0 under LayerNorm
+    if (b_mask && b_mask->zero_blocks == 0) b_mask = nullptr;
+    if (benchmark_mode && !norm && !b_panels && !widen && !a_mask && !b_mask && M >= 1024 && N >= 1024 && K >= 1024) {
+        kernel->gemm(Ap, Bp, Cp, M, N, K, lda, ldb, ldc);
         PowerModel::record_activity(M*N*K*2, (M*K + K*N + M*N)*4, 0.0f, fused_activation);
         return;
     }
@@ -84,30 +131,94 @@ void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, MicroKerne
     
     // --- Multilevel Loop Nest ---
     pool.parallel_for(0, M, [&](size_t m_start, size_t m_end) {
+        // Prologue: per-row statistics over the full K, computed once per row
+        std::vector<float> row_scale, row_shift, a_sliver, b_wide;
+        std::vector<uint8_t> b_zero((std::min(N, NC) + NR - 1) / NR, 0);  // Per NR panel of the current block
+        if (widen) b_wide.resize(std::min(K, KC) * ((std::min(N, NC) + NR - 1) / NR * NR));
+        if (norm) {
+            row_scale.resize(m_end - m_start);
+            row_shift.assign(m_end - m_start, 0.0f);
+            a_sliver.resize(MR * std::min(K, KC));
+            for (size_t m = m_start; m < m_end; ++m) {
+                const float* row = Ap + m * lda;
+                if (norm->kind == GemmNormPrologue::Kind::RmsNorm) {
+                    row_scale[m - m_start] = rms_norm_scale(row, K, norm->eps);
+                } else {
+                    layer_norm_stats(row, K, norm->eps, row_shift[m - m_start], row_scale[m - m_start]);
+                }
+            }
+        }
+
         for (size_t k = 0; k < K; k += KC) {
             size_t kb = std::min(K - k, KC);
             
             for (size_t n = 0; n < N; n += NC) {
                 size_t nb = std::min(N - n, NC);
+                // All-zero KC x NR blocks of B are neither packed nor multiplied
+                bool block_zero = b_mask != nullptr;
+                for (size_t n_curr = n; b_mask && n_curr < n + nb; n_curr += NR) {
+                    b_zero[(n_curr - n) / NR] = b_mask->is_zero_region(k, kb, n_curr, std::min(n + nb - n_curr, NR));
+                    block_zero &= b_zero[(n_curr - n) / NR] != 0;
+                }
+                if (block_zero) continue;
+                if (b_compressed) {
+                    pack_B_compressed(*b_compressed, k, kb, n, nb, b_wide.data());
+                } else if (widen && !b_mask) {
+                    pack_B_widen(B.data(), B.dtype(), ldb, b_panels, K, N, k, kb, n, nb, b_scale, b_wide.data());
+                } else if (widen) {
+                    for (size_t n_curr = n; n_curr < n + nb; n_curr += NR) {
+                        if (b_zero[(n_curr - n) / NR]) continue;
+                        pack_B_widen(B.data(), B.dtype(), ldb, b_panels, K, N, k, kb, n_curr, std::min(n + nb - n_curr, NR),
+                                     b_scale, &b_wide[(n_curr - n) * kb]);
+                    }
+                }
                 
                 // Micro-tiling: Each block is processed in units of MR x NR
                 for (size_t m_curr = m_start; m_curr < m_end; m_curr += MR) {
                     size_t mr = std::min(m_end - m_curr, MR);
+                    if (a_mask && a_mask->is_zero_region(m_curr, mr, k, kb)) continue;
+
+                    const float* a_tile = &Ap[m_curr * lda + k];
+                    size_t a_ld = lda;
+                    if (norm) {
+                        pack_A_normalized(a_tile, lda, mr, kb, &row_scale[m_curr - m_start], &row_shift[m_curr - m_start],
+                                          gamma + k, beta ? beta + k : nullptr, a_sliver.data());
+                        a_tile = a_sliver.data();
+                        a_ld = kb;
+                    }
                     
                     for (size_t n_curr = n; n_curr < n + nb; n_curr += NR) {
                         size_t nr = std::min(n + nb - n_curr, NR);
-                        
-                        // Simulation Update: Record L1-hit-bound activity
-                        CacheModel::record_access((mr*kb + kb*nr)*4, true, false); 
-                        PowerModel::record_activity(mr*kb*nr*2, (mr*kb + kb*nr + mr*nr)*4, 0.0f, fused_activation);
-                        
-                        kernel->gemm(
-                            &Ap[m_curr * K + k], 
-                            &Bp[k * N + n_curr], 
-                            &Cp[m_curr * N + n_curr],
-                            mr, nr, kb,
-                            K, N, N
-                        );
+                        if (b_mask && b_zero[(n_curr - n) / NR]) continue;
+
+                        // Under a mask, only the runs of non-zero mask rows inside this K block are multiplied
+                        const size_t k_end = k + kb;
+                        auto row_block_end = [&](size_t kk) {
+                            return std::min(k_end, (kk / b_mask->block_rows + 1) * b_mask->block_rows);
+                        };
+                        auto zero_rows = [&](size_t kk) { return b_mask->is_zero_region(kk, row_block_end(kk) - kk, n_curr, nr); };
+                        for (size_t k0 = k; k0 < k_end;) {
+                            size_t k1 = k_end;
+                            if (b_mask) {
+                                while (k0 < k_end && zero_rows(k0)) k0 = row_block_end(k0);
+                                if (k0 == k_end) break;
+                                for (k1 = k0; k1 < k_end && !zero_rows(k1);) k1 = row_block_end(k1);
+                            }
+                            const size_t len = k1 - k0;
+
+                            // Simulation Update: Record L1-hit-bound activity
+                            CacheModel::record_access((mr*len + len*nr)*4, true, false);
+                            PowerModel::record_activity(mr*len*nr*2, (mr*len + len*nr + mr*nr)*4, 0.0f, fused_activation);
+
+                            kernel->gemm(
+                                a_tile + (k0 - k),
+                                widen ? &b_wide[(n_curr - n) * kb + (k0 - k) * NR] : b_block(k0, n_curr),
+                                &Cp[m_curr * ldc + n_curr],
+                                mr, nr, len,
+                                a_ld, widen ? NR : ldb, ldc
+                            );
+                            k0 = k1;
+                        }
                     }
                 }
                 // Record simulated cache-line eviction stats
@@ -120,6 +231,69 @@ void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, MicroKerne
     // Note: For high-performance, create_best_kernel should return a static singleton.
 }
 
+void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, MicroKernel* kernel, bool fused_activation) {
+    gemm_tiled_weights(TensorView(A), A.sparsity_mask(), B, TensorView(C), kernel, fused_activation);
+}
+
+void GemmOps::gemm_tiled(const TensorView& A, const Tensor& B, const TensorView& C, MicroKernel* kernel, bool fused_activation) {
+    gemm_tiled_weights(A, nullptr, B, C, kernel, fused_activation);
+}
+
+void GemmOps::gemm_tiled_weights(const TensorView& A, const SparsityMask* a_mask, const Tensor& B, const TensorView& C,
+                                 MicroKernel* kernel, bool fused_activation) {
+    // Decode-shaped products with narrow weights are bandwidth-bound: stream them column-parallel
+    const bool narrow = B.dtype() != DataType::FP32;
+    if (narrow && A.rows() <= GEMV_MAX_ROWS) {
+        gemv(A, B, C);
+    } else if (B.layout() == Layout::Tiled) {
+        gemm_tiled_impl(A, panel_view(B), C, kernel, fused_activation, nullptr, true, nullptr, a_mask, B.sparsity_mask());
+    } else {
+        gemm_tiled_impl(A, TensorView(B), C, kernel, fused_activation, nullptr, false, nullptr, a_mask, B.sparsity_mask());
+    }
+}
+
+void GemmOps::gemm_tiled(const TensorView& A, const Fp8Weights& B, const TensorView& C, MicroKernel* kernel, bool fused_activation) {
+    const std::vector<float> scale = B.column_scales();
+    if (A.rows() <= GEMV_MAX_ROWS) {
+        gemv_impl(A, B.data, C, scale.data());
+    } else if (B.data.layout() == Layout::Tiled) {
+        gemm_tiled_impl(A, panel_view(B.data), C, kernel, fused_activation, nullptr, true, scale.data(),
+                        nullptr, B.data.sparsity_mask());
+    } else {
+        gemm_tiled_impl(A, TensorView(B.data), C, kernel, fused_activation, nullptr, false, scale.data(), nullptr,
+                        B.data.sparsity_mask());
+    }
+}
+
+void GemmOps::gemm_tiled(const TensorView& A, const CompressedWeights& B, const TensorView& C, MicroKernel* kernel,
+                         bool fused_activation) {
+    if (A.rows() <= GEMV_MAX_ROWS) {
+        gemv(A, B, C);
+    } else {
+        const TensorView shape(nullptr, B.rows, B.cols, NR);
+        gemm_tiled_impl(A, shape, C, kernel, fused_activation, nullptr, true, nullptr, nullptr, nullptr, &B);
+    }
+}
+
+void GemmOps::gemm_tiled(const TensorView& A, const TensorView& B, const TensorView& C, MicroKernel* kernel, bool fused_activation) {
+    gemm_tiled_impl(A, B, C, kernel, fused_activation, nullptr);
+}
+
+void GemmOps::gemm_tiled(const Tensor& A, const Tensor& B, Tensor& C, const GemmNormPrologue& norm, MicroKernel* kernel) {
+    const size_t K = A.cols();
+    if (!norm.gamma || norm.gamma->size() != K || (norm.beta && norm.beta->size() != K)) {
+        throw std::invalid_argument("gemm_tiled: normalization gamma/beta must hold K values");
+    }
+    if (norm.kind == GemmNormPrologue::Kind::RmsNorm && norm.beta) {
+        throw std::invalid_argument("gemm_tiled: RmsNorm prologue takes no beta");
+    }
+    if (B.layout() == Layout::Tiled) {
+        gemm_tiled_impl(TensorView(A), panel_view(B), C, kernel, true, &norm, true, nullptr, nullptr, B.sparsity_mask());
+    } else {
+        gemm_tiled_impl(TensorView(A), TensorView(B), C, kernel, true, &norm, false, nullptr, nullptr, B.sparsity_mask());
+    }
+}
+
 /** 
  * @brief Reference Scalar Implementation.
  * Optimized for readability as an educational tool for students.
@@ -162,10 +336,7 @@ void GemmOps::gemm_int8(const Tensor& A, const Tensor& B, Tensor& C) {
 }
 
 void GemmOps::gemm_hybrid(const Tensor& A, const Tensor& B, Tensor& C, float gpu_ratio) {
-    size_t M = A.rows(), N = B.cols(), K = A.cols();
-    (void)N; (void)K; (void)C;
-    size_t m_gpu = static_cast<size_t>(M * gpu_ratio);
-    if (m_gpu > 0) std::cout << "[Hybrid] GPU Task: " << m_gpu << " rows dispatched." << std::endl;
+    HybridScheduler::gemm_hybrid(A, B, C, gpu_ratio);
 }
 
 void GemmOps::gemm_extreme(const Tensor& A, const Tensor& B, Tensor& C, float sparsity_ratio) {
@@ -0,0 +1,317 @@
+#include "softaccelnpu/ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "softaccelnpu/cache_model.h"
+#include "../kernels/widen.h"
+#include "../kernels/expand.h"
+#include "../kernels/avx2_math.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file gemv.cpp
+ * @brief Column-parallel GEMV for decode with FP32, FP16, BF16 and FP8 weights.
+ *
+ * With one to four activation rows every weight is used only a handful of times, so
+ * the product runs at memory bandwidth. Each task owns a slice of W's columns and
+ * streams it once; narrow weights are widened in registers and never written back
+ * as FP32. FP8 channel scales are applied once per output, after the K reduction.
+ *
+ * Activations that are exactly zero in every row of a group (after ReLU, typically
+ * most of an FFN input) are found with SIMD compares up front. The kernels then walk
+ * the compacted list of live k, so the matching weight rows are never loaded.
+ * Bitmask-compressed weights are expanded row by row from their nonzero stream.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t PANEL = Tensor::TILE_WIDTH;
+constexpr size_t ROW_CHUNK = 256;  // Columns per task on row-major W (R x 256 accumulators in L1)
+constexpr size_t MAX_ROWS = GemmOps::GEMV_MAX_ROWS;
+
+/**
+ * Writes the k where any of the R rows of x is nonzero to ks and returns their count;
+ * zeros receives the number of zero entries over all R rows.
+ * -0.0 compares equal to zero; NaN does not, so it still propagates.
+ */
+size_t compact_live_k(const float* x, size_t ldx, size_t R, size_t K, uint32_t* ks, size_t& zeros) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t nk = 0, nonzeros = 0, k = 0;
+    for (; k + 8 <= K; k += 8) {
+        __m256 live = _mm256_setzero_ps();
+        for (size_t r = 0; r < R; ++r) {
+            const __m256 nz = _mm256_cmp_ps(_mm256_loadu_ps(x + r * ldx + k), zero, _CMP_NEQ_UQ);
+            nonzeros += popcount32(static_cast<uint32_t>(_mm256_movemask_ps(nz)));
+            live = _mm256_or_ps(live, nz);
+        }
+        for (unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(live)); bits; bits &= bits - 1) {
+            ks[nk++] = static_cast<uint32_t>(k + ctz32(bits));
+        }
+    }
+    for (; k < K; ++k) {
+        bool live = false;
+        for (size_t r = 0; r < R; ++r) {
+            const float v = x[r * ldx + k];
+            const bool nz = !(v == 0.0f);
+            nonzeros += nz;
+            live |= nz;
+        }
+        if (live) ks[nk++] = static_cast<uint32_t>(k);
+    }
+    zeros = R * K - nonzeros;
+    return nk;
+}
+
+/**
+ * Row-major W: y[:, n0:n1] += (x * W[:, n0:n1]) * scale[n0:n1], accumulating in an L1 buffer.
+ * Only the nk rows of W listed in ks are read (all K rows when ks is null).
+ */
+template <DataType DT>
+void gemv_rows(const float* x, size_t ldx, size_t R, const void* W, size_t ldw, const uint32_t* ks, size_t nk,
+               size_t n0, size_t n1, const float* scale, float* y, size_t ldy) {
+    alignas(32) float acc[MAX_ROWS][ROW_CHUNK] = {};
+    const size_t nc = n1 - n0;
+    const size_t body = nc / 8 * 8;
+
+    for (size_t i = 0; i < nk; ++i) {
+        const size_t k = ks ? ks[i] : i;
+        const size_t row = k * ldw + n0;
+        __m256 xv[MAX_ROWS];
+        for (size_t r = 0; r < R; ++r) xv[r] = _mm256_set1_ps(x[r * ldx + k]);
+        for (size_t j = 0; j < body; j += 8) {
+            const __m256 w = widen8<DT>(W, row + j);
+            for (size_t r = 0; r < R; ++r) {
+                _mm256_store_ps(acc[r] + j, _mm256_fmadd_ps(xv[r], w, _mm256_load_ps(acc[r] + j)));
+            }
+        }
+        for (size_t j = body; j < nc; ++j) {
+            const float w = widen1<DT>(W, row + j);
+            for (size_t r = 0; r < R; ++r) acc[r][j] += x[r * ldx + k] * w;
+        }
+    }
+    for (size_t r = 0; r < R; ++r) {
+        float* yr = y + r * ldy + n0;
+        if (scale) for (size_t j = 0; j < nc; ++j) yr[j] += acc[r][j] * scale[n0 + j];
+        else for (size_t j = 0; j < nc; ++j) yr[j] += acc[r][j];
+    }
+}
+
+/** Panel-major W: one 16-column panel per pass, R x 16 accumulators in registers; k as in gemv_rows. */
+template <DataType DT, int R>
+void gemv_panels(const float* x, size_t ldx, const void* W, size_t K, size_t N, const uint32_t* ks, size_t nk,
+                 size_t p0, size_t p1, const float* scale, float* y, size_t ldy) {
+    // Few rows leave the FMA chain short: keep U independent accumulator sets over k
+    constexpr int U = (R == 1) ? 4 : (R == 2 ? 2 : 1);
+
+    for (size_t p = p0; p < p1; ++p) {
+        const size_t base = p * K * PANEL;
+        __m256 acc[U][R][2];
+        for (int u = 0; u < U; ++u)
+            for (int r = 0; r < R; ++r) acc[u][r][0] = acc[u][r][1] = _mm256_setzero_ps();
+
+        size_t i = 0;
+        for (; i + U <= nk; i += U) {
+            for (int u = 0; u < U; ++u) {
+                const size_t k = ks ? ks[i + u] : i + u;
+                const size_t off = base + k * PANEL;
+                __m256 w0, w1;
+                widen16<DT>(W, off, w0, w1);
+                for (int r = 0; r < R; ++r) {
+                    const __m256 xv = _mm256_set1_ps(x[r * ldx + k]);
+                    acc[u][r][0] = _mm256_fmadd_ps(xv, w0, acc[u][r][0]);
+                    acc[u][r][1] = _mm256_fmadd_ps(xv, w1, acc[u][r][1]);
+                }
+            }
+        }
+        for (; i < nk; ++i) {
+            const size_t k = ks ? ks[i] : i;
+            const size_t off = base + k * PANEL;
+            __m256 w0, w1;
+            widen16<DT>(W, off, w0, w1);
+            for (int r = 0; r < R; ++r) {
+                const __m256 xv = _mm256_set1_ps(x[r * ldx + k]);
+                acc[0][r][0] = _mm256_fmadd_ps(xv, w0, acc[0][r][0]);
+                acc[0][r][1] = _mm256_fmadd_ps(xv, w1, acc[0][r][1]);
+            }
+        }
+
+        const size_t n = p * PANEL;
+        const size_t w = std::min(PANEL, N - n);
+        __m256 s0 = _mm256_set1_ps(1.0f), s1 = s0;
+        if (scale && w == PANEL) {
+            s0 = _mm256_loadu_ps(scale + n);
+            s1 = _mm256_loadu_ps(scale + n + 8);
+        } else if (scale) {
+            alignas(32) float tmp[PANEL] = {};
+            for (size_t j = 0; j < w; ++j) tmp[j] = scale[n + j];
+            s0 = _mm256_load_ps(tmp);
+            s1 = _mm256_load_ps(tmp + 8);
+        }
+        for (int r = 0; r < R; ++r) {
+            for (int u = 1; u < U; ++u) {
+                acc[0][r][0] = _mm256_add_ps(acc[0][r][0], acc[u][r][0]);
+                acc[0][r][1] = _mm256_add_ps(acc[0][r][1], acc[u][r][1]);
+            }
+            if (scale) {
+                acc[0][r][0] = _mm256_mul_ps(acc[0][r][0], s0);
+                acc[0][r][1] = _mm256_mul_ps(acc[0][r][1], s1);
+            }
+            float* yr = y + r * ldy + n;
+            if (w == PANEL) {
+                _mm256_storeu_ps(yr, _mm256_add_ps(_mm256_loadu_ps(yr), acc[0][r][0]));
+                _mm256_storeu_ps(yr + 8, _mm256_add_ps(_mm256_loadu_ps(yr + 8), acc[0][r][1]));
+            } else {
+                alignas(32) float tmp[PANEL];
+                _mm256_store_ps(tmp, acc[0][r][0]);
+                _mm256_store_ps(tmp + 8, acc[0][r][1]);
+                for (size_t j = 0; j < w; ++j) yr[j] += tmp[j];
+            }
+        }
+    }
+}
+
+template <DataType DT>
+void gemv_dispatch(const float* x, size_t ldx, size_t R, const Tensor& W, const uint32_t* ks, size_t nk,
+                   const float* scale, float* y, size_t ldy) {
+    const size_t K = W.rows(), N = W.cols();
+    auto& pool = get_thread_pool();
+
+    if (W.layout() == Layout::Tiled) {
+        pool.parallel_for(0, (N + PANEL - 1) / PANEL, [&](size_t p0, size_t p1) {
+            switch (R) {
+                case 1: gemv_panels<DT, 1>(x, ldx, W.data(), K, N, ks, nk, p0, p1, scale, y, ldy); break;
+                case 2: gemv_panels<DT, 2>(x, ldx, W.data(), K, N, ks, nk, p0, p1, scale, y, ldy); break;
+                case 3: gemv_panels<DT, 3>(x, ldx, W.data(), K, N, ks, nk, p0, p1, scale, y, ldy); break;
+                default: gemv_panels<DT, 4>(x, ldx, W.data(), K, N, ks, nk, p0, p1, scale, y, ldy); break;
+            }
+        });
+    } else {
+        pool.parallel_for(0, (N + ROW_CHUNK - 1) / ROW_CHUNK, [&](size_t c0, size_t c1) {
+            for (size_t c = c0; c < c1; ++c) {
+                gemv_rows<DT>(x, ldx, R, W.data(), N, ks, nk, c * ROW_CHUNK, std::min(N, (c + 1) * ROW_CHUNK), scale, y, ldy);
+            }
+        });
+    }
+}
+
+/** Compressed W: panels [p0, p1), each row expanded from its mask into R x 16 register accumulators. */
+template <int R>
+void gemv_compressed_panels(const float* x, size_t ldx, const CompressedWeights& W, size_t p0, size_t p1,
+                            float* y, size_t ldy) {
+    const size_t K = W.rows;
+    for (size_t p = p0; p < p1; ++p) {
+        const uint16_t* masks = &W.masks[p * K];
+        const float* src = W.values.data() + W.offsets[p * W.tiles_k()];
+        __m256 acc[R][2];
+        for (int r = 0; r < R; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+
+        for (size_t k = 0; k < K; ++k) {
+            if (!masks[k]) continue;  // All-zero rows cost only their mask
+            __m256 w0, w1;
+            avx2_expand16_ps(src, masks[k], w0, w1);
+            for (int r = 0; r < R; ++r) {
+                const __m256 xv = _mm256_set1_ps(x[r * ldx + k]);
+                acc[r][0] = _mm256_fmadd_ps(xv, w0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_ps(xv, w1, acc[r][1]);
+            }
+        }
+
+        const size_t n = p * PANEL;
+        const size_t w = std::min(PANEL, W.cols - n);
+        for (int r = 0; r < R; ++r) {
+            alignas(32) float tmp[PANEL];
+            _mm256_store_ps(tmp, acc[r][0]);
+            _mm256_store_ps(tmp + 8, acc[r][1]);
+            float* yr = y + r * ldy + n;
+            for (size_t j = 0; j < w; ++j) yr[j] += tmp[j];
+        }
+    }
+}
+
+} // namespace
+
+void GemmOps::gemv(const TensorView& x, const CompressedWeights& W, const TensorView& y) {
+    const size_t M = x.rows(), K = W.rows, N = W.cols;
+    if (x.cols() != K || y.rows() != M || y.cols() != N) {
+        throw std::invalid_argument("gemv: shape mismatch (expected x[MxK], W[KxN], y[MxN])");
+    }
+    if (x.dtype() != DataType::FP32 || y.dtype() != DataType::FP32 || !x.has_unit_col_stride() || !y.has_unit_col_stride()) {
+        throw std::invalid_argument("gemv: x and y must be FP32 row-major views");
+    }
+
+    auto& pool = get_thread_pool();
+    for (size_t m = 0; m < M; m += MAX_ROWS) {
+        const size_t R = std::min(MAX_ROWS, M - m);
+        const float* xp = &x.at<float>(m, 0);
+        float* yp = &y.at<float>(m, 0);
+        const size_t ldx = x.row_stride(), ldy = y.row_stride();
+        pool.parallel_for(0, W.panels(), [&](size_t p0, size_t p1) {
+            switch (R) {
+                case 1: gemv_compressed_panels<1>(xp, ldx, W, p0, p1, yp, ldy); break;
+                case 2: gemv_compressed_panels<2>(xp, ldx, W, p0, p1, yp, ldy); break;
+                case 3: gemv_compressed_panels<3>(xp, ldx, W, p0, p1, yp, ldy); break;
+                default: gemv_compressed_panels<4>(xp, ldx, W, p0, p1, yp, ldy); break;
+            }
+        });
+        CacheModel::record_weight_stream(K * N * sizeof(float), W.bytes());
+    }
+    PowerModel::record_activity(2 * M * N * K, W.bytes() + (M * K + M * N) * 4);
+}
+
+void GemmOps::gemv(const TensorView& x, const Tensor& W, const TensorView& y) {
+    gemv_impl(x, W, y, nullptr);
+}
+
+void GemmOps::gemv(const TensorView& x, const Fp8Weights& W, const TensorView& y) {
+    gemv_impl(x, W.data, y, W.column_scales().data());
+}
+
+void GemmOps::gemv_impl(const TensorView& x, const Tensor& W, const TensorView& y, const float* scale) {
+    const size_t M = x.rows(), K = W.rows(), N = W.cols();
+    if (x.cols() != K || y.rows() != M || y.cols() != N) {
+        throw std::invalid_argument("gemv: shape mismatch (expected x[MxK], W[KxN], y[MxN])");
+    }
+    if (x.dtype() != DataType::FP32 || y.dtype() != DataType::FP32 || !x.has_unit_col_stride() || !y.has_unit_col_stride()) {
+        throw std::invalid_argument("gemv: x and y must be FP32 row-major views");
+    }
+    if (W.layout() != Layout::RowMajor && W.layout() != Layout::Tiled) {
+        throw std::invalid_argument("gemv: W must be RowMajor or Tiled");
+    }
+
+    // Larger M is handled in groups of GEMV_MAX_ROWS, re-streaming W once per group
+    std::vector<uint32_t> live(K);
+    size_t zeros = 0, rows_read = 0;
+    for (size_t m = 0; m < M; m += MAX_ROWS) {
+        const size_t R = std::min(MAX_ROWS, M - m);
+        const float* xp = &x.at<float>(m, 0);
+        float* yp = &y.at<float>(m, 0);
+        const size_t ldx = x.row_stride(), ldy = y.row_stride();
+
+        size_t group_zeros = 0;
+        const size_t nk = compact_live_k(xp, ldx, R, K, live.data(), group_zeros);
+        zeros += group_zeros;
+        rows_read += nk;
+        // Dense activations walk k directly; the index list would only add a load per row
+        const uint32_t* ks = (nk < K) ? live.data() : nullptr;
+        switch (W.dtype()) {
+            case DataType::FP32: gemv_dispatch<DataType::FP32>(xp, ldx, R, W, ks, nk, scale, yp, ldy); break;
+            case DataType::FP16: gemv_dispatch<DataType::FP16>(xp, ldx, R, W, ks, nk, scale, yp, ldy); break;
+            case DataType::BF16: gemv_dispatch<DataType::BF16>(xp, ldx, R, W, ks, nk, scale, yp, ldy); break;
+            case DataType::FP8_E4M3: gemv_dispatch<DataType::FP8_E4M3>(xp, ldx, R, W, ks, nk, scale, yp, ldy); break;
+            case DataType::FP8_E5M2: gemv_dispatch<DataType::FP8_E5M2>(xp, ldx, R, W, ks, nk, scale, yp, ldy); break;
+            default: throw std::invalid_argument("gemv: W must be FP32, FP16, BF16 or FP8");
+        }
+    }
+
+    const size_t row_bytes = N * get_dtype_size(W.dtype());
+    const size_t groups = (M + MAX_ROWS - 1) / MAX_ROWS;
+    CacheModel::record_value_skip(M * K, zeros, groups * K * row_bytes, rows_read * row_bytes);
+    // Skipped weight rows are neither multiplied nor read
+    const float skipped = (K > 0 && M > 0) ? 1.0f - static_cast<float>(rows_read) / static_cast<float>(groups * K) : 0.0f;
+    PowerModel::record_activity(2 * M * N * K, K * N * get_dtype_size(W.dtype()) + (M * K + M * N) * 4, skipped);
+}
+
+} // namespace softaccelnpu
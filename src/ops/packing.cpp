@@ -1,4 +1,9 @@
 #include "softaccelnpu/ops.h"
+#include "../kernels/internal_kernels.h"
+#include "../kernels/widen.h"
+#include "../kernels/expand.h"
+#include "softaccelnpu/cache_model.h"
+#include <algorithm>
 #include <vector>
 #include <immintrin.h>
 
@@ -27,4 +32,163 @@ void pack_B_k_panel(size_t K, size_t N, const float* src, float* dst, size_t n_s
     }
 }
 
+/**
+ * NORMALIZING A-PACK: Produces an MR x KC sliver of Norm(A)
+ * The row scale/shift are precomputed; gamma/beta are already offset to column k.
+ */
+void pack_A_normalized(const float* A, size_t lda, size_t mr, size_t kb, const float* scale, const float* shift,
+                       const float* gamma, const float* beta, float* dst) {
+    for (size_t r = 0; r < mr; ++r) {
+        const float* src = A + r * lda;
+        float* out = dst + r * kb;
+        const __m256 vscale = _mm256_set1_ps(scale[r]);
+        const __m256 vshift = _mm256_set1_ps(shift[r]);
+        size_t k = 0;
+        for (; k + 8 <= kb; k += 8) {
+            __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(src + k), vshift), vscale);
+            v = beta ? _mm256_fmadd_ps(v, _mm256_loadu_ps(gamma + k), _mm256_loadu_ps(beta + k))
+                     : _mm256_mul_ps(v, _mm256_loadu_ps(gamma + k));
+            _mm256_storeu_ps(out + k, v);
+        }
+        for (; k < kb; ++k) out[k] = (src[k] - shift[r]) * scale[r] * gamma[k] + (beta ? beta[k] : 0.0f);
+    }
+}
+
+namespace {
+
+template <DataType DT>
+void pack_B_widen_impl(const void* B, size_t ldb, bool panels, size_t K, size_t N,
+                       size_t k0, size_t kb, size_t n0, size_t nb, const float* col_scale, float* dst) {
+    constexpr size_t nr = 16; // Match GemmOps::NR
+    for (size_t j = n0; j < n0 + nb; j += nr) {
+        const size_t w = std::min(nr, N - j);
+        alignas(32) float scale[nr];
+        for (size_t x = 0; x < nr; ++x) scale[x] = (col_scale && x < w) ? col_scale[j + x] : 1.0f;
+        const __m256 s0 = _mm256_load_ps(scale), s1 = _mm256_load_ps(scale + 8);
+
+        float* out = dst + (j - n0) / nr * kb * nr;
+        for (size_t k = k0; k < k0 + kb; ++k, out += nr) {
+            const size_t src = panels ? ((j / nr) * K + k) * nr : k * ldb + j;
+            // Tiled panels are padded to full width; row-major tails are not
+            if (w == nr || panels) {
+                __m256 v0, v1;
+                widen16<DT>(B, src, v0, v1);
+                if (col_scale) {
+                    v0 = _mm256_mul_ps(v0, s0);
+                    v1 = _mm256_mul_ps(v1, s1);
+                }
+                _mm256_storeu_ps(out, v0);
+                _mm256_storeu_ps(out + 8, v1);
+            } else {
+                for (size_t x = 0; x < w; ++x) out[x] = widen1<DT>(B, src + x) * scale[x];
+                for (size_t x = w; x < nr; ++x) out[x] = 0.0f;
+            }
+        }
+    }
+}
+
+/** In-register 8x8 transpose: r[i] lane j <- r[j] lane i. */
+inline void transpose8x8_ps(__m256 r[8]) {
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+template <DataType DT>
+void pack_B_transposed_impl(const void* W, size_t N, size_t K, float* dst) {
+    constexpr size_t nr = 16;
+    for (size_t n0 = 0; n0 < N; n0 += nr) {
+        float* panel = dst + n0 * K;  // Panel n0 / 16 starts at (n0 / 16) * K * 16
+        size_t k = 0;
+        for (; k + 8 <= K; k += 8) {
+            // Two 8x8 blocks: W rows n0..n0+7 and n0+8..n0+15 become panel columns 0-7 and 8-15
+            for (size_t h = 0; h < nr; h += 8) {
+                __m256 r[8];
+                for (size_t i = 0; i < 8; ++i) {
+                    r[i] = (n0 + h + i < N) ? widen8<DT>(W, (n0 + h + i) * K + k) : _mm256_setzero_ps();
+                }
+                transpose8x8_ps(r);
+                for (size_t i = 0; i < 8; ++i) _mm256_storeu_ps(panel + (k + i) * nr + h, r[i]);
+            }
+        }
+        for (; k < K; ++k) {
+            for (size_t j = 0; j < nr; ++j) panel[k * nr + j] = (n0 + j < N) ? widen1<DT>(W, (n0 + j) * K + k) : 0.0f;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * TRANSPOSING B-PACK: Checkpoint weights stored [out x in] become the [in x out]
+ * Layout::Tiled panels gemm_tiled consumes, 8x8 blocks at a time in registers.
+ */
+void pack_B_transposed(const void* W, DataType dtype, size_t N, size_t K, float* dst) {
+    switch (dtype) {
+        case DataType::FP16: pack_B_transposed_impl<DataType::FP16>(W, N, K, dst); break;
+        case DataType::BF16: pack_B_transposed_impl<DataType::BF16>(W, N, K, dst); break;
+        case DataType::FP8_E4M3: pack_B_transposed_impl<DataType::FP8_E4M3>(W, N, K, dst); break;
+        case DataType::FP8_E5M2: pack_B_transposed_impl<DataType::FP8_E5M2>(W, N, K, dst); break;
+        default: pack_B_transposed_impl<DataType::FP32>(W, N, K, dst); break;
+    }
+}
+
+/**
+ * WIDENING B-PACK: Narrow weights become FP32 panels right before the micro-kernel
+ * reads them, so memory traffic stays at their stored width; FP8 channel scales are
+ * folded in on the way.
+ */
+void pack_B_widen(const void* B, DataType dtype, size_t ldb, bool panels, size_t K, size_t N,
+                  size_t k0, size_t kb, size_t n0, size_t nb, const float* col_scale, float* dst) {
+    switch (dtype) {
+        case DataType::FP16: pack_B_widen_impl<DataType::FP16>(B, ldb, panels, K, N, k0, kb, n0, nb, col_scale, dst); break;
+        case DataType::BF16: pack_B_widen_impl<DataType::BF16>(B, ldb, panels, K, N, k0, kb, n0, nb, col_scale, dst); break;
+        case DataType::FP8_E4M3: pack_B_widen_impl<DataType::FP8_E4M3>(B, ldb, panels, K, N, k0, kb, n0, nb, col_scale, dst); break;
+        case DataType::FP8_E5M2: pack_B_widen_impl<DataType::FP8_E5M2>(B, ldb, panels, K, N, k0, kb, n0, nb, col_scale, dst); break;
+        default: pack_B_widen_impl<DataType::FP32>(B, ldb, panels, K, N, k0, kb, n0, nb, col_scale, dst); break;
+    }
+}
+
+/**
+ * EXPANDING B-PACK: Only masks and nonzeros cross the memory bus; each panel row is
+ * rebuilt in registers and lands in the packing buffer the micro-kernel already reads.
+ */
+void pack_B_compressed(const CompressedWeights& B, size_t k0, size_t kb, size_t n0, size_t nb, float* dst) {
+    constexpr size_t nr = CompressedWeights::PANEL;
+    const size_t K = B.rows, T = B.tiles_k();
+    size_t read = 0;
+    for (size_t j = n0; j < n0 + nb; j += nr) {
+        const size_t p = j / nr;
+        const uint16_t* masks = &B.masks[p * K];
+        // Seek from the nearest stream offset to row k0
+        const size_t tile_k = k0 / CompressedWeights::TILE_K * CompressedWeights::TILE_K;
+        size_t pos = B.offsets[p * T + tile_k / CompressedWeights::TILE_K];
+        for (size_t k = tile_k; k < k0; ++k) pos += popcount32(masks[k]);
+
+        const float* src = B.values.data() + pos;
+        float* out = dst + (j - n0) / nr * kb * nr;
+        for (size_t k = k0; k < k0 + kb; ++k, out += nr) {
+            __m256 lo, hi;
+            avx2_expand16_ps(src, masks[k], lo, hi);
+            _mm256_storeu_ps(out, lo);
+            _mm256_storeu_ps(out + 8, hi);
+        }
+        read += (src - (B.values.data() + pos)) * sizeof(float) + kb * sizeof(uint16_t);
+    }
+    CacheModel::record_weight_stream(kb * nb * sizeof(float), read);
+}
+
 } // namespace softaccelnpu
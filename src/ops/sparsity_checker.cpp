@@ -1,39 +1,105 @@
-#include "softaccelnpu/ops.h"
-#include <vector>
+#include "softaccelnpu/sparsity_mask.h"
+#include "softaccelnpu/tensor.h"
+#include "softaccelnpu/thread_pool.h"
+#include <algorithm>
+#include <immintrin.h>
+#include <stdexcept>
 
 namespace softaccelnpu {
 
+namespace {
+
+/**
+ * Byte pattern that clears the sign bit of every element in a 32-byte vector;
+ * a run of elements is all-zero iff (bytes & pattern) is all-zero.
+ */
+__m256i magnitude_pattern(DataType dtype) {
+    switch (dtype) {
+        case DataType::FP32: return _mm256_set1_epi32(0x7FFFFFFF);
+        case DataType::FP16:
+        case DataType::BF16: return _mm256_set1_epi16(0x7FFF);
+        case DataType::FP8_E4M3:
+        case DataType::FP8_E5M2: return _mm256_set1_epi8(0x7F);
+        default: return _mm256_set1_epi8(static_cast<char>(0xFF));  // Integer types: every bit counts
+    }
+}
+
+bool all_zero(const uint8_t* p, size_t bytes, __m256i pattern) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+        // Bail out early on dense data instead of scanning the whole run
+        if ((i & 255) == 224 && !_mm256_testz_si256(acc, pattern)) return false;
+    }
+    if (!_mm256_testz_si256(acc, pattern)) return false;
+    if (i < bytes) {
+        // Tails are whole elements, so the pattern repeats at the same phase
+        alignas(32) uint8_t tail[32] = {};
+        std::copy(p + i, p + bytes, tail);
+        return _mm256_testz_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)), pattern);
+    }
+    return true;
+}
+
+constexpr size_t PARALLEL_SCAN_BYTES = 1 << 20;
+
+} // namespace
+
 /**
  * Value-Aware Sparsity: Generate a bitmask for zero-blocks
- * Helps the scheduler skip entire 6x16 or MCxKC blocks.
+ * Lets gemm_tiled skip MR x KC blocks of A and KC x NR blocks of B.
  */
-struct SparsityMask {
-    std::vector<bool> block_is_zero;
-    size_t rows_blocks;
-    size_t cols_blocks;
-};
-
-SparsityMask generate_sparsity_mask(const Tensor& A, size_t block_m, size_t block_k) {
-    size_t M = A.rows();
-    size_t K = A.cols();
-    size_t mb = (M + block_m - 1) / block_m;
-    size_t kb = (K + block_k - 1) / block_k;
-    
+SparsityMask generate_sparsity_mask(const Tensor& T, size_t block_rows, size_t block_cols) {
+    if (block_rows == 0 || block_cols == 0) {
+        throw std::invalid_argument("generate_sparsity_mask: block dimensions must be non-zero");
+    }
+    const size_t R = T.rows(), C = T.cols();
     SparsityMask mask;
-    mask.rows_blocks = mb;
-    mask.cols_blocks = kb;
-    mask.block_is_zero.resize(mb * kb, true);
-    
-    const float* data = reinterpret_cast<const float*>(A.data());
-    
-    for (size_t m = 0; m < M; ++m) {
-        for (size_t k = 0; k < K; ++k) {
-            if (data[m * K + k] != 0.0f) {
-                mask.block_is_zero[(m / block_m) * kb + (k / block_k)] = false;
+    mask.block_rows = block_rows;
+    mask.block_cols = block_cols;
+    mask.rows_blocks = (R + block_rows - 1) / block_rows;
+    mask.cols_blocks = (C + block_cols - 1) / block_cols;
+    mask.block_is_zero.assign(mask.rows_blocks * mask.cols_blocks, 1);
+
+    const __m256i pattern = magnitude_pattern(T.dtype());
+    const size_t es = get_dtype_size(T.dtype());
+    const uint8_t* base = static_cast<const uint8_t*>(T.data());
+    const Layout layout = T.layout();
+    const size_t tw = Tensor::TILE_WIDTH;
+
+    // Contiguous storage run holding elements (r, c0) .. (r, c1 - 1), or as much of it as is contiguous
+    auto zero_row_segment = [&](size_t r, size_t c0, size_t c1) {
+        if (layout == Layout::ColMajor) {
+            for (size_t c = c0; c < c1; ++c) {
+                if (!all_zero(base + (c * R + r) * es, es, pattern)) return false;
             }
+            return true;
         }
-    }
-    
+        for (size_t c = c0; c < c1;) {
+            const size_t run = (layout == Layout::Tiled) ? std::min(c1 - c, tw - c % tw) : c1 - c;
+            const size_t off = (layout == Layout::Tiled) ? ((c / tw) * R + r) * tw + c % tw : r * C + c;
+            if (!all_zero(base + off * es, run * es, pattern)) return false;
+            c += run;
+        }
+        return true;
+    };
+
+    auto scan = [&](size_t rb0, size_t rb1) {
+        for (size_t rb = rb0; rb < rb1; ++rb) {
+            for (size_t cb = 0; cb < mask.cols_blocks; ++cb) {
+                const size_t r1 = std::min(R, (rb + 1) * block_rows);
+                const size_t c0 = cb * block_cols, c1 = std::min(C, c0 + block_cols);
+                bool zero = true;
+                for (size_t r = rb * block_rows; r < r1 && zero; ++r) zero = zero_row_segment(r, c0, c1);
+                mask.block_is_zero[rb * mask.cols_blocks + cb] = zero;
+            }
+        }
+    };
+    // Block rows are independent; weights are scanned once at load time, often by the MB
+    if (T.bytes() >= PARALLEL_SCAN_BYTES && mask.rows_blocks > 1) get_thread_pool().parallel_for(0, mask.rows_blocks, scan);
+    else scan(0, mask.rows_blocks);
+    for (uint8_t z : mask.block_is_zero) mask.zero_blocks += z;
     return mask;
 }
 
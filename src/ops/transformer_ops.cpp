@@ -0,0 +1,244 @@
+#include "softaccelnpu/transformer_ops.h"
+#include "softaccelnpu/thread_pool.h"
+#include "softaccelnpu/power_model.h"
+#include "../kernels/internal_kernels.h"
+#include "../kernels/avx2_math.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * @file transformer_ops.cpp
+ * @brief AVX2 row kernels for RMSNorm, LayerNorm, RoPE and softmax.
+ *
+ * Each row is reduced and rewritten while it is still in L1. Rows are spread over
+ * the pool only when the tensor is large enough to amortize the dispatch; a single
+ * decode token runs inline on the calling thread.
+ */
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t PARALLEL_MIN_ELEMS = 1 << 15;
+
+template <typename RowFunc>
+void for_each_row(size_t rows, size_t cols, RowFunc&& fn) {
+    if (rows < 2 || rows * cols < PARALLEL_MIN_ELEMS) {
+        for (size_t r = 0; r < rows; ++r) fn(r);
+        return;
+    }
+    get_thread_pool().parallel_for(0, rows, [&](size_t r_start, size_t r_end) {
+        for (size_t r = r_start; r < r_end; ++r) fn(r);
+    });
+}
+
+void check_same_shape(const Tensor& X, const Tensor& Y, const char* op) {
+    if (X.rows() != Y.rows() || X.cols() != Y.cols()) {
+        throw std::invalid_argument(std::string(op) + ": input and output shapes differ");
+    }
+}
+
+/** y[i] = (x[i] - shift) * scale * w[i] (+ b[i]) */
+void scale_row(const float* x, const float* w, const float* b, float shift, float scale, float* y, size_t n) {
+    const __m256 vshift = _mm256_set1_ps(shift);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vshift), vscale);
+        v = b ? _mm256_fmadd_ps(v, _mm256_loadu_ps(w + i), _mm256_loadu_ps(b + i))
+              : _mm256_mul_ps(v, _mm256_loadu_ps(w + i));
+        _mm256_storeu_ps(y + i, v);
+    }
+    for (; i < n; ++i) y[i] = (x[i] - shift) * scale * w[i] + (b ? b[i] : 0.0f);
+}
+
+} // namespace
+
+float rms_norm_scale(const float* x, size_t n, float eps) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_loadu_ps(x + i), b = _mm256_loadu_ps(x + i + 8);
+        acc0 = _mm256_fmadd_ps(a, a, acc0);
+        acc1 = _mm256_fmadd_ps(b, b, acc1);
+    }
+    float ss = avx2_hsum_ps(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) ss += x[i] * x[i];
+    return 1.0f / std::sqrt(ss / static_cast<float>(n) + eps);
+}
+
+void layer_norm_stats(const float* x, size_t n, float eps, float& mean, float& inv_std) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm256_add_ps(acc, _mm256_loadu_ps(x + i));
+    float sum = avx2_hsum_ps(acc);
+    for (; i < n; ++i) sum += x[i];
+    mean = sum / static_cast<float>(n);
+
+    // Second pass over the (L1-resident) row: variance of x - mean, no cancellation
+    const __m256 vmean = _mm256_set1_ps(mean);
+    acc = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + i), vmean);
+        acc = _mm256_fmadd_ps(d, d, acc);
+    }
+    float var = avx2_hsum_ps(acc);
+    for (; i < n; ++i) var += (x[i] - mean) * (x[i] - mean);
+    inv_std = 1.0f / std::sqrt(var / static_cast<float>(n) + eps);
+}
+
+RopeTable::RopeTable(size_t head_dim, size_t max_positions, float theta, bool interleaved)
+    : head_dim_(head_dim), max_positions_(max_positions), interleaved_(interleaved) {
+    if (head_dim == 0 || head_dim % 2 != 0) {
+        throw std::invalid_argument("RopeTable: head_dim must be even");
+    }
+    const size_t half = head_dim / 2;
+    cos_.resize(max_positions * head_dim);
+    sin_.resize(max_positions * head_dim);
+
+    // y[j] = x[j] * cos[j] + x[partner(j)] * sin[j]; the rotation sign is folded into sin
+    for (size_t p = 0; p < max_positions; ++p) {
+        float* c = cos_.data() + p * head_dim;
+        float* s = sin_.data() + p * head_dim;
+        for (size_t i = 0; i < half; ++i) {
+            const double freq = std::pow(static_cast<double>(theta), -2.0 * static_cast<double>(i) / head_dim);
+            const double angle = static_cast<double>(p) * freq;
+            const float cv = static_cast<float>(std::cos(angle));
+            const float sv = static_cast<float>(std::sin(angle));
+            const size_t lo = interleaved ? 2 * i : i;
+            const size_t hi = interleaved ? 2 * i + 1 : i + half;
+            c[lo] = cv; s[lo] = -sv;
+            c[hi] = cv; s[hi] = sv;
+        }
+    }
+}
+
+void TransformerOps::rms_norm(const Tensor& X, const Tensor& weight, Tensor& Y, float eps) {
+    check_same_shape(X, Y, "rms_norm");
+    const size_t D = X.cols();
+    if (weight.size() != D) {
+        throw std::invalid_argument("rms_norm: weight must hold one value per column");
+    }
+    const float* Xp = reinterpret_cast<const float*>(X.data());
+    const float* w = reinterpret_cast<const float*>(weight.data());
+    float* Yp = Y.data_as_fp32();
+
+    for_each_row(X.rows(), D, [&](size_t r) {
+        const float* x = Xp + r * D;
+        scale_row(x, w, nullptr, 0.0f, rms_norm_scale(x, D, eps), Yp + r * D, D);
+    });
+    PowerModel::record_activity(4 * X.size(), (2 * X.size() + D) * 4, 0.0f, true);
+}
+
+void TransformerOps::layer_norm(const Tensor& X, const Tensor& gamma, const Tensor& beta, Tensor& Y, float eps) {
+    check_same_shape(X, Y, "layer_norm");
+    const size_t D = X.cols();
+    if (gamma.size() != D || beta.size() != D) {
+        throw std::invalid_argument("layer_norm: gamma and beta must hold one value per column");
+    }
+    const float* Xp = reinterpret_cast<const float*>(X.data());
+    const float* g = reinterpret_cast<const float*>(gamma.data());
+    const float* b = reinterpret_cast<const float*>(beta.data());
+    float* Yp = Y.data_as_fp32();
+
+    for_each_row(X.rows(), D, [&](size_t r) {
+        const float* x = Xp + r * D;
+        float mean, inv_std;
+        layer_norm_stats(x, D, eps, mean, inv_std);
+        scale_row(x, g, b, mean, inv_std, Yp + r * D, D);
+    });
+    PowerModel::record_activity(7 * X.size(), (2 * X.size() + 2 * D) * 4, 0.0f, true);
+}
+
+void TransformerOps::rope(Tensor& X, size_t num_heads, const RopeTable& table, size_t pos0) {
+    const size_t d = table.head_dim();
+    if (num_heads == 0 || X.cols() != num_heads * d) {
+        throw std::invalid_argument("rope: X must be tokens x (num_heads * head_dim)");
+    }
+    if (pos0 + X.rows() > table.max_positions()) {
+        throw std::invalid_argument("rope: position exceeds the RopeTable range");
+    }
+    float* Xp = X.data_as_fp32();
+    const size_t half = d / 2;
+
+    for_each_row(X.rows(), X.cols(), [&](size_t r) {
+        const float* c = table.cos_row(pos0 + r);
+        const float* s = table.sin_row(pos0 + r);
+        for (size_t h = 0; h < num_heads; ++h) {
+            float* x = Xp + r * X.cols() + h * d;
+            size_t j = 0;
+            if (table.interleaved()) {
+                // Partner of lane j is j ^ 1: swap adjacent lanes in-register
+                for (; j + 8 <= d; j += 8) {
+                    __m256 v = _mm256_loadu_ps(x + j);
+                    __m256 swapped = _mm256_permute_ps(v, 0xB1);
+                    v = _mm256_fmadd_ps(swapped, _mm256_loadu_ps(s + j), _mm256_mul_ps(v, _mm256_loadu_ps(c + j)));
+                    _mm256_storeu_ps(x + j, v);
+                }
+                for (; j < d; j += 2) {
+                    const float x0 = x[j], x1 = x[j + 1];
+                    x[j] = x0 * c[j] + x1 * s[j];
+                    x[j + 1] = x1 * c[j + 1] + x0 * s[j + 1];
+                }
+            } else {
+                // Partner of lane j is j +/- half: rotate both halves together
+                for (; j + 8 <= half; j += 8) {
+                    __m256 lo = _mm256_loadu_ps(x + j);
+                    __m256 hi = _mm256_loadu_ps(x + j + half);
+                    __m256 new_lo = _mm256_fmadd_ps(hi, _mm256_loadu_ps(s + j), _mm256_mul_ps(lo, _mm256_loadu_ps(c + j)));
+                    __m256 new_hi = _mm256_fmadd_ps(lo, _mm256_loadu_ps(s + j + half), _mm256_mul_ps(hi, _mm256_loadu_ps(c + j + half)));
+                    _mm256_storeu_ps(x + j, new_lo);
+                    _mm256_storeu_ps(x + j + half, new_hi);
+                }
+                for (; j < half; ++j) {
+                    const float lo = x[j], hi = x[j + half];
+                    x[j] = lo * c[j] + hi * s[j];
+                    x[j + half] = hi * c[j + half] + lo * s[j + half];
+                }
+            }
+        }
+    });
+    PowerModel::record_activity(3 * X.size(), 2 * X.size() * 4, 0.0f, true);
+}
+
+void TransformerOps::softmax(const Tensor& X, Tensor& Y) {
+    check_same_shape(X, Y, "softmax");
+    const size_t D = X.cols();
+    const float* Xp = reinterpret_cast<const float*>(X.data());
+    float* Yp = Y.data_as_fp32();
+
+    for_each_row(X.rows(), D, [&](size_t r) {
+        const float* x = Xp + r * D;
+        float* y = Yp + r * D;
+        const size_t tail = D % 8;
+        const size_t body = D - tail;
+        const __m256i mask = avx2_tail_mask(tail);
+
+        __m256 vmax = _mm256_set1_ps(-INFINITY);
+        for (size_t i = 0; i < body; i += 8) vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(x + i));
+        float m = avx2_hmax_ps(vmax);
+        for (size_t i = body; i < D; ++i) m = std::max(m, x[i]);
+
+        const __m256 vm = _mm256_set1_ps(m);
+        __m256 vsum = _mm256_setzero_ps();
+        for (size_t i = 0; i < body; i += 8) {
+            __m256 e = avx2_exp_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vm));
+            _mm256_storeu_ps(y + i, e);
+            vsum = _mm256_add_ps(vsum, e);
+        }
+        if (tail) {
+            __m256 e = avx2_exp_ps(_mm256_sub_ps(_mm256_maskload_ps(x + body, mask), vm));
+            e = _mm256_and_ps(e, _mm256_castsi256_ps(mask));
+            _mm256_maskstore_ps(y + body, mask, e);
+            vsum = _mm256_add_ps(vsum, e);
+        }
+
+        const __m256 inv = _mm256_set1_ps(1.0f / avx2_hsum_ps(vsum));
+        for (size_t i = 0; i < body; i += 8) _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), inv));
+        if (tail) _mm256_maskstore_ps(y + body, mask, _mm256_mul_ps(_mm256_maskload_ps(y + body, mask), inv));
+    });
+    PowerModel::record_activity(5 * X.size(), 2 * X.size() * 4, 0.0f, true);
+}
+
+} // namespace softaccelnpu
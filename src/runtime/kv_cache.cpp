@@ -0,0 +1,197 @@
+#include "softaccelnpu/kv_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace softaccelnpu {
+
+PagedKVCache::PagedKVCache(const KVCacheConfig& config) : config_(config) {
+    if (config.head_dim == 0 || config.num_kv_heads == 0 || config.page_size == 0 || config.num_layers == 0) {
+        throw std::invalid_argument("PagedKVCache: layers, kv heads, head_dim and page_size must be non-zero");
+    }
+    if (config.dtype != DataType::FP32 && config.dtype != DataType::INT8) {
+        throw std::invalid_argument("PagedKVCache: only FP32 and INT8 storage are supported");
+    }
+
+    row_elems_ = config.num_kv_heads * config.head_dim;
+    elem_bytes_ = (config.dtype == DataType::INT8) ? 1 : sizeof(float);
+
+    // One allocation for the whole pool: pages never move once handed out
+    storage_.resize(config.num_pages * config.num_layers * 2 * config.page_size * row_elems_ * elem_bytes_);
+    if (config.dtype == DataType::INT8) {
+        scales_.resize(config.num_pages * config.num_layers * 2 * config.page_size * config.num_kv_heads);
+    }
+
+    // Low page ids are handed out first
+    free_list_.resize(config.num_pages);
+    for (size_t i = 0; i < config.num_pages; ++i) {
+        free_list_[i] = static_cast<uint32_t>(config.num_pages - 1 - i);
+    }
+}
+
+PagedKVCache::SeqId PagedKVCache::add_sequence() {
+    SeqId id = next_id_++;
+    sequences_[id] = Sequence{};
+    return id;
+}
+
+void PagedKVCache::remove_sequence(SeqId seq) {
+    Sequence& s = get(seq);
+    free_list_.insert(free_list_.end(), s.pages.rbegin(), s.pages.rend());
+    sequences_.erase(seq);
+}
+
+PagedKVCache::Sequence& PagedKVCache::get(SeqId seq) {
+    auto it = sequences_.find(seq);
+    if (it == sequences_.end()) {
+        throw std::invalid_argument("PagedKVCache: unknown sequence " + std::to_string(seq));
+    }
+    return it->second;
+}
+
+const PagedKVCache::Sequence& PagedKVCache::get(SeqId seq) const {
+    return const_cast<PagedKVCache*>(this)->get(seq);
+}
+
+size_t PagedKVCache::append(SeqId seq, size_t num_tokens) {
+    Sequence& s = get(seq);
+    const size_t P = config_.page_size;
+    const size_t pos = s.length;
+    const size_t needed = (pos + num_tokens - s.start + P - 1) / P;
+
+    if (needed > s.pages.size()) {
+        const size_t grow = needed - s.pages.size();
+        if (grow > free_list_.size()) {
+            throw std::runtime_error("PagedKVCache: out of pages (" + std::to_string(grow) + " needed, " +
+                                     std::to_string(free_list_.size()) + " free)");
+        }
+        for (size_t i = 0; i < grow; ++i) {
+            s.pages.push_back(free_list_.back());
+            free_list_.pop_back();
+        }
+    }
+    s.length += num_tokens;
+    return pos;
+}
+
+void PagedKVCache::truncate(SeqId seq, size_t length) {
+    Sequence& s = get(seq);
+    if (length > s.length || length < s.start) {
+        throw std::invalid_argument("PagedKVCache::truncate: length is outside the resident tokens");
+    }
+    const size_t needed = (length - s.start + config_.page_size - 1) / config_.page_size;
+    for (; s.pages.size() > needed; s.pages.pop_back()) free_list_.push_back(s.pages.back());
+    s.length = length;
+}
+
+size_t PagedKVCache::evict(SeqId seq, size_t num_tokens) {
+    Sequence& s = get(seq);
+    const size_t P = config_.page_size;
+    const size_t resident = s.length - s.start;
+
+    // Only whole pages can be released; a partially filled tail page stays
+    size_t drop = std::min(num_tokens, resident) / P;
+    drop = std::min(drop, s.pages.size());
+    if (drop == 0) return 0;
+
+    free_list_.insert(free_list_.end(), s.pages.rend() - drop, s.pages.rend());
+    s.pages.erase(s.pages.begin(), s.pages.begin() + drop);
+    s.start += drop * P;
+    return drop * P;
+}
+
+size_t PagedKVCache::block_offset(uint32_t page, size_t layer, size_t kv) const {
+    return ((page * config_.num_layers + layer) * 2 + kv) * config_.page_size;
+}
+
+size_t PagedKVCache::page_bytes() const {
+    size_t bytes = config_.num_layers * 2 * config_.page_size * row_elems_ * elem_bytes_;
+    if (config_.dtype == DataType::INT8) bytes += config_.num_layers * 2 * config_.page_size * config_.num_kv_heads * sizeof(float);
+    return bytes;
+}
+
+const float* PagedKVCache::key_page(uint32_t page, size_t layer) const {
+    return reinterpret_cast<const float*>(storage_.data()) + block_offset(page, layer, 0) * row_elems_;
+}
+
+const float* PagedKVCache::value_page(uint32_t page, size_t layer) const {
+    return reinterpret_cast<const float*>(storage_.data()) + block_offset(page, layer, 1) * row_elems_;
+}
+
+TensorView PagedKVCache::key_view(uint32_t page, size_t layer) const {
+    return TensorView(const_cast<float*>(key_page(page, layer)), config_.page_size, row_elems_, row_elems_);
+}
+
+TensorView PagedKVCache::value_view(uint32_t page, size_t layer) const {
+    return TensorView(const_cast<float*>(value_page(page, layer)), config_.page_size, row_elems_, row_elems_);
+}
+
+const int8_t* PagedKVCache::key_page_int8(uint32_t page, size_t layer) const {
+    return reinterpret_cast<const int8_t*>(storage_.data()) + block_offset(page, layer, 0) * row_elems_;
+}
+
+const int8_t* PagedKVCache::value_page_int8(uint32_t page, size_t layer) const {
+    return reinterpret_cast<const int8_t*>(storage_.data()) + block_offset(page, layer, 1) * row_elems_;
+}
+
+const float* PagedKVCache::key_scales(uint32_t page, size_t layer) const {
+    return scales_.data() + block_offset(page, layer, 0) * config_.num_kv_heads;
+}
+
+const float* PagedKVCache::value_scales(uint32_t page, size_t layer) const {
+    return scales_.data() + block_offset(page, layer, 1) * config_.num_kv_heads;
+}
+
+void PagedKVCache::write(SeqId seq, size_t layer, size_t pos, const Tensor& K, const Tensor& V) {
+    const Sequence& s = get(seq);
+    const size_t n = K.rows();
+    if (layer >= config_.num_layers) {
+        throw std::invalid_argument("PagedKVCache::write: layer out of range");
+    }
+    if (K.cols() != row_elems_ || V.cols() != row_elems_ || V.rows() != n) {
+        throw std::invalid_argument("PagedKVCache::write: K/V must be n x (num_kv_heads * head_dim)");
+    }
+    if (pos < s.start || pos + n > s.length) {
+        throw std::invalid_argument("PagedKVCache::write: positions are not reserved or already evicted");
+    }
+
+    const size_t P = config_.page_size;
+    const size_t d = config_.head_dim;
+    const bool int8 = config_.dtype == DataType::INT8;
+    const float* src[2] = {reinterpret_cast<const float*>(K.data()), reinterpret_cast<const float*>(V.data())};
+
+    for (size_t t = 0; t < n; ++t) {
+        const size_t rel = pos + t - s.start;
+        const uint32_t page = s.pages[rel / P];
+        const size_t slot = rel % P;
+
+        for (size_t kv = 0; kv < 2; ++kv) {
+            const float* row = src[kv] + t * row_elems_;
+            const size_t base = block_offset(page, layer, kv) + slot;
+
+            if (!int8) {
+                std::memcpy(storage_.data() + base * row_elems_ * sizeof(float), row, row_elems_ * sizeof(float));
+                continue;
+            }
+
+            // Symmetric per-(token, head) quantization: scale = absmax / 127
+            int8_t* qrow = reinterpret_cast<int8_t*>(storage_.data()) + base * row_elems_;
+            float* srow = scales_.data() + base * config_.num_kv_heads;
+            for (size_t h = 0; h < config_.num_kv_heads; ++h) {
+                const float* x = row + h * d;
+                float amax = 0.0f;
+                for (size_t i = 0; i < d; ++i) amax = std::max(amax, std::abs(x[i]));
+                const float scale = amax > 0.0f ? amax / 127.0f : 1.0f;
+                const float inv = 1.0f / scale;
+                for (size_t i = 0; i < d; ++i) {
+                    qrow[h * d + i] = static_cast<int8_t>(std::lrint(std::max(-127.0f, std::min(127.0f, x[i] * inv))));
+                }
+                srow[h] = scale;
+            }
+        }
+    }
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,194 @@
+#include "softaccelnpu/layer_prefetcher.h"
+#include "softaccelnpu/gguf_loader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+void LayerRegion::add(size_t offset, size_t size, size_t gap) {
+    if (size == 0) return;
+    ranges.emplace_back(offset, size);
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<size_t, size_t>> merged;
+    for (const auto& r : ranges) {
+        if (!merged.empty() && r.first <= merged.back().first + merged.back().second + gap) {
+            auto& m = merged.back();
+            m.second = std::max(m.first + m.second, r.first + r.second) - m.first;
+        } else {
+            merged.push_back(r);
+        }
+    }
+    ranges = std::move(merged);
+    bytes = 0;
+    for (const auto& r : ranges) bytes += r.second;
+}
+
+std::vector<LayerRegion> LayerPrefetcher::gguf_layers(const GgufLoader& loader) {
+    const auto& meta = loader.get_metadata();
+    const size_t gap = static_cast<size_t>(meta.alignment);
+    LayerRegion embed{"token_embd", {}, 0}, head{"output", {}, 0};
+    std::map<unsigned long, LayerRegion> blocks;
+
+    for (const auto& t : meta.tensors) {
+        const size_t off = static_cast<size_t>(t.data_offset), size = static_cast<size_t>(t.size_bytes);
+        if (t.name.compare(0, 4, "blk.") == 0) {
+            char* end = nullptr;
+            const unsigned long b = std::strtoul(t.name.c_str() + 4, &end, 10);
+            if (end != t.name.c_str() + 4 && *end == '.') {
+                LayerRegion& r = blocks[b];
+                if (r.name.empty()) r.name = "blk." + std::to_string(b);
+                r.add(off, size, gap);
+                continue;
+            }
+        }
+        (t.name.compare(0, 10, "token_embd") == 0 ? embed : head).add(off, size, gap);
+    }
+
+    std::vector<LayerRegion> layers;
+    if (embed.bytes) layers.push_back(std::move(embed));
+    for (auto& b : blocks) layers.push_back(std::move(b.second));
+    if (head.bytes) layers.push_back(std::move(head));
+    return layers;
+}
+
+LayerPrefetcher::LayerPrefetcher(std::shared_ptr<const MappedFile> file, std::vector<LayerRegion> layers,
+                                 const PrefetchOptions& options)
+    : file_(std::move(file)), layers_(std::move(layers)), options_(options),
+      queued_(layers_.size(), 0), ready_(layers_.size(), 0) {
+    if (!file_) throw std::invalid_argument("LayerPrefetcher: file must be mapped");
+    for (const auto& l : layers_) {
+        for (const auto& r : l.ranges) {
+            if (r.first + r.second > file_->size()) {
+                throw std::invalid_argument("LayerPrefetcher: layer " + l.name + " extends past the end of the file");
+            }
+        }
+    }
+    io_thread_ = std::thread(&LayerPrefetcher::io_loop, this);
+}
+
+LayerPrefetcher::~LayerPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    io_thread_.join();
+}
+
+void LayerPrefetcher::enqueue_locked(size_t layer) {
+    if (queued_[layer]) return;
+    queued_[layer] = 1;
+    queue_.push_back(layer);
+}
+
+void LayerPrefetcher::begin_layer(size_t layer) {
+    const size_t n = layers_.size();
+    if (layer >= n) throw std::out_of_range("LayerPrefetcher::begin_layer: layer out of range");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // The current layer first, so a cold start fetches it before any lookahead
+    enqueue_locked(layer);
+    for (size_t k = 1; k <= options_.depth; ++k) {
+        if (layer + k < n) enqueue_locked(layer + k);
+        else if (options_.cyclic) enqueue_locked((layer + k) % n);
+    }
+    cv_.notify_all();
+
+    const auto t0 = Clock::now();
+    cv_.wait(lock, [&] { return ready_[layer] != 0; });
+    compute_start_ = Clock::now();
+    stats_.stall_seconds += std::chrono::duration<double>(compute_start_ - t0).count();
+}
+
+void LayerPrefetcher::end_layer(size_t layer) {
+    if (layer >= layers_.size()) throw std::out_of_range("LayerPrefetcher::end_layer: layer out of range");
+    const double seconds = std::chrono::duration<double>(Clock::now() - compute_start_).count();
+    const LayerRegion& region = layers_[layer];
+
+    size_t dropped = 0;
+    if (options_.drop_finished) {
+        // Only whole pages inside the layer: boundary pages may hold a neighbour's weights
+        const size_t page = MappedFile::page_size();
+        for (const auto& r : region.ranges) {
+            const size_t begin = (r.first + page - 1) / page * page;
+            const size_t end = (r.first + r.second) / page * page;
+            if (end > begin && file_->advise(begin, end - begin, MapAdvice::DontNeed)) dropped += end - begin;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.layers_computed++;
+    stats_.bytes_computed += region.bytes;
+    stats_.compute_seconds += seconds;
+    stats_.bytes_dropped += dropped;
+    if (options_.drop_finished) {
+        // Refetched when the next forward pass reaches it
+        queued_[layer] = 0;
+        ready_[layer] = 0;
+    }
+}
+
+size_t LayerPrefetcher::fetch(const LayerRegion& region) const {
+    for (const auto& r : region.ranges) file_->advise(r.first, r.second, MapAdvice::WillNeed);
+    if (!options_.read_pages) return 0;
+
+    // Touching one byte per page takes the faults here instead of in the kernels
+    const size_t page = MappedFile::page_size();
+    const volatile uint8_t* base = file_->data();
+    uint8_t sink = 0;
+    for (const auto& r : region.ranges) {
+        for (size_t off = r.first; off < r.first + r.second; off += page) sink ^= base[off];
+        sink ^= base[r.first + r.second - 1];
+    }
+    (void)sink;
+    return region.bytes;
+}
+
+void LayerPrefetcher::io_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+        const size_t layer = queue_.front();
+        queue_.pop_front();
+        lock.unlock();
+
+        const auto t0 = Clock::now();
+        const size_t bytes = fetch(layers_[layer]);
+        const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        lock.lock();
+        stats_.bytes_fetched += bytes;
+        stats_.fetch_seconds += seconds;
+        ready_[layer] = 1;
+        cv_.notify_all();
+    }
+}
+
+PrefetchStats LayerPrefetcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void LayerPrefetcher::print_report() const {
+    const PrefetchStats s = stats();
+    std::cout << "--- Layer Streaming ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Layers:   " << s.layers_computed << " computed, depth " << options_.depth
+              << (options_.drop_finished ? ", finished layers dropped" : "") << std::endl;
+    std::cout << "Fetch:    " << s.bytes_fetched / 1048576.0 << " MB in " << s.fetch_seconds * 1e3 << " ms ("
+              << s.fetch_mb_per_s() << " MB/s)" << std::endl;
+    std::cout << "Compute:  " << s.bytes_computed / 1048576.0 << " MB in " << s.compute_seconds * 1e3 << " ms ("
+              << s.compute_mb_per_s() << " MB/s)" << std::endl;
+    std::cout << "Stalls:   " << s.stall_seconds * 1e3 << " ms waiting for pages" << std::endl;
+    std::cout << "Dropped:  " << s.bytes_dropped / 1048576.0 << " MB" << std::endl;
+    std::cout << "Overall:  " << s.effective_mb_per_s() << " MB/s of weights" << std::endl;
+    std::cout << "-----------------------" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,339 @@
+#include "softaccelnpu/llama_model.h"
+#include "softaccelnpu/attention.h"
+#include "softaccelnpu/gguf_loader.h"
+#include "softaccelnpu/ops.h"
+#include "../kernels/internal_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+namespace {
+
+constexpr size_t DEFAULT_MAX_SEQ = 4096;
+constexpr size_t KV_PAGE_SIZE = 16;
+
+float get_float(const GgufLoader& loader, const std::string& key, float fallback) {
+    const GgufValue* v = loader.find(key);
+    return (v && (v->type == GgufType::FLOAT32 || v->type == GgufType::FLOAT64)) ? static_cast<float>(v->f64) : fallback;
+}
+
+/** @brief Checks that a GGUF tensor exists with [rows x cols] (shape {cols, rows}). */
+const GgufLoader::TensorInfo& require(const GgufLoader& loader, const std::string& name, size_t rows, size_t cols) {
+    const GgufLoader::TensorInfo* info = loader.find_tensor(name);
+    if (!info) throw std::invalid_argument("LlamaModel: missing tensor " + name);
+    const size_t c = info->shape.empty() ? 1 : static_cast<size_t>(info->shape[0]);
+    if (c != cols || info->elements() != static_cast<uint64_t>(rows) * cols) {
+        throw std::invalid_argument("LlamaModel: " + name + " does not have the shape the metadata implies");
+    }
+    return *info;
+}
+
+/** @brief B = W^T as Tiled FP32 panels, for W [N x K] row-major FP32. */
+void pack_transposed(const Tensor& W, Tensor& B) {
+    pack_B_transposed(W.data(), DataType::FP32, W.rows(), W.cols(), B.data_as_fp32());
+}
+
+/** @brief Row-major W^T; the Tiled -> RowMajor step copies whole panel rows. */
+Tensor transposed(const Tensor& W) {
+    Tensor B(W.cols(), W.rows(), DataType::FP32, Layout::Tiled, TensorInit::Uninitialized);
+    pack_transposed(W, B);
+    return B.to_layout(Layout::RowMajor);
+}
+
+} // namespace
+
+LlamaConfig LlamaConfig::from_gguf(const GgufLoader& loader) {
+    // Other architectures reuse the <arch>.* keys but differ in RoPE layout (NeoX halves),
+    // biases or norms, so they would load cleanly and compute wrong logits
+    const std::string name = loader.get_string("general.architecture", "llama");
+    if (name != "llama") throw std::invalid_argument("LlamaConfig: unsupported architecture " + name);
+    const std::string arch = name + ".";
+    auto required = [&](const std::string& key) {
+        const uint64_t v = loader.get_u64(arch + key);
+        if (v == 0) throw std::invalid_argument("LlamaConfig: missing metadata key " + arch + key);
+        return static_cast<size_t>(v);
+    };
+
+    LlamaConfig c;
+    c.dim = required("embedding_length");
+    c.hidden_dim = required("feed_forward_length");
+    c.num_layers = required("block_count");
+    c.num_heads = required("attention.head_count");
+    c.num_kv_heads = static_cast<size_t>(loader.get_u64(arch + "attention.head_count_kv", c.num_heads));
+    c.context_length = static_cast<size_t>(loader.get_u64(arch + "context_length"));
+    c.rope_theta = get_float(loader, arch + "rope.freq_base", c.rope_theta);
+    c.rms_eps = get_float(loader, arch + "attention.layer_norm_rms_epsilon", c.rms_eps);
+    const std::string scaling = loader.get_string(arch + "rope.scaling.type", "none");
+    if (scaling != "none") throw std::invalid_argument("LlamaConfig: unsupported RoPE scaling " + scaling);
+    if (c.dim % c.num_heads != 0 || c.num_kv_heads == 0 || c.num_heads % c.num_kv_heads != 0) {
+        throw std::invalid_argument("LlamaConfig: head counts do not divide the embedding width");
+    }
+    c.head_dim = c.dim / c.num_heads;
+
+    const GgufLoader::TensorInfo* embd = loader.find_tensor("token_embd.weight");
+    if (!embd || embd->shape.size() != 2) throw std::invalid_argument("LlamaConfig: missing tensor token_embd.weight");
+    c.vocab_size = static_cast<size_t>(embd->shape[1]);
+    return c;
+}
+
+void GenerationStats::print(const std::string& title) const {
+    std::cout << "--- " << title << " ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Time to first token: " << ttft_seconds * 1e3 << " ms" << std::endl;
+    std::cout << "Prefill:             " << prompt_tokens << " tokens in " << prefill_seconds * 1e3 << " ms ("
+              << prefill_tokens_per_s() << " tokens/s)" << std::endl;
+    std::cout << "Decode:              " << (generated_tokens > 0 ? generated_tokens - 1 : 0) << " tokens in "
+              << decode_seconds * 1e3 << " ms (" << decode_tokens_per_s() << " tokens/s)" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+LlamaModel::LlamaModel(const GgufLoader& loader, size_t max_seq) : config_(LlamaConfig::from_gguf(loader)) {
+    if (!loader.mapping()) throw std::invalid_argument("LlamaModel: call GgufLoader::map_weights() first");
+    const LlamaConfig& c = config_;
+    max_seq_ = max_seq ? max_seq : std::min(c.context_length ? c.context_length : DEFAULT_MAX_SEQ, DEFAULT_MAX_SEQ);
+    const size_t q_dim = c.num_heads * c.head_dim, kv_dim = c.num_kv_heads * c.head_dim;
+    const std::string head_name = loader.find_tensor("output.weight") ? "output.weight" : "token_embd.weight";
+
+    // One pipeline task per converted weight, spanning the bytes of all of its sources
+    std::vector<LoadTask> tasks;
+    std::vector<std::function<size_t()>> transforms;
+    auto add = [&](const std::vector<std::string>& sources, std::function<size_t()> transform) {
+        size_t begin = SIZE_MAX, end = 0;
+        for (const auto& name : sources) {
+            const GgufLoader::TensorInfo* info = loader.find_tensor(name);
+            begin = std::min<size_t>(begin, info->data_offset);
+            end = std::max<size_t>(end, info->data_offset + info->size_bytes);
+        }
+        tasks.push_back({sources.front(), begin, end - begin});
+        transforms.push_back(std::move(transform));
+    };
+
+    require(loader, "token_embd.weight", c.vocab_size, c.dim);
+    require(loader, head_name, c.vocab_size, c.dim);
+    require(loader, "output_norm.weight", 1, c.dim);
+    lm_head_ = Tensor(c.dim, c.vocab_size, DataType::FP32, Layout::Tiled, TensorInit::Uninitialized);
+    add({"token_embd.weight"}, [&] {
+        token_embd_ = loader.dequantize("token_embd.weight");
+        return token_embd_.bytes();
+    });
+    add({head_name}, [&, head_name] {
+        pack_transposed(loader.dequantize(head_name), lm_head_);
+        return lm_head_.bytes();
+    });
+    add({"output_norm.weight"}, [&] {
+        output_norm_ = loader.dequantize("output_norm.weight");
+        return output_norm_.bytes();
+    });
+
+    // Anything else (attention biases, rope_freqs, extra norms) changes the math this model implements
+    std::set<std::string> supported = {"token_embd.weight", "output_norm.weight", "output.weight"};
+    for (size_t l = 0; l < c.num_layers; ++l) {
+        for (const char* part : {"attn_norm", "ffn_norm", "attn_q", "attn_k", "attn_v", "attn_output",
+                                 "ffn_gate", "ffn_up", "ffn_down"}) {
+            supported.insert("blk." + std::to_string(l) + "." + part + ".weight");
+        }
+    }
+    for (const auto& t : loader.get_metadata().tensors) {
+        if (!supported.count(t.name)) throw std::invalid_argument("LlamaModel: unsupported tensor " + t.name);
+    }
+
+    layers_.resize(c.num_layers);
+    for (size_t l = 0; l < c.num_layers; ++l) {
+        const std::string p = "blk." + std::to_string(l) + ".";
+        require(loader, p + "attn_norm.weight", 1, c.dim);
+        require(loader, p + "ffn_norm.weight", 1, c.dim);
+        require(loader, p + "attn_q.weight", q_dim, c.dim);
+        require(loader, p + "attn_k.weight", kv_dim, c.dim);
+        require(loader, p + "attn_v.weight", kv_dim, c.dim);
+        require(loader, p + "attn_output.weight", c.dim, q_dim);
+        require(loader, p + "ffn_gate.weight", c.hidden_dim, c.dim);
+        require(loader, p + "ffn_up.weight", c.hidden_dim, c.dim);
+        require(loader, p + "ffn_down.weight", c.dim, c.hidden_dim);
+        layers_[l].wqkv = Tensor(c.dim, q_dim + 2 * kv_dim, DataType::FP32, Layout::Tiled, TensorInit::Uninitialized);
+        layers_[l].wo = Tensor(q_dim, c.dim, DataType::FP32, Layout::Tiled, TensorInit::Uninitialized);
+
+        add({p + "attn_norm.weight", p + "ffn_norm.weight"}, [&, l, p] {
+            Layer& L = layers_[l];
+            L.attn_norm = loader.dequantize(p + "attn_norm.weight");
+            L.ffn_norm = loader.dequantize(p + "ffn_norm.weight");
+            return L.attn_norm.bytes() + L.ffn_norm.bytes();
+        });
+        // Q, K and V rows stacked into one [(q_dim + 2 kv_dim) x dim] matrix: one GEMM per layer
+        add({p + "attn_q.weight", p + "attn_k.weight", p + "attn_v.weight"}, [&, l, p] {
+            Layer& L = layers_[l];
+            Tensor W(q_dim + 2 * kv_dim, c.dim, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+            uint8_t* dst = static_cast<uint8_t*>(W.data());
+            for (const char* part : {"attn_q.weight", "attn_k.weight", "attn_v.weight"}) {
+                const Tensor src = loader.dequantize(p + part);
+                std::memcpy(dst, src.data(), src.bytes());
+                dst += src.bytes();
+            }
+            pack_transposed(W, L.wqkv);
+            return L.wqkv.bytes();
+        });
+        add({p + "attn_output.weight"}, [&, l, p] {
+            Layer& L = layers_[l];
+            pack_transposed(loader.dequantize(p + "attn_output.weight"), L.wo);
+            return L.wo.bytes();
+        });
+        add({p + "ffn_gate.weight", p + "ffn_up.weight"}, [&, l, p] {
+            Layer& L = layers_[l];
+            L.w_gate_up = GemmOps::pack_ffn_gate_up(transposed(loader.dequantize(p + "ffn_gate.weight")),
+                                                    transposed(loader.dequantize(p + "ffn_up.weight")));
+            return L.w_gate_up.bytes();
+        });
+        add({p + "ffn_down.weight"}, [&, l, p] {
+            Layer& L = layers_[l];
+            L.w_down = transposed(loader.dequantize(p + "ffn_down.weight"));
+            return L.w_down.bytes();
+        });
+    }
+
+    load_stats_ = LoadPipeline(loader.mapping()).run(tasks, [&](size_t i) { return transforms[i](); });
+
+    rope_ = std::make_unique<RopeTable>(c.head_dim, max_seq_, c.rope_theta, true);
+    KVCacheConfig kv;
+    kv.num_layers = c.num_layers;
+    kv.num_kv_heads = c.num_kv_heads;
+    kv.head_dim = c.head_dim;
+    kv.page_size = KV_PAGE_SIZE;
+    kv.num_pages = (max_seq_ + KV_PAGE_SIZE - 1) / KV_PAGE_SIZE;
+    cache_ = std::make_unique<PagedKVCache>(kv);
+    seq_ = cache_->add_sequence();
+    logits_.resize(c.vocab_size);
+}
+
+size_t LlamaModel::position() const { return cache_->length(seq_); }
+
+void LlamaModel::reset() {
+    cache_->remove_sequence(seq_);
+    seq_ = cache_->add_sequence();
+}
+
+void LlamaModel::project(const Tensor& x, const Tensor& W, Tensor& y) {
+    if (x.rows() <= GemmOps::GEMV_MAX_ROWS) GemmOps::gemv(TensorView(x), W, y);
+    else GemmOps::gemm_tiled(x, W, y);
+}
+
+const std::vector<float>& LlamaModel::forward(const std::vector<int32_t>& tokens) {
+    const LlamaConfig& c = config_;
+    const size_t T = tokens.size();
+    if (T == 0) throw std::invalid_argument("LlamaModel::forward: no tokens");
+    for (int32_t t : tokens) {
+        if (t < 0 || static_cast<size_t>(t) >= c.vocab_size) throw std::out_of_range("LlamaModel::forward: token id outside the vocabulary");
+    }
+    const size_t pos0 = position();
+    if (pos0 + T > max_seq_) throw std::out_of_range("LlamaModel::forward: sequence exceeds max_seq");
+    cache_->append(seq_, T);
+    // A throw past this point hands the reservation back, so position() never counts
+    // tokens whose K/V were not written
+    struct Reservation {
+        PagedKVCache& cache;
+        PagedKVCache::SeqId seq;
+        size_t pos0;
+        bool committed;
+        ~Reservation() {
+            if (!committed) cache.truncate(seq, pos0);
+        }
+    } reservation{*cache_, seq_, pos0, false};
+
+    const size_t D = c.dim;
+    const size_t q_dim = c.num_heads * c.head_dim, kv_dim = c.num_kv_heads * c.head_dim;
+    Tensor X(T, D, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    for (size_t r = 0; r < T; ++r) {
+        std::memcpy(X.data_as_fp32() + r * D, token_embd_.data_as_fp32() + tokens[r] * D, D * sizeof(float));
+    }
+
+    Tensor xn(T, D, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    Tensor qkv(T, q_dim + 2 * kv_dim);
+    Tensor Q(T, q_dim, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    Tensor K(T, kv_dim, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    Tensor V(T, kv_dim, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    Tensor O(T, q_dim, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    Tensor F(T, D, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+
+    AttentionDesc desc;
+    desc.num_heads = c.num_heads;
+    desc.num_kv_heads = c.num_kv_heads;
+    desc.head_dim = c.head_dim;
+    desc.seq_q = T;
+    desc.seq_kv = T;
+
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const Layer& L = layers_[l];
+
+        // Attention block: X += Attn(RoPE(RMSNorm(X) * Wqkv)) * Wo
+        qkv.fill(0.0f);
+        if (T <= GemmOps::GEMV_MAX_ROWS) {
+            TransformerOps::rms_norm(X, L.attn_norm, xn, c.rms_eps);
+            project(xn, L.wqkv, qkv);
+        } else {
+            GemmOps::gemm_tiled(X, L.wqkv, qkv, GemmNormPrologue{GemmNormPrologue::Kind::RmsNorm, &L.attn_norm, nullptr, c.rms_eps});
+        }
+        const float* src = qkv.data_as_fp32();
+        for (size_t r = 0; r < T; ++r, src += q_dim + 2 * kv_dim) {
+            std::memcpy(Q.data_as_fp32() + r * q_dim, src, q_dim * sizeof(float));
+            std::memcpy(K.data_as_fp32() + r * kv_dim, src + q_dim, kv_dim * sizeof(float));
+            std::memcpy(V.data_as_fp32() + r * kv_dim, src + q_dim + kv_dim, kv_dim * sizeof(float));
+        }
+        TransformerOps::rope(Q, c.num_heads, *rope_, pos0);
+        TransformerOps::rope(K, c.num_kv_heads, *rope_, pos0);
+        cache_->write(seq_, l, pos0, K, V);
+        // A prompt on an empty cache attends only to itself; later chunks read the cache pages
+        if (pos0 == 0) AttentionOps::flash_attention(Q, K, V, O, desc);
+        else AttentionOps::paged_attention(Q, *cache_, seq_, l, O, desc);
+        project(O, L.wo, X);
+
+        // FFN block: X += SwiGLU(RMSNorm(X))
+        TransformerOps::rms_norm(X, L.ffn_norm, xn, c.rms_eps);
+        GemmOps::ffn_swiglu(xn, L.w_gate_up, L.w_down, F);
+        float* x = X.data_as_fp32();
+        const float* f = F.data_as_fp32();
+        for (size_t i = 0; i < T * D; ++i) x[i] += f[i];
+    }
+
+    // Only the last token's logits are needed for sampling
+    Tensor last(1, D, DataType::FP32, Layout::RowMajor, TensorInit::Uninitialized);
+    std::memcpy(last.data_as_fp32(), X.data_as_fp32() + (T - 1) * D, D * sizeof(float));
+    TransformerOps::rms_norm(last, output_norm_, last, c.rms_eps);
+    Tensor logits = Tensor::wrap(logits_.data(), 1, c.vocab_size);
+    logits.fill(0.0f);
+    project(last, lm_head_, logits);
+    reservation.committed = true;
+    return logits_;
+}
+
+int32_t LlamaModel::argmax(const std::vector<float>& logits) {
+    return static_cast<int32_t>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+}
+
+std::vector<int32_t> LlamaModel::generate(const std::vector<int32_t>& prompt, size_t max_new_tokens,
+                                          GenerationStats* stats, int32_t eos_token) {
+    using Clock = std::chrono::steady_clock;
+    auto seconds_since = [](Clock::time_point t) { return std::chrono::duration<double>(Clock::now() - t).count(); };
+    GenerationStats s;
+    s.prompt_tokens = prompt.size();
+    std::vector<int32_t> out;
+
+    const auto t0 = Clock::now();
+    const std::vector<float>& logits = forward(prompt);
+    s.prefill_seconds = seconds_since(t0);
+    if (max_new_tokens > 0) out.push_back(argmax(logits));
+    s.ttft_seconds = seconds_since(t0);
+
+    const auto t1 = Clock::now();
+    while (out.size() < max_new_tokens && out.back() != eos_token) out.push_back(argmax(forward({out.back()})));
+    s.decode_seconds = seconds_since(t1);
+    s.generated_tokens = out.size();
+    if (stats) *stats = s;
+    return out;
+}
+
+} // namespace softaccelnpu
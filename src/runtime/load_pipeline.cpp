@@ -0,0 +1,142 @@
+#include "softaccelnpu/load_pipeline.h"
+#include "softaccelnpu/thread_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace softaccelnpu {
+
+void LoadStats::print(const std::string& title) const {
+    std::cout << "--- " << title << " ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Tasks:      " << tasks << " on " << threads << " threads" << std::endl;
+    std::cout << "Read:       " << bytes_read / 1048576.0 << " MB in " << read_seconds * 1e3 << " ms ("
+              << read_mb_per_s() << " MB/s)" << std::endl;
+    std::cout << "Transform:  " << bytes_in / 1048576.0 << " MB -> " << bytes_out / 1048576.0 << " MB ("
+              << transform_mb_per_s() << " MB/s, " << wait_seconds * 1e3 << " ms waiting for reads)" << std::endl;
+    std::cout << "Overall:    " << wall_seconds * 1e3 << " ms (" << overall_mb_per_s() << " MB/s)" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+LoadPipeline::LoadPipeline(std::shared_ptr<const MappedFile> file, const LoadOptions& options)
+    : file_(std::move(file)), options_(options) {
+    if (!file_) throw std::invalid_argument("LoadPipeline: file must be mapped");
+}
+
+LoadStats LoadPipeline::run(const std::vector<LoadTask>& tasks, const Transform& transform) const {
+    using Clock = std::chrono::steady_clock;
+    auto seconds_since = [](Clock::time_point t) { return std::chrono::duration<double>(Clock::now() - t).count(); };
+    for (const auto& t : tasks) {
+        if (t.offset > file_->size() || t.bytes > file_->size() - t.offset) {
+            throw std::invalid_argument("LoadPipeline: task " + t.name + " is outside the mapped file");
+        }
+    }
+
+    ThreadPool& pool = get_thread_pool();
+    LoadStats stats;
+    stats.tasks = tasks.size();
+    const auto start = Clock::now();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t tasks_read = 0;   // Tasks [0, tasks_read) are resident
+    size_t in_flight = 0;    // Bytes read but not yet transformed
+    bool abort = false;
+    std::exception_ptr error;
+    std::set<std::thread::id> workers;  // Pool threads, or just this one when run from a pool task
+
+    // Stage 1: fault source ranges in, in order, bounded by read_ahead_bytes
+    std::thread reader([&] {
+        const size_t page = MappedFile::page_size();
+        const volatile uint8_t* base = file_->data();
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            const LoadTask& t = tasks[i];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return abort || in_flight == 0 || in_flight + t.bytes <= options_.read_ahead_bytes; });
+                if (abort) return;
+            }
+            const auto t0 = Clock::now();
+            if (t.bytes) {
+                file_->advise(t.offset, t.bytes, MapAdvice::WillNeed);
+                if (options_.read_pages) {
+                    uint8_t sink = 0;
+                    for (size_t off = t.offset; off < t.offset + t.bytes; off += page) sink ^= base[off];
+                    sink ^= base[t.offset + t.bytes - 1];
+                    (void)sink;
+                }
+            }
+            const double busy = seconds_since(t0);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.read_seconds += busy;
+            if (options_.read_pages) stats.bytes_read += t.bytes;
+            in_flight += t.bytes;
+            tasks_read = i + 1;
+            cv.notify_all();
+        }
+    });
+
+    // Joins the reader on every exit, including the pool itself throwing (bad_alloc while
+    // queueing jobs): a joinable std::thread going out of scope calls std::terminate
+    struct ReaderJoin {
+        std::thread& reader;
+        std::mutex& mutex;
+        std::condition_variable& cv;
+        bool& abort;
+        ~ReaderJoin() {
+            if (!reader.joinable()) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                abort = true;
+            }
+            cv.notify_all();
+            reader.join();
+        }
+    } join_reader{reader, mutex, cv, abort};
+
+    // Stage 2: transform on the pool as soon as each task's bytes are in
+    pool.parallel_tasks(tasks.size(), [&](size_t i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            const auto t0 = Clock::now();
+            cv.wait(lock, [&] { return abort || tasks_read > i; });
+            stats.wait_seconds += seconds_since(t0);
+            if (abort) return;
+        }
+        const auto t0 = Clock::now();
+        size_t produced = 0;
+        try {
+            produced = transform(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+            abort = true;
+            cv.notify_all();
+            return;
+        }
+        const double busy = seconds_since(t0);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        workers.insert(std::this_thread::get_id());
+        stats.transform_seconds += busy;
+        stats.bytes_in += tasks[i].bytes;
+        stats.bytes_out += produced;
+        in_flight -= tasks[i].bytes;
+        cv.notify_all();
+    });
+
+    reader.join();  // Every task was read, so this does not wait on abort
+    if (error) std::rethrow_exception(error);
+    stats.threads = workers.size();
+    stats.wall_seconds = seconds_since(start);
+    return stats;
+}
+
+} // namespace softaccelnpu
@@ -0,0 +1,114 @@
+#include "softaccelnpu/memory_planner.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace softaccelnpu {
+
+namespace {
+
+size_t align_up(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+} // namespace
+
+size_t MemoryPlanner::add_buffer(size_t bytes) {
+    buffers_.push_back(Buffer{bytes});
+    return buffers_.size() - 1;
+}
+
+void MemoryPlanner::use(size_t buffer, size_t step) {
+    if (buffer >= buffers_.size()) {
+        throw std::invalid_argument("MemoryPlanner::use: unknown buffer");
+    }
+    Buffer& b = buffers_[buffer];
+    b.first = (b.first == NONE) ? step : std::min(b.first, step);
+    b.last = std::max(b.last, step);
+}
+
+void MemoryPlanner::allow_in_place(size_t output, size_t input, size_t step) {
+    if (output >= buffers_.size() || input >= buffers_.size()) {
+        throw std::invalid_argument("MemoryPlanner::allow_in_place: unknown buffer");
+    }
+    in_place_.push_back({output, input, step});
+}
+
+size_t MemoryPlanner::plan() {
+    size_t last_step = 0;
+    for (const Buffer& b : buffers_) {
+        if (b.first != NONE) last_step = std::max(last_step, b.last);
+    }
+
+    // Buffers never touched by a step stay valid for the whole plan
+    for (Buffer& b : buffers_) {
+        b.root = NONE;
+        if (b.first == NONE) { b.first = 0; b.last = last_step; }
+    }
+
+    // Storage groups: a root buffer plus everything aliased into it
+    const size_t n = buffers_.size();
+    std::vector<size_t> group_bytes(n), group_first(n), group_last(n);
+    for (size_t i = 0; i < n; ++i) {
+        group_bytes[i] = buffers_[i].bytes;
+        group_first[i] = buffers_[i].first;
+        group_last[i] = buffers_[i].last;
+    }
+    auto root_of = [&](size_t i) { return buffers_[i].root == NONE ? i : buffers_[i].root; };
+
+    std::sort(in_place_.begin(), in_place_.end(), [](const InPlace& a, const InPlace& b) { return a.step < b.step; });
+    size_t aliased = 0;
+    for (const InPlace& ip : in_place_) {
+        Buffer& out = buffers_[ip.output];
+        const size_t r = root_of(ip.input);
+        // The input must die at this step and the output must be born at it
+        if (ip.output == ip.input || r == ip.output || out.root != NONE || out.first != ip.step ||
+            group_last[r] != ip.step || out.bytes > group_bytes[r]) {
+            continue;
+        }
+        // The output must not itself be a donor already
+        bool donor = false;
+        for (const Buffer& b : buffers_) donor |= (b.root == ip.output);
+        if (donor) continue;
+
+        out.root = r;
+        group_last[r] = std::max(group_last[r], out.last);
+        ++aliased;
+    }
+
+    // Greedy by size over the roots
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < n; ++i) {
+        if (buffers_[i].root == NONE) roots.push_back(i);
+    }
+    std::stable_sort(roots.begin(), roots.end(), [&](size_t a, size_t b) { return group_bytes[a] > group_bytes[b]; });
+
+    size_t arena = 0;
+    std::vector<size_t> placed;
+    std::vector<size_t> live;
+    for (size_t r : roots) {
+        live.clear();
+        for (size_t p : placed) {
+            if (group_first[p] <= group_last[r] && group_first[r] <= group_last[p]) live.push_back(p);
+        }
+        std::sort(live.begin(), live.end(), [&](size_t a, size_t b) { return buffers_[a].offset < buffers_[b].offset; });
+
+        size_t offset = 0;
+        for (size_t p : live) {
+            if (buffers_[p].offset >= offset + group_bytes[r]) break;
+            offset = std::max(offset, align_up(buffers_[p].offset + group_bytes[p], ALIGNMENT));
+        }
+        buffers_[r].offset = offset;
+        arena = std::max(arena, offset + group_bytes[r]);
+        placed.push_back(r);
+    }
+
+    stats_ = MemoryPlanStats{};
+    for (Buffer& b : buffers_) {
+        if (b.root != NONE) b.offset = buffers_[b.root].offset;
+        stats_.naive_bytes += b.bytes;
+    }
+    stats_.num_buffers = n;
+    stats_.num_aliased = aliased;
+    stats_.planned_bytes = arena;
+    return arena;
+}
+
+} // namespace softaccelnpu
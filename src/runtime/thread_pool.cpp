@@ -5,6 +5,12 @@
 
 namespace softaccelnpu {
 
+namespace {
+// Set on pool threads: nested parallel loops run inline instead of waiting on a pool
+// whose workers may all be blocked in the outer loop
+thread_local bool t_pool_worker = false;
+} // namespace
+
 ThreadPool::ThreadPool(size_t num_threads) {
     if (num_threads == 0) {
         num_threads = std::thread::hardware_concurrency();
@@ -13,6 +19,7 @@ ThreadPool::ThreadPool(size_t num_threads) {
 
     for (size_t i = 0; i < num_threads; ++i) {
         workers_.emplace_back([this] {
+            t_pool_worker = true;
             while (true) {
                 std::function<void()> task;
                 {
@@ -56,6 +63,10 @@ void ThreadPool::enqueue(std::function<void()> task) {
 
 void ThreadPool::parallel_for(size_t start, size_t end, std::function<void(size_t, size_t)> chunk_func) {
     if (start >= end) return;
+    if (t_pool_worker) {
+        chunk_func(start, end);
+        return;
+    }
 
     size_t total_work = end - start;
     size_t num_workers = workers_.size();
@@ -97,6 +108,48 @@ void ThreadPool::parallel_for(size_t start, size_t end, std::function<void(size_
     }
 }
 
+void ThreadPool::parallel_tasks(size_t count, std::function<void(size_t)> task_func) {
+    if (count == 0) return;
+    if (t_pool_worker) {
+        for (size_t i = 0; i < count; ++i) task_func(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    size_t num_jobs = std::min(count, workers_.size());
+    std::vector<std::future<void>> futures;
+
+    // Queued jobs reference this frame, so every exit waits for the ones already queued
+    auto wait_all = [&futures] {
+        for (auto& f : futures) f.wait();
+    };
+    try {
+        for (size_t i = 0; i < num_jobs; ++i) {
+            auto task = std::make_shared<std::packaged_task<void()>>(
+                [&next, count, &task_func]() {
+                    for (size_t idx = next++; idx < count; idx = next++) {
+                        task_func(idx);
+                    }
+                }
+            );
+
+            futures.emplace_back(task->get_future());
+
+            enqueue([task]() {
+                (*task)();
+            });
+        }
+    } catch (...) {
+        wait_all();
+        throw;
+    }
+
+    wait_all();
+    for (auto& f : futures) {
+        f.get();
+    }
+}
+
 // Global instance
 ThreadPool& get_thread_pool() {
     static ThreadPool pool(0); // Auto-detect